@@ -0,0 +1,182 @@
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+/*
+Moves file output off the study thread.
+
+c_AsyncRecordWriter is a preallocated single producer, single consumer ring of fixed size records and a worker thread that owns the file.
+The study thread calls Push: one copy into the ring and one release store, no lock, no allocation and no system call. When the ring is full the record is dropped and counted rather than waited for.
+The worker wakes every FlushMilliseconds, hands everything published so far to the WriteBatch function of the format (once, or twice when the records wrap around the end of the ring), and the format writes it with one fwrite.
+The file is unbuffered, so a batch is one append and the data on disk is at most FlushMilliseconds behind.
+Only one thread may Push to a writer. Open and Close are for the thread that owns the writer, with no Push running.
+*/
+
+typedef void (*AsyncWriteHeaderFunction)(std::FILE* File);
+
+template <typename RecordType, unsigned int Capacity>
+class c_AsyncRecordWriter
+{
+public:
+    typedef void (*WriteBatchFunction)(std::FILE* File, const RecordType* Records, unsigned int Count);
+
+    c_AsyncRecordWriter()
+        : m_Head(0)
+        , m_Dropped(0)
+        , m_Tail(0)
+        , m_Stop(false)
+        , m_File(NULL)
+        , m_WriteBatch(NULL)
+        , m_FlushMilliseconds(1)
+    {
+        static_assert((Capacity & (Capacity - 1)) == 0, "the ring capacity must be a power of two");
+    }
+
+    ~c_AsyncRecordWriter()
+    {
+        Close();
+    }
+
+    // Starts writing to Path, appending when it exists. WriteHeader is called by the instance that creates the file, or that finds it empty. Returns false when the file cannot be opened.
+    bool Open(const char* Path, AsyncWriteHeaderFunction WriteHeader, WriteBatchFunction WriteBatch, unsigned int FlushMilliseconds)
+    {
+        if (m_File != NULL && m_Path == Path)
+            return true;
+
+        Close();
+
+        // "x" fails when the file exists, so of several instances opening a new file at once only one writes the header.
+        bool Created = false;
+        if (WriteHeader != NULL)
+        {
+            std::FILE* NewFile = std::fopen(Path, "wbx");
+            if (NewFile != NULL)
+            {
+                std::setvbuf(NewFile, NULL, _IONBF, 0);
+                WriteHeader(NewFile);
+                std::fclose(NewFile);
+                Created = true;
+            }
+        }
+
+        m_File = std::fopen(Path, "ab");
+        if (m_File == NULL)
+            return false;
+
+        std::setvbuf(m_File, NULL, _IONBF, 0);
+
+        // The position of an append stream is 0 until the first write on the Microsoft C runtime, so the size is taken at the end.
+        if (!Created && WriteHeader != NULL)
+        {
+            std::fseek(m_File, 0, SEEK_END);
+            if (std::ftell(m_File) == 0)
+                WriteHeader(m_File);
+        }
+
+        m_Path = Path;
+        m_WriteBatch = WriteBatch;
+        m_FlushMilliseconds = FlushMilliseconds > 0 ? FlushMilliseconds : 1;
+        m_Stop.store(false);
+        m_Worker = std::thread(&c_AsyncRecordWriter::WorkerLoop, this);
+        return true;
+    }
+
+    // Stops the worker after it has written everything pushed so far, and closes the file.
+    void Close()
+    {
+        if (m_File == NULL)
+            return;
+
+        m_Stop.store(true);
+        if (m_Worker.joinable())
+            m_Worker.join();
+
+        std::fclose(m_File);
+        m_File = NULL;
+        m_Path.clear();
+    }
+
+    bool IsOpen() const
+    {
+        return m_File != NULL;
+    }
+
+    // Records dropped because the ring was full.
+    unsigned long long Dropped() const
+    {
+        return m_Dropped.load(std::memory_order_relaxed);
+    }
+
+    // Producer thread only. Returns false when the record was dropped.
+    bool Push(const RecordType& Record)
+    {
+        if (m_File == NULL)
+            return false;
+
+        const unsigned int Head = m_Head.load(std::memory_order_relaxed);
+        if (Head - m_Tail.load(std::memory_order_acquire) >= Capacity)
+        {
+            m_Dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        m_Ring[Head & (Capacity - 1)] = Record;
+        m_Head.store(Head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    c_AsyncRecordWriter(const c_AsyncRecordWriter&);
+    c_AsyncRecordWriter& operator=(const c_AsyncRecordWriter&);
+
+    // Writes the records published so far. Worker thread only.
+    void Drain()
+    {
+        const unsigned int Head = m_Head.load(std::memory_order_acquire);
+        unsigned int Tail = m_Tail.load(std::memory_order_relaxed);
+
+        while (Tail != Head)
+        {
+            // Up to the end of the ring in one batch.
+            const unsigned int First = Tail & (Capacity - 1);
+            unsigned int Count = Head - Tail;
+            if (Count > Capacity - First)
+                Count = Capacity - First;
+
+            m_WriteBatch(m_File, &m_Ring[First], Count);
+            Tail += Count;
+            m_Tail.store(Tail, std::memory_order_release);
+        }
+    }
+
+    void WorkerLoop()
+    {
+        while (!m_Stop.load())
+        {
+            Drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_FlushMilliseconds));
+        }
+
+        Drain();
+    }
+
+    // The index each thread writes is on its own cache line.
+    RecordType m_Ring[Capacity];
+    alignas(64) std::atomic<unsigned int> m_Head;
+    std::atomic<unsigned long long> m_Dropped;
+    alignas(64) std::atomic<unsigned int> m_Tail;
+    alignas(64) std::atomic<bool> m_Stop;
+
+    std::FILE* m_File;
+    WriteBatchFunction m_WriteBatch;
+    unsigned int m_FlushMilliseconds;
+    std::string m_Path;
+    std::thread m_Worker;
+};
+
+#endif
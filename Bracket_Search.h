@@ -0,0 +1,290 @@
+#ifndef BRACKET_SEARCH_H
+#define BRACKET_SEARCH_H
+
+#include <vector>
+
+#include "Trade_Sim.h"
+
+/*
+Indexed exit search for the bracket of Trade_Sim.h, so a backtest finds where a trade exits without checking it against every bar it is open.
+
+c_BarExtremes keeps the High and Low columns with levels of block maxima (High) and minima (Low) above them, BAR_EXTREMES_BLOCK values per block, about 1/15 of the columns' size.
+A search for the first bar at or after First whose High or Low crosses a price climbs the levels until a block matches and descends into it, reading one cache line per level. That is O(log n) per search whatever the distance to the match.
+Bracket_FindExit gives the fills of s_BracketPosition::Step bar by bar from the searches:
+The stop and the target only move when the trailing stop does, and it only moves on a bar that makes a new best price (a High above BestPrice for a long, a Low below it for a short).
+So each step searches for the next new best bar and for the first bar up to it that touches the stop. The stop is the exit when it comes first or on the same bar, as in Step; otherwise the new best bar may reach the target, and if not, the stop follows it and the search goes on from the bar after.
+The target is always beyond the best price, so only a new best bar can reach it. Without a stop nothing trails, and one search for the target is enough.
+A trade costs one search per new best price it makes, not one step per bar it lasts.
+Nothing here depends on sierrachart.h.
+*/
+
+const int BAR_EXTREMES_SHIFT = 4;
+const int BAR_EXTREMES_BLOCK = 1 << BAR_EXTREMES_SHIFT;
+
+struct s_ExtremeAbove
+{
+    double Price;
+    bool operator()(float Value) const { return Value > Price; }
+};
+
+struct s_ExtremeAtOrAbove
+{
+    double Price;
+    bool operator()(float Value) const { return Value >= Price; }
+};
+
+struct s_ExtremeBelow
+{
+    double Price;
+    bool operator()(float Value) const { return Value < Price; }
+};
+
+struct s_ExtremeAtOrBelow
+{
+    double Price;
+    bool operator()(float Value) const { return Value <= Price; }
+};
+
+class c_BarExtremes
+{
+public:
+    c_BarExtremes()
+        : p_High(NULL)
+        , p_Low(NULL)
+        , m_Count(0)
+    {
+    }
+
+    // Builds the levels over High and Low, which must stay unchanged (and in place) while they are searched.
+    void Build(const float* High, const float* Low, int Count)
+    {
+        p_High = High;
+        p_Low = Low;
+        m_Count = Count;
+
+        m_HighLevels.clear();
+        m_LowLevels.clear();
+
+        const float* Below_High = High;
+        const float* Below_Low = Low;
+        int Below_Count = Count;
+
+        while (Below_Count > BAR_EXTREMES_BLOCK)
+        {
+            const int Level_Count = (Below_Count + BAR_EXTREMES_BLOCK - 1) >> BAR_EXTREMES_SHIFT;
+
+            m_HighLevels.push_back(std::vector<float>(Level_Count));
+            m_LowLevels.push_back(std::vector<float>(Level_Count));
+            std::vector<float>& Level_High = m_HighLevels.back();
+            std::vector<float>& Level_Low = m_LowLevels.back();
+
+            for (int Index = 0; Index < Level_Count; Index++)
+            {
+                const int First = Index << BAR_EXTREMES_SHIFT;
+                const int End = First + BAR_EXTREMES_BLOCK < Below_Count ? First + BAR_EXTREMES_BLOCK : Below_Count;
+
+                float Block_High = Below_High[First];
+                float Block_Low = Below_Low[First];
+                for (int Value = First + 1; Value < End; Value++)
+                {
+                    Block_High = Below_High[Value] > Block_High ? Below_High[Value] : Block_High;
+                    Block_Low = Below_Low[Value] < Block_Low ? Below_Low[Value] : Block_Low;
+                }
+
+                Level_High[Index] = Block_High;
+                Level_Low[Index] = Block_Low;
+            }
+
+            Below_High = &Level_High[0];
+            Below_Low = &Level_Low[0];
+            Below_Count = Level_Count;
+        }
+    }
+
+    float High(int BarIndex) const
+    {
+        return p_High[BarIndex];
+    }
+
+    float Low(int BarIndex) const
+    {
+        return p_Low[BarIndex];
+    }
+
+    // The first bar in First to Last with the given High or Low, -1 for none.
+    int FirstHighAbove(int First, int Last, double Price) const
+    {
+        const s_ExtremeAbove Match = { Price };
+        return Find(p_High, m_HighLevels, First, Last, Match);
+    }
+
+    int FirstHighAtOrAbove(int First, int Last, double Price) const
+    {
+        const s_ExtremeAtOrAbove Match = { Price };
+        return Find(p_High, m_HighLevels, First, Last, Match);
+    }
+
+    int FirstLowBelow(int First, int Last, double Price) const
+    {
+        const s_ExtremeBelow Match = { Price };
+        return Find(p_Low, m_LowLevels, First, Last, Match);
+    }
+
+    int FirstLowAtOrBelow(int First, int Last, double Price) const
+    {
+        const s_ExtremeAtOrBelow Match = { Price };
+        return Find(p_Low, m_LowLevels, First, Last, Match);
+    }
+
+private:
+    c_BarExtremes(const c_BarExtremes&);
+    c_BarExtremes& operator=(const c_BarExtremes&);
+
+    // Match must hold for a block's extreme exactly when it holds for one of its values: a High test of > or >= on the maxima, a Low test of < or <= on the minima.
+    template <typename t_Match>
+    int Find(const float* Bars, const std::vector<std::vector<float> >& Levels, int First, int Last, const t_Match& Match) const
+    {
+        if (First > Last || First >= m_Count)
+            return -1;
+
+        // Section 1 - Up: the rest of the current block at each level, until one matches
+        int Level = 0;
+        int Index = First;
+
+        for (;;)
+        {
+            if ((static_cast<long long>(Index) << (Level * BAR_EXTREMES_SHIFT)) > Last)
+                return -1;
+
+            const float* Values = Level == 0 ? Bars : &Levels[Level - 1][0];
+            const int Count = Level == 0 ? m_Count : static_cast<int>(Levels[Level - 1].size());
+            const int Block_End = (Index | (BAR_EXTREMES_BLOCK - 1)) + 1;
+            const int End = Block_End < Count ? Block_End : Count;
+
+            int Found = -1;
+            for (int Value = Index; Value < End; Value++)
+            {
+                if (Match(Values[Value]))
+                {
+                    Found = Value;
+                    break;
+                }
+            }
+
+            if (Found >= 0)
+            {
+                Index = Found;
+                break;
+            }
+
+            if (End >= Count)
+                return -1;
+
+            Index = End >> BAR_EXTREMES_SHIFT;
+            Level++;
+        }
+
+        // Section 2 - Down: the first matching value of each matching block
+        while (Level > 0)
+        {
+            Level--;
+
+            const float* Values = Level == 0 ? Bars : &Levels[Level - 1][0];
+            const int Count = Level == 0 ? m_Count : static_cast<int>(Levels[Level - 1].size());
+            const int Block_First = Index << BAR_EXTREMES_SHIFT;
+            const int End = Block_First + BAR_EXTREMES_BLOCK < Count ? Block_First + BAR_EXTREMES_BLOCK : Count;
+
+            Index = Block_First;
+            while (Index < End - 1 && !Match(Values[Index]))
+                Index++;
+        }
+
+        return Index <= Last ? Index : -1;
+    }
+
+    const float* p_High;
+    const float* p_Low;
+    int m_Count;
+    std::vector<std::vector<float> > m_HighLevels;
+    std::vector<std::vector<float> > m_LowLevels;
+};
+
+// Finds where the bracket of an open Position exits in bars First to Last. Returns the exit bar with ExitPrice set, or -1 with the trailing stop moved as Step would have moved it over those bars.
+inline int Bracket_FindExit(s_BracketPosition& Position, const c_BarExtremes& Extremes, int First, int Last, double& ExitPrice)
+{
+    const bool Has_Stop = Position.StopOffset > 0.0;
+    const bool Has_Target = Position.TargetPrice > 0.0;
+
+    if (!Has_Stop)
+    {
+        if (!Has_Target)
+            return -1;
+
+        const int Target_Bar = Position.Direction > 0
+            ? Extremes.FirstHighAtOrAbove(First, Last, Position.TargetPrice)
+            : Extremes.FirstLowAtOrBelow(First, Last, Position.TargetPrice);
+
+        if (Target_Bar >= 0)
+            ExitPrice = Position.TargetPrice;
+
+        return Target_Bar;
+    }
+
+    int BarIndex = First;
+
+    while (BarIndex <= Last)
+    {
+        if (Position.Direction > 0)
+        {
+            const int Best_Bar = Extremes.FirstHighAbove(BarIndex, Last, Position.BestPrice);
+            const int Stop_Bar = Extremes.FirstLowAtOrBelow(BarIndex, Best_Bar >= 0 ? Best_Bar : Last, Position.StopPrice);
+
+            if (Stop_Bar >= 0)
+            {
+                ExitPrice = Position.StopPrice;
+                return Stop_Bar;
+            }
+
+            if (Best_Bar < 0)
+                return -1;
+
+            if (Has_Target && Extremes.High(Best_Bar) >= Position.TargetPrice)
+            {
+                ExitPrice = Position.TargetPrice;
+                return Best_Bar;
+            }
+
+            Position.BestPrice = Extremes.High(Best_Bar);
+            Position.StopPrice = Position.BestPrice - Position.StopOffset;
+            BarIndex = Best_Bar + 1;
+        }
+        else
+        {
+            const int Best_Bar = Extremes.FirstLowBelow(BarIndex, Last, Position.BestPrice);
+            const int Stop_Bar = Extremes.FirstHighAtOrAbove(BarIndex, Best_Bar >= 0 ? Best_Bar : Last, Position.StopPrice);
+
+            if (Stop_Bar >= 0)
+            {
+                ExitPrice = Position.StopPrice;
+                return Stop_Bar;
+            }
+
+            if (Best_Bar < 0)
+                return -1;
+
+            if (Has_Target && Extremes.Low(Best_Bar) <= Position.TargetPrice)
+            {
+                ExitPrice = Position.TargetPrice;
+                return Best_Bar;
+            }
+
+            Position.BestPrice = Extremes.Low(Best_Bar);
+            Position.StopPrice = Position.BestPrice + Position.StopOffset;
+            BarIndex = Best_Bar + 1;
+        }
+    }
+
+    return -1;
+}
+
+#endif
@@ -0,0 +1,454 @@
+#ifndef CROSSOVER_CHECKPOINT_H
+#define CROSSOVER_CHECKPOINT_H
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+Dirty-range tracking for the crossover studies, so a full recalculation after a backfill or reload only recomputes from the first bar that changed.
+
+Sierra Chart reports a backfill, or a reload of the chart data, as a full recalculation from bar 0, even when only the last minutes changed. c_CrossoverCheckpoints remembers what the study computed before:
+the two averages of every closed bar, and a checkpoint every CHECKPOINT_BLOCK_BARS bars with a hash of that block's fast and slow inputs. The bars of the open block (after the last checkpoint) are kept in fixed arrays, inputs and all, and go into the history a whole block at a time.
+On the full recalculation FirstChangedBar checks the current inputs against the checkpoints, block by block, and then against the open block bar by bar. Everything before the first mismatch is the history the study already has:
+Restore writes its averages back, and the kernels resume from the bar that changed. They resync there from the unchanged inputs before it, so the history keeps the values the chart had.
+The check and the copy back take about 1.5 ns per bar, where the batch SMA takes about 2 per average and the batch Hull average 14. When the rewind would leave more than 1 / CHECKPOINT_RESUME_FRACTION of the history to recompute, the batch kernels from bar 0 are faster and the study uses them instead.
+Only the inputs of the averages are hashed, so a change elsewhere in the bars (volume, a high or low not used as input) does not count as dirty. A change of the periods or input fields drops the checkpoints (Bind).
+The study records the bars below sc.UpdateStartIndex at the start of each call, once they are final. That is three stores per bar, and a copy and hash per block.
+Save and Load keep the history in a file between sessions, so a chart that reopens checks its bars against what it had at close and only computes the bars since.
+The file is an s_CheckpointFileHeader, then the block hashes, the fast and the slow averages of the blocks, and the inputs and averages of the open block, little endian. Its checksum covers all of it, so a torn or foreign file is not loaded.
+Nothing here depends on sierrachart.h.
+*/
+
+const int CHECKPOINT_BLOCK_BARS = 1024;
+const int CHECKPOINT_RESUME_FRACTION = 4;
+
+// The settings the recorded averages depend on.
+struct s_CheckpointKey
+{
+    int FastLength;
+    int SlowLength;
+    int FastDataIndex;
+    int SlowDataIndex;
+
+    s_CheckpointKey()
+        : FastLength(0)
+        , SlowLength(0)
+        , FastDataIndex(0)
+        , SlowDataIndex(0)
+    {
+    }
+
+    bool operator==(const s_CheckpointKey& Other) const
+    {
+        return FastLength == Other.FastLength
+            && SlowLength == Other.SlowLength
+            && FastDataIndex == Other.FastDataIndex
+            && SlowDataIndex == Other.SlowDataIndex;
+    }
+};
+
+// The fast and slow inputs of one bar as one word, bit for bit.
+inline unsigned long long Checkpoint_InputWord(float Fast, float Slow)
+{
+    unsigned int Fast_Bits;
+    unsigned int Slow_Bits;
+    std::memcpy(&Fast_Bits, &Fast, sizeof(Fast_Bits));
+    std::memcpy(&Slow_Bits, &Slow, sizeof(Slow_Bits));
+    return (static_cast<unsigned long long>(Fast_Bits) << 32) | Slow_Bits;
+}
+
+// One step of the hash. Both the multiply by an odd constant and the rotate are invertible, so a block that differs from the recorded one in a single bar always fails its checkpoint.
+inline unsigned long long Checkpoint_Mix(unsigned long long Hash, unsigned long long Word)
+{
+    Hash = (Hash ^ Word) * 0x9E3779B97F4A7C15ULL;
+    return (Hash << 29) | (Hash >> 35);
+}
+
+const int CHECKPOINT_HASH_LANES = 8;
+
+#pragma pack(push, 1)
+
+struct s_CheckpointFileHeader
+{
+    char Magic[8];
+    unsigned int Version;
+    int BlockBars;
+    int FastLength;
+    int SlowLength;
+    int FastDataIndex;
+    int SlowDataIndex;
+    int Blocks;
+    int OpenCount;
+    unsigned long long Checksum;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(s_CheckpointFileHeader) == 48, "s_CheckpointFileHeader must match the file format");
+
+const char CHECKPOINT_FILE_MAGIC[8] = { 'X', 'O', 'V', 'R', 'C', 'K', 'P', '1' };
+const unsigned int CHECKPOINT_FILE_VERSION = 1;
+
+// The bytes of a block in the file (its hash and averages), and of a bar of the open block (its inputs and averages).
+const unsigned long long CHECKPOINT_FILE_BLOCK_BYTES = sizeof(unsigned long long) + 2 * CHECKPOINT_BLOCK_BARS * sizeof(float);
+const unsigned long long CHECKPOINT_FILE_BAR_BYTES = sizeof(unsigned long long) + 2 * sizeof(float);
+
+// Hash of the inputs of bars First to End - 1. Consecutive bars go into independent lanes, so the multiplies overlap instead of waiting on each other.
+inline unsigned long long Checkpoint_HashInputs(const float* Fast_In, const float* Slow_In, int First, int End)
+{
+    unsigned long long Lanes[CHECKPOINT_HASH_LANES];
+    for (int Lane = 0; Lane < CHECKPOINT_HASH_LANES; Lane++)
+        Lanes[Lane] = 0x243F6A8885A308D3ULL * (Lane + 1);
+
+    int Index = First;
+    for (; Index + CHECKPOINT_HASH_LANES <= End; Index += CHECKPOINT_HASH_LANES)
+    {
+        for (int Lane = 0; Lane < CHECKPOINT_HASH_LANES; Lane++)
+            Lanes[Lane] = Checkpoint_Mix(Lanes[Lane], Checkpoint_InputWord(Fast_In[Index + Lane], Slow_In[Index + Lane]));
+    }
+
+    for (; Index < End; Index++)
+        Lanes[0] = Checkpoint_Mix(Lanes[0], Checkpoint_InputWord(Fast_In[Index], Slow_In[Index]));
+
+    unsigned long long Hash = Lanes[0];
+    for (int Lane = 1; Lane < CHECKPOINT_HASH_LANES; Lane++)
+        Hash = Checkpoint_Mix(Hash, Lanes[Lane]);
+
+    return Hash;
+}
+
+// Reads Count values into Values, false when the file ends first.
+template <typename T>
+inline bool Checkpoint_Read(std::FILE* File, T* Values, size_t Count)
+{
+    return Count == 0 || std::fread(Values, sizeof(T), Count, File) == Count;
+}
+
+template <typename T>
+inline bool Checkpoint_Write(std::FILE* File, const T* Values, size_t Count)
+{
+    return Count == 0 || std::fwrite(Values, sizeof(T), Count, File) == Count;
+}
+
+class c_CrossoverCheckpoints
+{
+public:
+    c_CrossoverCheckpoints()
+        : m_OpenCount(0)
+        , m_Unsaved(false)
+    {
+    }
+
+    void Clear()
+    {
+        m_Fast.clear();
+        m_Slow.clear();
+        m_Hashes.clear();
+        m_OpenCount = 0;
+        m_Unsaved = true;
+    }
+
+    // Keeps the history only when it was recorded with the same settings.
+    void Bind(const s_CheckpointKey& Key)
+    {
+        if (!(Key == m_Key))
+            Clear();
+
+        m_Key = Key;
+    }
+
+    // Bars recorded so far.
+    int Count() const
+    {
+        return static_cast<int>(m_Hashes.size()) * CHECKPOINT_BLOCK_BARS + m_OpenCount;
+    }
+
+    // The first of bars 0 to Count - 1 whose inputs differ from the recorded ones: the start of the first block that fails its checkpoint, the exact bar within the open block, or the end of the history when none differ.
+    int FirstChangedBar(const float* Fast_In, const float* Slow_In, int Count) const
+    {
+        const int Blocks = static_cast<int>(m_Hashes.size());
+
+        for (int Block = 0; Block < Blocks; Block++)
+        {
+            const int First = Block * CHECKPOINT_BLOCK_BARS;
+            const int End = First + CHECKPOINT_BLOCK_BARS;
+
+            if (End > Count || Checkpoint_HashInputs(Fast_In, Slow_In, First, End) != m_Hashes[Block])
+                return First;
+        }
+
+        const int Open_First = Blocks * CHECKPOINT_BLOCK_BARS;
+        const int End = Open_First + m_OpenCount < Count ? Open_First + m_OpenCount : Count;
+
+        for (int Index = Open_First; Index < End; Index++)
+        {
+            if (Checkpoint_InputWord(Fast_In[Index], Slow_In[Index]) != m_OpenInputs[Index - Open_First])
+                return Index;
+        }
+
+        return End;
+    }
+
+    // A rewind to BarIndex of a series of Count bars, or 0 when the batch kernels from bar 0 are the faster way.
+    static int ResumeIndex(int BarIndex, int Count)
+    {
+        if (BarIndex <= 0 || static_cast<long long>(Count - BarIndex) * CHECKPOINT_RESUME_FRACTION > Count)
+            return 0;
+
+        return BarIndex;
+    }
+
+    // Writes the recorded averages of bars 0 to Count - 1 into the outputs.
+    void Restore(float* Fast_Out, float* Slow_Out, int Count) const
+    {
+        if (Count > this->Count())
+            Count = this->Count();
+
+        const int Block_Bars = static_cast<int>(m_Fast.size()) < Count ? static_cast<int>(m_Fast.size()) : Count;
+        if (Block_Bars > 0)
+        {
+            std::memcpy(Fast_Out, &m_Fast[0], Block_Bars * sizeof(float));
+            std::memcpy(Slow_Out, &m_Slow[0], Block_Bars * sizeof(float));
+        }
+
+        if (Count > Block_Bars)
+        {
+            std::memcpy(Fast_Out + Block_Bars, m_OpenFast, (Count - Block_Bars) * sizeof(float));
+            std::memcpy(Slow_Out + Block_Bars, m_OpenSlow, (Count - Block_Bars) * sizeof(float));
+        }
+    }
+
+    // Forgets bars Count and later. Inside a block that already has its checkpoint, back to the start of that block, whose inputs are no longer kept.
+    void Truncate(int Count)
+    {
+        if (Count >= this->Count())
+            return;
+
+        if (Count < 0)
+            Count = 0;
+
+        m_Unsaved = true;
+
+        const size_t Blocks = Count / CHECKPOINT_BLOCK_BARS;
+        if (Blocks < m_Hashes.size())
+        {
+            m_Hashes.resize(Blocks);
+            m_Fast.resize(Blocks * CHECKPOINT_BLOCK_BARS);
+            m_Slow.resize(Blocks * CHECKPOINT_BLOCK_BARS);
+            m_OpenCount = 0;
+        }
+        else
+        {
+            m_OpenCount = Count - static_cast<int>(Blocks) * CHECKPOINT_BLOCK_BARS;
+        }
+    }
+
+    // Appends bars Count() to Count - 1, which must be final. Each block they complete moves into the history with its checkpoint.
+    void Record(const float* Fast_In, const float* Slow_In, const float* Fast_Out, const float* Slow_Out, int Count)
+    {
+        if (Count <= this->Count())
+            return;
+
+        m_Unsaved = true;
+
+        // Sized once for a long run of bars (a full recalculation), rather than grown block by block.
+        const size_t Block_Bars = static_cast<size_t>(Count / CHECKPOINT_BLOCK_BARS) * CHECKPOINT_BLOCK_BARS;
+        if (Block_Bars > m_Fast.capacity())
+        {
+            m_Fast.reserve(Block_Bars);
+            m_Slow.reserve(Block_Bars);
+            m_Hashes.reserve(Block_Bars / CHECKPOINT_BLOCK_BARS);
+        }
+
+        int Index = this->Count();
+
+        while (Index < Count)
+        {
+            // A whole block at a block start goes straight into the history.
+            if (m_OpenCount == 0 && Index + CHECKPOINT_BLOCK_BARS <= Count)
+            {
+                m_Hashes.push_back(Checkpoint_HashInputs(Fast_In, Slow_In, Index, Index + CHECKPOINT_BLOCK_BARS));
+                m_Fast.insert(m_Fast.end(), Fast_Out + Index, Fast_Out + Index + CHECKPOINT_BLOCK_BARS);
+                m_Slow.insert(m_Slow.end(), Slow_Out + Index, Slow_Out + Index + CHECKPOINT_BLOCK_BARS);
+                Index += CHECKPOINT_BLOCK_BARS;
+                continue;
+            }
+
+            m_OpenInputs[m_OpenCount] = Checkpoint_InputWord(Fast_In[Index], Slow_In[Index]);
+            m_OpenFast[m_OpenCount] = Fast_Out[Index];
+            m_OpenSlow[m_OpenCount] = Slow_Out[Index];
+            Index++;
+
+            if (++m_OpenCount == CHECKPOINT_BLOCK_BARS)
+            {
+                m_Hashes.push_back(Checkpoint_HashInputs(Fast_In, Slow_In, Index - CHECKPOINT_BLOCK_BARS, Index));
+                m_Fast.insert(m_Fast.end(), m_OpenFast, m_OpenFast + CHECKPOINT_BLOCK_BARS);
+                m_Slow.insert(m_Slow.end(), m_OpenSlow, m_OpenSlow + CHECKPOINT_BLOCK_BARS);
+                m_OpenCount = 0;
+            }
+        }
+    }
+
+    // False when the history is the one last saved or loaded.
+    bool Unsaved() const
+    {
+        return m_Unsaved;
+    }
+
+    // Writes the history to Path, through a temporary file next to it so a save that fails midway leaves the previous file. Returns false with Error set.
+    bool Save(const char* Path, std::string& Error)
+    {
+        const std::string Temporary_Path = std::string(Path) + ".tmp";
+
+        std::FILE* File = std::fopen(Temporary_Path.c_str(), "wb");
+        if (File == NULL)
+        {
+            Error = std::string("cannot create ") + Temporary_Path;
+            return false;
+        }
+
+        const s_CheckpointFileHeader Header = FileHeader();
+        bool Written = Checkpoint_Write(File, &Header, 1)
+            && Checkpoint_Write(File, m_Hashes.data(), m_Hashes.size())
+            && Checkpoint_Write(File, m_Fast.data(), m_Fast.size())
+            && Checkpoint_Write(File, m_Slow.data(), m_Slow.size())
+            && Checkpoint_Write(File, m_OpenInputs, m_OpenCount)
+            && Checkpoint_Write(File, m_OpenFast, m_OpenCount)
+            && Checkpoint_Write(File, m_OpenSlow, m_OpenCount);
+
+        Written = std::fclose(File) == 0 && Written;
+
+        // rename does not replace an existing file on Windows.
+        std::remove(Path);
+        if (!Written || std::rename(Temporary_Path.c_str(), Path) != 0)
+        {
+            std::remove(Temporary_Path.c_str());
+            Error = std::string("cannot write ") + Path;
+            return false;
+        }
+
+        m_Unsaved = false;
+        return true;
+    }
+
+    // Replaces the history with the one saved in Path. Returns false with the history cleared, and Error set unless there is no file.
+    bool Load(const char* Path, std::string& Error)
+    {
+        Clear();
+
+        std::FILE* File = std::fopen(Path, "rb");
+        if (File == NULL)
+            return false;
+
+        s_CheckpointFileHeader Header;
+        bool Valid = Checkpoint_Read(File, &Header, 1)
+            && std::memcmp(Header.Magic, CHECKPOINT_FILE_MAGIC, sizeof(Header.Magic)) == 0
+            && Header.Version == CHECKPOINT_FILE_VERSION
+            && Header.BlockBars == CHECKPOINT_BLOCK_BARS
+            && Header.Blocks >= 0 && Header.Blocks <= (0x7FFFFFFF - CHECKPOINT_BLOCK_BARS) / CHECKPOINT_BLOCK_BARS
+            && Header.OpenCount >= 0 && Header.OpenCount < CHECKPOINT_BLOCK_BARS
+            && FileSize(File) == static_cast<long long>(sizeof(Header) + Header.Blocks * CHECKPOINT_FILE_BLOCK_BYTES + Header.OpenCount * CHECKPOINT_FILE_BAR_BYTES);
+
+        if (Valid)
+        {
+            const size_t Block_Bars = static_cast<size_t>(Header.Blocks) * CHECKPOINT_BLOCK_BARS;
+            m_Hashes.resize(Header.Blocks);
+            m_Fast.resize(Block_Bars);
+            m_Slow.resize(Block_Bars);
+            m_OpenCount = Header.OpenCount;
+
+            Valid = Checkpoint_Read(File, m_Hashes.data(), m_Hashes.size())
+                && Checkpoint_Read(File, m_Fast.data(), m_Fast.size())
+                && Checkpoint_Read(File, m_Slow.data(), m_Slow.size())
+                && Checkpoint_Read(File, m_OpenInputs, m_OpenCount)
+                && Checkpoint_Read(File, m_OpenFast, m_OpenCount)
+                && Checkpoint_Read(File, m_OpenSlow, m_OpenCount);
+        }
+
+        std::fclose(File);
+
+        if (Valid)
+        {
+            m_Key.FastLength = Header.FastLength;
+            m_Key.SlowLength = Header.SlowLength;
+            m_Key.FastDataIndex = Header.FastDataIndex;
+            m_Key.SlowDataIndex = Header.SlowDataIndex;
+            Valid = Header.Checksum == FileHeader().Checksum;
+        }
+
+        if (!Valid)
+        {
+            Clear();
+            Error = std::string("not a valid checkpoint file: ") + Path;
+            return false;
+        }
+
+        m_Unsaved = false;
+        return true;
+    }
+
+private:
+    c_CrossoverCheckpoints(const c_CrossoverCheckpoints&);
+    c_CrossoverCheckpoints& operator=(const c_CrossoverCheckpoints&);
+
+    // The size of the file in bytes, checked before the history is sized from its header. The position is kept.
+    static long long FileSize(std::FILE* File)
+    {
+        const long Position = std::ftell(File);
+        if (Position < 0 || std::fseek(File, 0, SEEK_END) != 0)
+            return -1;
+
+        const long End = std::ftell(File);
+        std::fseek(File, Position, SEEK_SET);
+        return End;
+    }
+
+    // The header of the file for the current history, with the checksum of the header fields and everything after them.
+    s_CheckpointFileHeader FileHeader() const
+    {
+        s_CheckpointFileHeader Header;
+        std::memcpy(Header.Magic, CHECKPOINT_FILE_MAGIC, sizeof(Header.Magic));
+        Header.Version = CHECKPOINT_FILE_VERSION;
+        Header.BlockBars = CHECKPOINT_BLOCK_BARS;
+        Header.FastLength = m_Key.FastLength;
+        Header.SlowLength = m_Key.SlowLength;
+        Header.FastDataIndex = m_Key.FastDataIndex;
+        Header.SlowDataIndex = m_Key.SlowDataIndex;
+        Header.Blocks = static_cast<int>(m_Hashes.size());
+        Header.OpenCount = m_OpenCount;
+
+        unsigned long long Checksum = Checkpoint_Mix(0x243F6A8885A308D3ULL, CHECKPOINT_FILE_VERSION);
+        Checksum = Checkpoint_Mix(Checksum, (static_cast<unsigned long long>(static_cast<unsigned int>(Header.FastLength)) << 32) | static_cast<unsigned int>(Header.SlowLength));
+        Checksum = Checkpoint_Mix(Checksum, (static_cast<unsigned long long>(static_cast<unsigned int>(Header.FastDataIndex)) << 32) | static_cast<unsigned int>(Header.SlowDataIndex));
+        Checksum = Checkpoint_Mix(Checksum, (static_cast<unsigned long long>(static_cast<unsigned int>(Header.Blocks)) << 32) | static_cast<unsigned int>(Header.OpenCount));
+
+        for (size_t Block = 0; Block < m_Hashes.size(); Block++)
+            Checksum = Checkpoint_Mix(Checksum, m_Hashes[Block]);
+
+        // The averages are hashed as if they were inputs, fast and slow of a bar as one word.
+        if (!m_Fast.empty())
+            Checksum = Checkpoint_Mix(Checksum, Checkpoint_HashInputs(&m_Fast[0], &m_Slow[0], 0, static_cast<int>(m_Fast.size())));
+
+        Checksum = Checkpoint_Mix(Checksum, Checkpoint_HashInputs(m_OpenFast, m_OpenSlow, 0, m_OpenCount));
+
+        for (int Index = 0; Index < m_OpenCount; Index++)
+            Checksum = Checkpoint_Mix(Checksum, m_OpenInputs[Index]);
+
+        Header.Checksum = Checksum;
+        return Header;
+    }
+
+    s_CheckpointKey m_Key;
+    std::vector<float> m_Fast;
+    std::vector<float> m_Slow;
+    std::vector<unsigned long long> m_Hashes;
+    int m_OpenCount;
+    unsigned long long m_OpenInputs[CHECKPOINT_BLOCK_BARS];
+    float m_OpenFast[CHECKPOINT_BLOCK_BARS];
+    float m_OpenSlow[CHECKPOINT_BLOCK_BARS];
+    bool m_Unsaved;
+};
+
+#endif
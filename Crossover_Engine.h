@@ -0,0 +1,1356 @@
+#ifndef CROSSOVER_ENGINE_H
+#define CROSSOVER_ENGINE_H
+
+#include "sierrachart.h"
+#include "MA_Kernels.h"
+#include "MA_Batch_Kernels.h"
+#include "MA_Fixed_Kernels.h"
+#include "MA_Adaptive_Kernels.h"
+#include "MA_Cache.h"
+#include "Study_Timing.h"
+#include "Latency_Trace.h"
+#include "Trade_Log.h"
+#include "Study_Arena.h"
+#include "Crossover_Checkpoint.h"
+#include "Crossover_Timeframes.h"
+
+/*
+Shared engine for the moving average crossover strategies.
+
+All of the crossover studies have the same inputs, subgraphs, trading settings and order logic. The only thing that differs between them is the moving average, so that part is supplied as a policy type:
+Label - short name of the average, used to build the graph, input and subgraph names ("SMA", "EMA", ...).
+Reset - drops any kernel state. Called on a full recalculation.
+ScratchFloats, Attach - the scratch storage the kernel needs for a period, and handing it over. The engine takes it from the study's arena (Study_Arena.h) on each full recalculation.
+ComputeBatch - computes the average over the whole input array. Used when the study recalculates from bar 0.
+Compute - computes the average of the input array for one bar index.
+The engine keeps the kernel state for both averages (s_CrossoverKernels) in persistent memory (sc.GetPersistentPointer), so a policy can carry incremental kernel state from one call to the next. By default that is one policy object per average. s_CrossoverKernels can be specialized for a policy that computes both averages together, as the Hull study does.
+Each study file is a thin SCSFExport wrapper that calls Crossover_Trading<Policy>(sc). The policy is resolved at compile time, so the bar loop is specialized and inlined for each moving average type.
+Adding a new average only needs a new policy and a wrapper; the input and subgraph indexes are the same for every study.
+ResumeAfterBackfill - whether a full recalculation resumes from the first changed bar (Crossover_Checkpoint.h). It pays for the window averages (SMA, Hull), whose batch kernels cost more per bar than checking and restoring the history; the batch EMA is cheaper than that, so the EMA studies recalculate from bar 0.
+TimeframeAverage - the average of the confirmation timeframes (Crossover_Timeframes.h), the same type on the arrays of each higher timeframe.
+FixedFastLength, FixedSlowLength - 0 for a study with configurable periods. A fixed-period variant (EMA_Fixed_Policy<9, 21>, Hull_Fixed_Policy<16, 64>) sets them, pins the period inputs to them and runs the compile-time kernels of MA_Fixed_Kernels.h through its s_CrossoverKernels specialization, exported as its own study next to the configurable one.
+The KAMA, ALMA, T3 and VWMA studies run the kernels of MA_Adaptive_Kernels.h the same way. The ALMA resumes after a backfill, its batch being a dot product of Length values per bar; the VWMA reads the chart's volume, which the checkpoints do not check, so it recalculates from bar 0.
+Full-history averages are shared through the cache in MA_Cache.h between instances that run the same series with the same type and period (see the Share Averages input).
+With ResumeAfterBackfill, a full recalculation keeps the part of the history whose inputs did not change since the last call (Crossover_Checkpoint.h): after a backfill or reload the averages are restored up to the first changed bar and computed from there, and the trade side keeps its state when the bars it already evaluated are unchanged.
+With a Checkpoint Folder, that history is saved to a file per chart and study instance when the study is closed and loaded when it is created (Crossover_Checkpoint.h), so a chart that reopens only computes the bars since it closed.
+With Confirmation Timeframes, a cross only enters when the same averages on each of those higher timeframes trend its way at that bar (Crossover_Timeframes.h). The higher timeframes are built from the chart's own bars, and their trends are the Timeframe Trend subgraphs.
+With Timing Report Interval set, the averages, cross detection, position lookup and order submission are timed (Study_Timing.h) and their p50/p99 written to the message log every that many calls.
+With a Latency Trace File, each signal and entry call is timestamped into a lock-free ring that a background thread writes to the file (Latency_Trace.h).
+With a Trade Log File, every cross, entry call and change of the position with its trade statistics goes the same way to a columnar file for offline analysis (Trade_Log.h). The position is then read once per closed bar to see fills of the attached orders.
+Between ticks the kernels keep the live bar's average as Base + Slope * Last (MA_Kernels.h), so an update of the live bar costs one multiply-add per average (three for the Hull average, which rounds between its WMAs as a recalculation does).
+The calls after a full recalculation make no heap allocations: the kernel windows come from the arena, and the logs and traces copy fixed size records into preallocated rings. Debug builds count the heap allocations of those calls (STUDY_ALLOCATION_COUNTER) and report any in the message log.
+Each call evaluates every bar that closed since the last evaluated one, so bars closed together by a slow update or a reconnect are all traded. A full recalculation (the chart loading its history) only evaluates the newest closed bar and does not trade, unless Trade On Full Recalculation is set: then it trades every cross of the history, as a backtest. With Enter On Confirmed Intrabar Cross, a cross of the live bar that holds for Intrabar Cross Confirmation Updates consecutive updates also enters, at most once per bar, and that bar is not entered again when it closes.
+*/
+
+//================================================================================================//
+// Moving average policies
+// The studies use the kernels in MA_Kernels.h and MA_Batch_Kernels.h rather than the sc.*MovAvg functions, so the batch values written on a full recalculation and the incremental values written afterwards come from the same definitions.
+
+struct SMA_Policy
+{
+    static const char* Label() { return "SMA"; }
+    typedef s_TimeframeSMA TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = true;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_SMAKernel::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int Length)
+    {
+        Kernel.Attach(Scratch, Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Count, int Length)
+    {
+        MA_Batch_SMA(&In[0], &Out[0], Count, Length);
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Index, int Length)
+    {
+        Out[Index] = Kernel.Update(&In[0], Index, Length);
+    }
+
+    s_SMAKernel Kernel;
+};
+
+struct EMA_Policy
+{
+    static const char* Label() { return "EMA"; }
+    typedef s_TimeframeEMA TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = false;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_EMAKernel::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int Length)
+    {
+        Kernel.Attach(Scratch, Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Count, int Length)
+    {
+        MA_Batch_EMA(&In[0], &Out[0], Count, Length);
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Index, int Length)
+    {
+        Out[Index] = Kernel.Update(&In[0], &Out[0], Index, Length);
+    }
+
+    s_EMAKernel Kernel;
+};
+
+struct ZLEMA_Policy
+{
+    static const char* Label() { return "ZLEMA"; }
+    typedef s_TimeframeZLEMA TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = false;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_ZLEMAKernel::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int Length)
+    {
+        Kernel.Attach(Scratch, Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Count, int Length)
+    {
+        MA_Batch_ZLEMA(&In[0], &Out[0], Count, Length);
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Index, int Length)
+    {
+        Out[Index] = Kernel.Update(&In[0], &Out[0], Index, Length);
+    }
+
+    s_ZLEMAKernel Kernel;
+};
+
+struct Hull_Policy
+{
+    static const char* Label() { return "Hull"; }
+    typedef s_TimeframeHull TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = true;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_HMAKernel::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int Length)
+    {
+        Kernel.Attach(Scratch, Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Count, int Length)
+    {
+        MA_Batch_HMA(&In[0], &Out[0], &Out.Arrays[0][0], Count, Length);
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Index, int Length)
+    {
+        Out[Index] = Kernel.Update(&In[0], Index, Length);
+    }
+
+    s_HMAKernel Kernel;
+};
+
+struct KAMA_Policy
+{
+    static const char* Label() { return "KAMA"; }
+    typedef s_TimeframeKAMA TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = false;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_KAMAKernel::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int Length)
+    {
+        Kernel.Attach(Scratch, Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Count, int Length)
+    {
+        MA_Batch_KAMA(&In[0], &Out[0], Count, Length);
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Index, int Length)
+    {
+        Out[Index] = Kernel.Update(&In[0], &Out[0], Index, Length);
+    }
+
+    s_KAMAKernel Kernel;
+};
+
+struct ALMA_Policy
+{
+    static const char* Label() { return "ALMA"; }
+    typedef s_TimeframeALMA TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = true;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_ALMAKernel::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int Length)
+    {
+        Kernel.Attach(Scratch, Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Count, int Length)
+    {
+        MA_Batch_ALMA(&In[0], &Out[0], Count, Length);
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef In, SCSubgraphRef Out, int Index, int Length)
+    {
+        Out[Index] = Kernel.Update(&In[0], Index, Length);
+    }
+
+    s_ALMAKernel Kernel;
+};
+
+// Weighs the input by the chart's volume (SC_VOLUME), whatever the input field is.
+struct VWMA_Policy
+{
+    static const char* Label() { return "VWMA"; }
+    typedef s_TimeframeVWMA TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = false;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_VWMAKernel::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int Length)
+    {
+        Kernel.Attach(Scratch, Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef sc, SCFloatArrayRef In, SCSubgraphRef Out, int Count, int Length)
+    {
+        MA_Batch_VWMA(&In[0], &sc.BaseDataIn[SC_VOLUME][0], &Out[0], Count, Length);
+    }
+
+    void Compute(SCStudyInterfaceRef sc, SCFloatArrayRef In, SCSubgraphRef Out, int Index, int Length)
+    {
+        Out[Index] = Kernel.Update(&In[0], &sc.BaseDataIn[SC_VOLUME][0], Index, Length);
+    }
+
+    s_VWMAKernel Kernel;
+};
+
+//================================================================================================//
+// Crossover study body
+
+// Kernel state for the faster and slower average. By default each average runs its own policy object.
+template <typename MAPolicy>
+struct s_CrossoverKernels
+{
+    MAPolicy Fast;
+    MAPolicy Slow;
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    // Takes the scratch storage of both averages from Arena, sized for these periods, and resets them.
+    void Reserve(c_StudyArena& Arena, int Fast_Length, int Slow_Length)
+    {
+        const int Fast_Floats = MAPolicy::ScratchFloats(Fast_Length);
+        const int Slow_Floats = MAPolicy::ScratchFloats(Slow_Length);
+
+        Arena.Reset(c_StudyArena::SizeOf<float>(Fast_Floats) + c_StudyArena::SizeOf<float>(Slow_Floats));
+        Fast.Attach(Arena.Allocate<float>(Fast_Floats), Fast_Length);
+        Slow.Attach(Arena.Allocate<float>(Slow_Floats), Slow_Length);
+    }
+
+    // Whole history: one batch call per average. The kernels resync from the written arrays on the next call.
+    void ComputeBatch(SCStudyInterfaceRef sc, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Count, int Fast_Length, int Slow_Length)
+    {
+        Fast.ComputeBatch(sc, Fast_In, Fast_Out, Count, Fast_Length);
+        Slow.ComputeBatch(sc, Slow_In, Slow_Out, Count, Slow_Length);
+        Reset();
+    }
+
+    void Compute(SCStudyInterfaceRef sc, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Index, int Fast_Length, int Slow_Length)
+    {
+        Fast.Compute(sc, Fast_In, Fast_Out, Index, Fast_Length);
+        Slow.Compute(sc, Slow_In, Slow_Out, Index, Slow_Length);
+    }
+};
+
+// The Hull averages are fused on the per-bar path: one read of the input updates the O(1) WMA windows of both averages,
+// instead of two sc.HullMovingAverage calls doing three weighted passes each.
+// A recalculation from bar 0 still uses the AVX2 batch kernel per average, which is faster over the whole history, and the pair kernel resyncs on the next call.
+template <>
+struct s_CrossoverKernels<Hull_Policy>
+{
+    s_HMAPairKernel Kernel;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    void Reserve(c_StudyArena& Arena, int Fast_Length, int Slow_Length)
+    {
+        const int Floats = s_HMAPairKernel::ScratchFloats(Fast_Length, Slow_Length);
+
+        Arena.Reset(c_StudyArena::SizeOf<float>(Floats));
+        Kernel.Attach(Arena.Allocate<float>(Floats), Fast_Length, Slow_Length);
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Count, int Fast_Length, int Slow_Length)
+    {
+        MA_Batch_HMA(&Fast_In[0], &Fast_Out[0], &Fast_Out.Arrays[0][0], Count, Fast_Length);
+        MA_Batch_HMA(&Slow_In[0], &Slow_Out[0], &Slow_Out.Arrays[0][0], Count, Slow_Length);
+        Reset();
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Index, int Fast_Length, int Slow_Length)
+    {
+        Kernel.Update(&Fast_In[0], &Slow_In[0], Index, Fast_Length, Slow_Length, Fast_Out[Index], Slow_Out[Index]);
+    }
+};
+
+// Fixed-period variants. The policy only names the average and its periods; the kernels are the MA_Fixed_Kernels.h ones of the specializations below.
+// The batch path of a full recalculation is the same as the configurable study's.
+template <int FastLength, int SlowLength>
+struct EMA_Fixed_Policy
+{
+    static const char* Label() { return "EMA"; }
+    typedef s_TimeframeEMA TimeframeAverage;
+    static const int FixedFastLength = FastLength;
+    static const int FixedSlowLength = SlowLength;
+    static const bool ResumeAfterBackfill = false;
+};
+
+template <int FastLength, int SlowLength>
+struct Hull_Fixed_Policy
+{
+    static const char* Label() { return "Hull"; }
+    typedef s_TimeframeHull TimeframeAverage;
+    static const int FixedFastLength = FastLength;
+    static const int FixedSlowLength = SlowLength;
+    static const bool ResumeAfterBackfill = true;
+};
+
+template <int FastLength, int SlowLength>
+struct s_CrossoverKernels<EMA_Fixed_Policy<FastLength, SlowLength> >
+{
+    s_EMAFixedKernel<FastLength> Fast;
+    s_EMAFixedKernel<SlowLength> Slow;
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    // The EMA has no window, so nothing comes from the arena.
+    void Reserve(c_StudyArena&, int, int)
+    {
+        Reset();
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Count, int, int)
+    {
+        MA_Batch_EMA(&Fast_In[0], &Fast_Out[0], Count, FastLength);
+        MA_Batch_EMA(&Slow_In[0], &Slow_Out[0], Count, SlowLength);
+        Reset();
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Index, int, int)
+    {
+        Fast_Out[Index] = Fast.Update(&Fast_In[0], &Fast_Out[0], Index);
+        Slow_Out[Index] = Slow.Update(&Slow_In[0], &Slow_Out[0], Index);
+    }
+};
+
+template <int FastLength, int SlowLength>
+struct s_CrossoverKernels<Hull_Fixed_Policy<FastLength, SlowLength> >
+{
+    s_HMAPairFixedKernel<FastLength, SlowLength> Kernel;
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    // The WMA windows are members of fixed size, so nothing comes from the arena.
+    void Reserve(c_StudyArena&, int, int)
+    {
+        Reset();
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Count, int, int)
+    {
+        MA_Batch_HMA(&Fast_In[0], &Fast_Out[0], &Fast_Out.Arrays[0][0], Count, FastLength);
+        MA_Batch_HMA(&Slow_In[0], &Slow_Out[0], &Slow_Out.Arrays[0][0], Count, SlowLength);
+        Reset();
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Index, int, int)
+    {
+        Kernel.Update(&Fast_In[0], &Slow_In[0], Index, Fast_Out[Index], Slow_Out[Index]);
+    }
+};
+
+// T3 keeps its cascade from the batch call instead of resetting after it, since a resync replays the input from bar 0 (MA_Adaptive_Kernels.h).
+// Only averages loaded from the shared cache pay that replay, once, on the next call.
+struct T3_Policy
+{
+    static const char* Label() { return "T3"; }
+    typedef s_TimeframeT3 TimeframeAverage;
+    static const int FixedFastLength = 0;
+    static const int FixedSlowLength = 0;
+    static const bool ResumeAfterBackfill = false;
+};
+
+template <>
+struct s_CrossoverKernels<T3_Policy>
+{
+    s_T3Kernel Fast;
+    s_T3Kernel Slow;
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    // The EMA stages are members, so nothing comes from the arena.
+    void Reserve(c_StudyArena&, int, int)
+    {
+        Reset();
+    }
+
+    void ComputeBatch(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Count, int Fast_Length, int Slow_Length)
+    {
+        MA_Batch_T3(&Fast_In[0], &Fast_Out[0], Count, Fast_Length, Fast);
+        MA_Batch_T3(&Slow_In[0], &Slow_Out[0], Count, Slow_Length, Slow);
+    }
+
+    void Compute(SCStudyInterfaceRef, SCFloatArrayRef Fast_In, SCSubgraphRef Fast_Out, SCFloatArrayRef Slow_In, SCSubgraphRef Slow_Out, int Index, int Fast_Length, int Slow_Length)
+    {
+        Fast_Out[Index] = Fast.Update(&Fast_In[0], Index, Fast_Length);
+        Slow_Out[Index] = Slow.Update(&Slow_In[0], Index, Slow_Length);
+    }
+};
+
+// Confirmation of a cross on the live bar. A cross is confirmed when the same direction is seen on Confirmation consecutive updates of the bar.
+// It fires at most once per bar.
+struct s_IntrabarCross
+{
+    int BarIndex;
+    int Direction;
+    int Count;
+    int TradedBarIndex;
+
+    s_IntrabarCross()
+    {
+        Clear();
+    }
+
+    void Clear()
+    {
+        BarIndex = -1;
+        Direction = NO_CROSS;
+        Count = 0;
+        TradedBarIndex = -1;
+    }
+
+    // Returns the cross to act on, or NO_CROSS.
+    int Update(int Cross, int LiveBarIndex, int Confirmation)
+    {
+        if (LiveBarIndex != BarIndex)
+        {
+            BarIndex = LiveBarIndex;
+            Direction = NO_CROSS;
+            Count = 0;
+        }
+
+        if (TradedBarIndex == LiveBarIndex)
+            return NO_CROSS;
+
+        if (Cross != Direction)
+        {
+            Direction = Cross;
+            Count = 0;
+        }
+
+        if (Cross == NO_CROSS || ++Count < Confirmation)
+            return NO_CROSS;
+
+        TradedBarIndex = LiveBarIndex;
+        return Cross;
+    }
+};
+
+// The inputs as the body uses them, and the order every entry starts from.
+// Read when the state is created and again on each full recalculation, which Sierra Chart makes whenever an input changes, so other calls do not touch sc.Input.
+struct s_CrossoverSettings
+{
+    int FastLength;
+    int SlowLength;
+    int FastDataIndex;
+    int SlowDataIndex;
+    bool ShareAverages;
+    bool IntrabarSignals;
+    int IntrabarConfirmation;
+    bool TradeFullRecalculation;
+    int TimingInterval;
+    std::string TracePath;
+    std::string LogPath;
+    std::string CheckpointFolder;
+    int ConfirmationMinutes[TIMEFRAME_MAX_LEGS];
+    int ConfirmationCount;
+    bool ConfirmationValid;
+
+    float TickSize;
+    s_SCNewOrder Order;
+
+    s_CrossoverSettings()
+        : FastLength(0)
+        , SlowLength(0)
+        , FastDataIndex(SC_LAST)
+        , SlowDataIndex(SC_LAST)
+        , ShareAverages(false)
+        , IntrabarSignals(false)
+        , IntrabarConfirmation(1)
+        , TradeFullRecalculation(false)
+        , TimingInterval(0)
+        , ConfirmationCount(0)
+        , ConfirmationValid(true)
+        , TickSize(-1.0f)
+    {
+    }
+
+    void Read(SCStudyInterfaceRef sc)
+    {
+        FastLength = sc.Input[0].GetInt();
+        SlowLength = sc.Input[1].GetInt();
+        FastDataIndex = sc.Input[2].GetInputDataIndex();
+        SlowDataIndex = sc.Input[3].GetInputDataIndex();
+        ShareAverages = sc.Input[6].GetYesNo() != 0;
+        IntrabarSignals = sc.Input[7].GetYesNo() != 0;
+        IntrabarConfirmation = sc.Input[8].GetInt();
+        TradeFullRecalculation = sc.Input[9].GetYesNo() != 0;
+        TimingInterval = sc.Input[10].GetInt();
+        TracePath = sc.Input[11].GetString() != NULL ? sc.Input[11].GetString() : "";
+        LogPath = sc.Input[12].GetString() != NULL ? sc.Input[12].GetString() : "";
+        CheckpointFolder = sc.Input[13].GetString() != NULL ? sc.Input[13].GetString() : "";
+
+        ConfirmationValid = Timeframe_ParseMinutes(sc.Input[14].GetString() != NULL ? sc.Input[14].GetString() : "", ConfirmationMinutes, ConfirmationCount);
+        if (!ConfirmationValid)
+            ConfirmationCount = 0;
+
+        TickSize = sc.TickSize;
+
+        Order = s_SCNewOrder();
+        Order.OrderQuantity = 1;
+        Order.OrderType = SCT_ORDERTYPE_MARKET;
+        Order.TimeInForce = SCT_TIF_GOOD_TILL_CANCELED;
+        Order.AttachedOrderTarget1Type = SCT_ORDERTYPE_LIMIT;
+        Order.AttachedOrderStop1Type = SCT_ORDERTYPE_TRAILING_STOP;
+        Order.Target1Offset = sc.Input[4].GetInt() * sc.TickSize;
+        Order.Stop1Offset = sc.Input[5].GetInt() * sc.TickSize;
+    }
+
+    bool NeedsRead(SCStudyInterfaceRef sc) const
+    {
+        return sc.IsFullRecalculation || sc.TickSize != TickSize;
+    }
+};
+
+// Everything the study keeps between calls.
+template <typename MAPolicy>
+struct s_CrossoverState
+{
+    s_CrossoverSettings Settings;
+    c_StudyArena Arena;
+    s_CrossoverKernels<MAPolicy> Kernels;
+    s_MACacheHandle FastCache;
+    s_MACacheHandle SlowCache;
+    c_CrossoverCheckpoints Checkpoints;
+    std::string CheckpointPath;
+    c_TimeframeConfirmation<typename MAPolicy::TimeframeAverage> Timeframes;
+    s_IntrabarCross Intrabar;
+    int ClosedBarCross;
+    c_StudyTiming Timing;
+    c_LatencyTracer* p_Tracer;
+    c_TradeLog* p_Log;
+    bool AllocationReported;
+
+    s_CrossoverState()
+        : ClosedBarCross(NO_CROSS)
+        , p_Tracer(NULL)
+        , p_Log(NULL)
+        , AllocationReported(false)
+    {
+    }
+
+    ~s_CrossoverState()
+    {
+        delete p_Tracer;
+        delete p_Log;
+    }
+
+private:
+    s_CrossoverState(const s_CrossoverState&);
+    s_CrossoverState& operator=(const s_CrossoverState&);
+};
+
+inline s_MACacheKey MA_CacheKey(SCStudyInterfaceRef sc, const char* Type, int InputIndex, int Period)
+{
+    s_MACacheKey Key;
+    Key.Symbol = sc.Symbol.GetChars();
+    Key.ChartNumber = sc.ChartNumber;
+    Key.InputIndex = InputIndex;
+    Key.Type = Type;
+    Key.Period = Period;
+    return Key;
+}
+
+// Volume is the chart's Volume for averages weighted by it, NULL otherwise. The hash reads every bar once, which costs less than computing the average it guards.
+inline s_MASeriesStamp MA_SeriesStamp(SCStudyInterfaceRef sc, SCFloatArrayRef In, const float* Volume)
+{
+    s_MASeriesStamp Stamp;
+    Stamp.Count = sc.ArraySize;
+    if (Stamp.Count <= 0)
+        return Stamp;
+
+    Stamp.FirstDateTime = sc.BaseDateTimeIn[0].GetAsDouble();
+    Stamp.LastDateTime = sc.BaseDateTimeIn[Stamp.Count - 1].GetAsDouble();
+    Stamp.InputHash = Checkpoint_HashInputs(&In[0], Volume != NULL ? Volume : &In[0], 0, Stamp.Count);
+    return Stamp;
+}
+
+// The first of the Timeframe Trend subgraphs, one per confirmation timeframe.
+const int CROSSOVER_TREND_SUBGRAPH = 2;
+
+// How a higher timeframe bar aggregates the chart's values of the input field DataIndex.
+inline int Crossover_TimeframeRule(int DataIndex)
+{
+    switch (DataIndex)
+    {
+        case SC_OPEN: return TIMEFRAME_FIRST;
+        case SC_HIGH: return TIMEFRAME_MAX;
+        case SC_LOW: return TIMEFRAME_MIN;
+        case SC_VOLUME:
+        case SC_NUM_TRADES:
+        case SC_BIDVOL:
+        case SC_ASKVOL:
+            return TIMEFRAME_SUM;
+    }
+
+    return TIMEFRAME_LAST;
+}
+
+// Whether every confirmation timeframe trends the way of Cross at BarIndex. Always true without confirmation timeframes.
+inline bool Crossover_TimeframesConfirm(SCStudyInterfaceRef sc, int LegCount, int Cross, int BarIndex)
+{
+    const float Direction = Cross == CROSS_FROM_BOTTOM ? 1.0f : -1.0f;
+
+    for (int Leg = 0; Leg < LegCount; Leg++)
+    {
+        if (sc.Subgraph[CROSSOVER_TREND_SUBGRAPH + Leg][BarIndex] != Direction)
+            return false;
+    }
+
+    return true;
+}
+
+// The checkpoint file of this study instance in Folder, empty when Folder is.
+inline std::string Crossover_CheckpointPath(SCStudyInterfaceRef sc, const char* Label, const std::string& Folder)
+{
+    if (Folder.empty())
+        return std::string();
+
+    char Name[96];
+    std::snprintf(Name, sizeof(Name), "%s_Crossover_C%d_S%d.xcp", Label, sc.ChartNumber, sc.StudyGraphInstanceID);
+
+    const char Last = Folder[Folder.size() - 1];
+    return Last == '/' || Last == '\\' ? Folder + Name : Folder + "/" + Name;
+}
+
+// Pushes a trade log record for the cross at BarIndex.
+inline void Crossover_LogSignal(SCStudyInterfaceRef sc, c_TradeLog& Log, int Cross, int BarIndex, int Flags)
+{
+    if (Cross != CROSS_FROM_BOTTOM && Cross != CROSS_FROM_TOP)
+        return;
+
+    s_TradeLogRecord Record;
+    Record.Kind = TRADE_LOG_SIGNAL;
+    Record.Direction = Cross == CROSS_FROM_BOTTOM ? 1 : -1;
+    Record.Flags = static_cast<short>(Flags);
+    Record.BarIndex = BarIndex;
+    Record.DateTime = sc.BaseDateTimeIn[BarIndex].GetAsDouble();
+    Record.Price = sc.BaseDataIn[SC_LAST][BarIndex];
+    Record.Value1 = sc.Subgraph[0][BarIndex];
+    Record.Value2 = sc.Subgraph[1][BarIndex];
+    Log.Write(Record);
+}
+
+// Pushes a trade log record with the position and the trade statistics when they changed since the last one.
+inline void Crossover_LogPosition(SCStudyInterfaceRef sc, c_TradeLog& Log, int BarIndex, int Flags)
+{
+    s_SCPositionData PositionData;
+    sc.GetTradePosition(PositionData);
+
+    s_TradeLogRecord Record;
+    Record.Kind = TRADE_LOG_POSITION;
+    Record.Flags = static_cast<short>(Flags);
+    Record.BarIndex = BarIndex;
+    Record.DateTime = sc.BaseDateTimeIn[BarIndex].GetAsDouble();
+    Record.Quantity = static_cast<int>(PositionData.PositionQuantity);
+    Record.Direction = static_cast<short>(Record.Quantity > 0 ? 1 : (Record.Quantity < 0 ? -1 : 0));
+    Record.Price = PositionData.AveragePrice;
+    Record.Value1 = PositionData.OpenProfitLoss;
+    Record.Value2 = PositionData.CumulativeProfitLoss;
+    Record.Value3 = PositionData.LastTradeProfitLoss;
+    Record.Trades = PositionData.TotalTrades;
+    Record.Wins = PositionData.WinTrades;
+    Log.Position(Record);
+}
+
+// Closes the open position before an opposite entry at BarIndex. The bars of a full recalculation's backtest are history, so they exit with a market order at that bar rather than at the current price.
+inline void Crossover_Flatten(SCStudyInterfaceRef sc, const s_SCPositionData& PositionData, int BarIndex)
+{
+    if (!sc.IsFullRecalculation)
+    {
+        sc.FlattenPosition();
+        return;
+    }
+
+    s_SCNewOrder ExitOrder;
+    ExitOrder.OrderQuantity = static_cast<int>(std::fabs(PositionData.PositionQuantity));
+    ExitOrder.OrderType = SCT_ORDERTYPE_MARKET;
+
+    if (PositionData.PositionQuantity > 0)
+        sc.SellExit(ExitOrder, BarIndex);
+    else
+        sc.BuyExit(ExitOrder, BarIndex);
+}
+
+// Entry on a cross at BarIndex from the prepared order: flattens an opposite position, then enters with the target and trailing stop bracket.
+// p_Tracer, when not NULL, records the signal and the entry call. p_Log, when not NULL, logs the entry call with Flags.
+inline void Crossover_Enter(SCStudyInterfaceRef sc, int Cross, int BarIndex, const s_SCNewOrder& Order, c_StudyTiming& Timing, c_LatencyTracer* p_Tracer, c_TradeLog* p_Log, int Flags)
+{
+    if (Cross != CROSS_FROM_BOTTOM && Cross != CROSS_FROM_TOP)
+        return;
+
+    const int Direction = Cross == CROSS_FROM_BOTTOM ? 1 : -1;
+    const double MarketTime = sc.LatestDateTimeForLastBar.GetAsDouble();
+    const unsigned int Sequence = p_Tracer != NULL ? p_Tracer->Signal(BarIndex, Direction, MarketTime) : 0;
+
+    // The entry functions write the order IDs back, so each entry gets its own copy.
+    s_SCNewOrder NewOrder = Order;
+
+    // Check for already Open Position
+    unsigned long long Start = Timing.Begin();
+    s_SCPositionData PositionData;
+    sc.GetTradePosition(PositionData);
+    Timing.End(TIMING_POSITION_LOOKUP, Start);
+
+    Start = Timing.Begin();
+    double Result = 0.0;
+
+    if (Cross == CROSS_FROM_BOTTOM)
+    {
+        if (PositionData.PositionQuantity < 0)
+        {
+            sc.CancelAllOrders();
+            Crossover_Flatten(sc, PositionData, BarIndex);
+        }
+
+        if (p_Tracer != NULL)
+            p_Tracer->Record(LATENCY_ORDER_BEGIN, Sequence, BarIndex, Direction, MarketTime, 0.0);
+
+        Result = sc.BuyEntry(NewOrder, BarIndex);
+
+        if (p_Tracer != NULL)
+            p_Tracer->Record(LATENCY_ORDER_END, Sequence, BarIndex, Direction, MarketTime, Result);
+    }
+    else
+    {
+        if (PositionData.PositionQuantity > 0)
+        {
+            sc.CancelAllOrders();
+            Crossover_Flatten(sc, PositionData, BarIndex);
+        }
+
+        if (p_Tracer != NULL)
+            p_Tracer->Record(LATENCY_ORDER_BEGIN, Sequence, BarIndex, Direction, MarketTime, 0.0);
+
+        Result = sc.SellEntry(NewOrder, BarIndex);
+
+        if (p_Tracer != NULL)
+            p_Tracer->Record(LATENCY_ORDER_END, Sequence, BarIndex, Direction, MarketTime, Result);
+    }
+
+    Timing.End(TIMING_ORDER_SUBMISSION, Start);
+
+    if (p_Log != NULL)
+    {
+        s_TradeLogRecord Record;
+        Record.Kind = TRADE_LOG_ENTRY;
+        Record.Direction = static_cast<short>(Direction);
+        Record.Flags = static_cast<short>(Flags);
+        Record.BarIndex = BarIndex;
+        Record.DateTime = sc.BaseDateTimeIn[BarIndex].GetAsDouble();
+        Record.Price = sc.BaseDataIn[SC_LAST][BarIndex];
+        Record.Quantity = Order.OrderQuantity;
+        Record.Value1 = Result;
+        p_Log->Write(Record);
+    }
+}
+
+template <typename MAPolicy>
+void Crossover_Trading(SCStudyInterfaceRef sc)
+{
+    SCSubgraphRef MA_Fast = sc.Subgraph[0];
+    SCSubgraphRef MA_Slow = sc.Subgraph[1];
+
+    SCInputRef MA_Fast_Period = sc.Input[0];
+    SCInputRef MA_Slow_Period = sc.Input[1];
+    SCInputRef MA_Fast_Data = sc.Input[2];
+    SCInputRef MA_Slow_Data = sc.Input[3];
+
+    SCInputRef Target_Ticks = sc.Input[4];
+    SCInputRef Stop_Ticks = sc.Input[5];
+    SCInputRef Share_Averages = sc.Input[6];
+    SCInputRef Intrabar_Signals = sc.Input[7];
+    SCInputRef Intrabar_Confirmation = sc.Input[8];
+    SCInputRef Trade_Full_Recalculation = sc.Input[9];
+    SCInputRef Timing_Interval = sc.Input[10];
+    SCInputRef Trace_File = sc.Input[11];
+    SCInputRef Log_File = sc.Input[12];
+    SCInputRef Checkpoint_Folder = sc.Input[13];
+    SCInputRef Confirmation_Timeframes = sc.Input[14];
+
+    // Section 1 - Set the configuration variables and defaults
+    if (sc.SetDefaults)
+    {
+        const char* Label = MAPolicy::Label();
+
+        if (MAPolicy::FixedFastLength > 0)
+            sc.GraphName.Format("%s %d/%d Crossover Strategy", Label, MAPolicy::FixedFastLength, MAPolicy::FixedSlowLength);
+        else
+            sc.GraphName.Format("%s Crossover Strategy", Label);
+
+        sc.AutoLoop = 0;
+        sc.GraphRegion = 0;
+
+        MA_Fast_Period.Name.Format("Faster %s Period", Label);
+        MA_Fast_Period.SetInt(9);
+        MA_Fast_Period.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        MA_Slow_Period.Name.Format("Slower %s Period", Label);
+        MA_Slow_Period.SetInt(9);
+        MA_Slow_Period.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        // A fixed-period variant only runs its own periods.
+        if (MAPolicy::FixedFastLength > 0)
+        {
+            MA_Fast_Period.SetInt(MAPolicy::FixedFastLength);
+            MA_Fast_Period.SetIntLimits(MAPolicy::FixedFastLength, MAPolicy::FixedFastLength);
+            MA_Slow_Period.SetInt(MAPolicy::FixedSlowLength);
+            MA_Slow_Period.SetIntLimits(MAPolicy::FixedSlowLength, MAPolicy::FixedSlowLength);
+        }
+
+        Stop_Ticks.Name = "Stop Value in terms of Ticks";
+        Stop_Ticks.SetInt(80);
+
+        Target_Ticks.Name = "Target Value in terms of Ticks";
+        Target_Ticks.SetInt(80);
+
+        MA_Fast.Name.Format("Faster %s", Label);
+        MA_Fast.DrawStyle = DRAWSTYLE_LINE;
+        MA_Fast.PrimaryColor = RGB(128, 255, 128);
+
+        MA_Slow.Name.Format("Slower %s", Label);
+        MA_Slow.DrawStyle = DRAWSTYLE_LINE;
+        MA_Slow.PrimaryColor = RGB(255, 0, 0);
+
+        MA_Fast_Data.Name.Format("Faster %s Input Data", Label);
+        MA_Fast_Data.SetInputDataIndex(SC_LAST);
+
+        MA_Slow_Data.Name.Format("Slower %s Input Data", Label);
+        MA_Slow_Data.SetInputDataIndex(SC_LAST);
+
+        Share_Averages.Name = "Share Averages With Other Instances On This Chart";
+        Share_Averages.SetYesNo(1);
+
+        Intrabar_Signals.Name = "Enter On Confirmed Intrabar Cross";
+        Intrabar_Signals.SetYesNo(0);
+
+        Intrabar_Confirmation.Name = "Intrabar Cross Confirmation Updates";
+        Intrabar_Confirmation.SetInt(3);
+        Intrabar_Confirmation.SetIntLimits(1, 1000);
+
+        Trade_Full_Recalculation.Name = "Trade On Full Recalculation (Backtest)";
+        Trade_Full_Recalculation.SetYesNo(0);
+
+        Timing_Interval.Name = "Timing Report Interval in Calls (0 = Off)";
+        Timing_Interval.SetInt(0);
+        Timing_Interval.SetIntLimits(0, 100000000);
+
+        Trace_File.Name = "Latency Trace File (empty = off)";
+        Trace_File.SetString("");
+
+        Log_File.Name = "Trade Log File (empty = off)";
+        Log_File.SetString("");
+
+        // Only the studies that keep checkpoints (ResumeAfterBackfill) show it.
+        if (MAPolicy::ResumeAfterBackfill)
+        {
+            Checkpoint_Folder.Name = "Checkpoint Folder (empty = off)";
+            Checkpoint_Folder.SetString("");
+        }
+
+        Confirmation_Timeframes.Name = "Confirmation Timeframes in Minutes (up to 3, empty = off)";
+        Confirmation_Timeframes.SetString("");
+
+        for (int Leg = 0; Leg < TIMEFRAME_MAX_LEGS; Leg++)
+        {
+            SCSubgraphRef Trend = sc.Subgraph[CROSSOVER_TREND_SUBGRAPH + Leg];
+            Trend.Name.Format("Timeframe %d Trend", Leg + 1);
+            Trend.DrawStyle = DRAWSTYLE_HIDDEN;
+        }
+
+        // Any of the following variables can also be set outside and below the sc.SetDefaults code block
+
+        sc.AllowMultipleEntriesInSameDirection = false;
+        sc.MaximumPositionAllowed = 1;
+        sc.SupportReversals = false;
+
+        // This is false by default. Orders will go to the simulation system always.
+        sc.SendOrdersToTradeService = false;
+
+        sc.AllowOppositeEntryWithOpposingPositionOrOrders = false;
+        sc.SupportAttachedOrdersForTrading = false;
+
+        sc.CancelAllOrdersOnEntriesAndReversals = true;
+        sc.AllowEntryWithWorkingOrders = false;
+        sc.CancelAllWorkingOrdersOnExit = true;
+
+        // Only 1 trade for each Order Action type is allowed per bar.
+        sc.AllowOnlyOneTradePerBar = true;
+
+        // This needs to be set to true when a trading study uses trading functions.
+        sc.MaintainTradeStatisticsAndTradesData = true;
+
+        return;
+    }
+
+    // Persistent state for the two averages
+    s_CrossoverState<MAPolicy>* p_State = static_cast<s_CrossoverState<MAPolicy>*>(sc.GetPersistentPointer(0));
+
+    if (sc.LastCallToFunction)
+    {
+        if (p_State != NULL)
+        {
+            if (p_State->p_Log != NULL && p_State->p_Log->Dropped() > 0)
+            {
+                SCString Message;
+                Message.Format("%s Crossover: %llu trade log records were dropped because the writer fell behind.", MAPolicy::Label(), p_State->p_Log->Dropped());
+                sc.AddMessageToLog(Message, 1);
+            }
+
+            std::string Error;
+            if (!p_State->CheckpointPath.empty() && p_State->Checkpoints.Unsaved()
+                && !p_State->Checkpoints.Save(p_State->CheckpointPath.c_str(), Error))
+            {
+                SCString Message;
+                Message.Format("%s Crossover: %s.", MAPolicy::Label(), Error.c_str());
+                sc.AddMessageToLog(Message, 1);
+            }
+
+            delete p_State;
+            sc.SetPersistentPointer(0, NULL);
+        }
+
+        return;
+    }
+
+    if (p_State == NULL)
+    {
+        p_State = new s_CrossoverState<MAPolicy>;
+        sc.SetPersistentPointer(0, p_State);
+    }
+
+    s_CrossoverSettings& Settings = p_State->Settings;
+    s_CrossoverKernels<MAPolicy>& Kernels = p_State->Kernels;
+
+    if (Settings.NeedsRead(sc))
+    {
+        Settings.Read(sc);
+
+        if (MAPolicy::FixedFastLength > 0)
+        {
+            Settings.FastLength = MAPolicy::FixedFastLength;
+            Settings.SlowLength = MAPolicy::FixedSlowLength;
+        }
+
+        p_State->Timing.SetEnabled(Settings.TimingInterval > 0);
+
+        if (Settings.TracePath.empty())
+        {
+            delete p_State->p_Tracer;
+            p_State->p_Tracer = NULL;
+        }
+        else
+        {
+            if (p_State->p_Tracer == NULL)
+                p_State->p_Tracer = new c_LatencyTracer;
+
+            if (!p_State->p_Tracer->Open(Settings.TracePath.c_str()))
+            {
+                SCString Message;
+                Message.Format("%s Crossover: could not open the latency trace file %s.", MAPolicy::Label(), Settings.TracePath.c_str());
+                sc.AddMessageToLog(Message, 1);
+
+                delete p_State->p_Tracer;
+                p_State->p_Tracer = NULL;
+            }
+        }
+
+        if (Settings.LogPath.empty())
+        {
+            delete p_State->p_Log;
+            p_State->p_Log = NULL;
+        }
+        else
+        {
+            if (p_State->p_Log == NULL)
+                p_State->p_Log = new c_TradeLog;
+
+            if (!p_State->p_Log->Open(Settings.LogPath.c_str(), sc.ChartNumber, sc.StudyGraphInstanceID))
+            {
+                SCString Message;
+                Message.Format("%s Crossover: could not open the trade log file %s.", MAPolicy::Label(), Settings.LogPath.c_str());
+                sc.AddMessageToLog(Message, 1);
+
+                delete p_State->p_Log;
+                p_State->p_Log = NULL;
+            }
+        }
+
+        if (!Settings.ConfirmationValid)
+        {
+            SCString Message;
+            Message.Format("%s Crossover: the Confirmation Timeframes input is not a list of up to %d periods in minutes like \"5, 15, 60\". Confirmation is off.", MAPolicy::Label(), TIMEFRAME_MAX_LEGS);
+            sc.AddMessageToLog(Message, 1);
+        }
+
+        // The checkpoints of the last session, when this instance has none yet. The full recalculation below checks them against the bars.
+        const std::string Checkpoint_Path = MAPolicy::ResumeAfterBackfill ? Crossover_CheckpointPath(sc, MAPolicy::Label(), Settings.CheckpointFolder) : std::string();
+        if (Checkpoint_Path != p_State->CheckpointPath)
+        {
+            p_State->CheckpointPath = Checkpoint_Path;
+
+            std::string Error;
+            if (!Checkpoint_Path.empty() && p_State->Checkpoints.Count() == 0
+                && !p_State->Checkpoints.Load(Checkpoint_Path.c_str(), Error) && !Error.empty())
+            {
+                SCString Message;
+                Message.Format("%s Crossover: %s.", MAPolicy::Label(), Error.c_str());
+                sc.AddMessageToLog(Message, 1);
+            }
+        }
+    }
+
+    c_StudyTiming& Timing = p_State->Timing;
+
+    const int Fast_Data_Index = Settings.FastDataIndex;
+    const int Slow_Data_Index = Settings.SlowDataIndex;
+    SCFloatArrayRef Fast_In = sc.BaseDataIn[Fast_Data_Index];
+    SCFloatArrayRef Slow_In = sc.BaseDataIn[Slow_Data_Index];
+    const int Fast_Length = Settings.FastLength;
+    const int Slow_Length = Settings.SlowLength;
+
+    // The scratch storage is sized here, so the calls until the next full recalculation do not allocate.
+    if (sc.IsFullRecalculation)
+    {
+        Kernels.Reserve(p_State->Arena, Settings.FastLength, Settings.SlowLength);
+        p_State->Timeframes.Configure(Settings.ConfirmationMinutes, Settings.ConfirmationCount, Fast_Length, Slow_Length, Fast_Data_Index == Slow_Data_Index, sc.ArraySize);
+    }
+
+    // Dirty-range tracking: the bars before sc.UpdateStartIndex are final and go into the history. A full recalculation finds the first bar that changed since,
+    // and resumes there when that leaves little enough to recompute (First_Changed is 0 when nothing of the history can be kept).
+    c_CrossoverCheckpoints& Checkpoints = p_State->Checkpoints;
+    int First_Changed = 0;
+    int Resume_Index = 0;
+
+    if (MAPolicy::ResumeAfterBackfill && sc.IsFullRecalculation)
+    {
+        s_CheckpointKey Key;
+        Key.FastLength = Fast_Length;
+        Key.SlowLength = Slow_Length;
+        Key.FastDataIndex = Fast_Data_Index;
+        Key.SlowDataIndex = Slow_Data_Index;
+        Checkpoints.Bind(Key);
+
+        // A call without bars (the chart still loading) keeps the history for the one with them.
+        if (sc.ArraySize > 0)
+        {
+            First_Changed = Checkpoints.FirstChangedBar(&Fast_In[0], &Slow_In[0], sc.ArraySize);
+            Resume_Index = c_CrossoverCheckpoints::ResumeIndex(First_Changed, sc.ArraySize);
+            Checkpoints.Truncate(Resume_Index);
+        }
+    }
+    else if (MAPolicy::ResumeAfterBackfill)
+    {
+        Checkpoints.Truncate(sc.UpdateStartIndex);
+
+        if (sc.UpdateStartIndex > 0)
+            Checkpoints.Record(&Fast_In[0], &Slow_In[0], &MA_Fast[0], &MA_Slow[0], sc.UpdateStartIndex);
+    }
+
+    c_AllocationCheck Allocation_Check;
+
+    // Section 2 - Compute the averages for every bar that needs updating in one pass
+    unsigned long long Start = Timing.Begin();
+
+    if (sc.UpdateStartIndex == 0)
+    {
+        bool Loaded = false;
+        s_MASeriesStamp Fast_Stamp;
+        s_MASeriesStamp Slow_Stamp;
+
+        if (Settings.ShareAverages)
+        {
+            p_State->FastCache.Bind(MA_CacheKey(sc, MAPolicy::Label(), Fast_Data_Index, Fast_Length));
+            p_State->SlowCache.Bind(MA_CacheKey(sc, MAPolicy::Label(), Slow_Data_Index, Slow_Length));
+
+            const float* Volume = MAPolicy::TimeframeAverage::UsesVolume ? &sc.BaseDataIn[SC_VOLUME][0] : NULL;
+            Fast_Stamp = MA_SeriesStamp(sc, Fast_In, Volume);
+            Slow_Stamp = MA_SeriesStamp(sc, Slow_In, Volume);
+
+            Loaded = p_State->FastCache.Load(Fast_Stamp, &MA_Fast[0])
+                && p_State->SlowCache.Load(Slow_Stamp, &MA_Slow[0]);
+        }
+        else
+        {
+            p_State->FastCache.Release();
+            p_State->SlowCache.Release();
+        }
+
+        if (Loaded)
+        {
+            Kernels.Reset();
+        }
+        else
+        {
+            if (Resume_Index > 0)
+            {
+                // The kernels were reset by Reserve and resync at Resume_Index from the unchanged bars before it.
+                Checkpoints.Restore(&MA_Fast[0], &MA_Slow[0], Resume_Index);
+
+                for (int BarIndex = Resume_Index; BarIndex < sc.ArraySize; BarIndex++)
+                    Kernels.Compute(sc, Fast_In, MA_Fast, Slow_In, MA_Slow, BarIndex, Fast_Length, Slow_Length);
+            }
+            else
+            {
+                Kernels.ComputeBatch(sc, Fast_In, MA_Fast, Slow_In, MA_Slow, sc.ArraySize, Fast_Length, Slow_Length);
+            }
+
+            p_State->FastCache.Store(Fast_Stamp, &MA_Fast[0]);
+            p_State->SlowCache.Store(Slow_Stamp, &MA_Slow[0]);
+        }
+    }
+    else
+    {
+        for (int BarIndex = sc.UpdateStartIndex; BarIndex < sc.ArraySize; BarIndex++)
+            Kernels.Compute(sc, Fast_In, MA_Fast, Slow_In, MA_Slow, BarIndex, Fast_Length, Slow_Length);
+    }
+
+    // The bars before the last one are closed once a full recalculation has computed them, so they go into the history now rather than on the next tick.
+    if (MAPolicy::ResumeAfterBackfill && sc.IsFullRecalculation && sc.ArraySize > 1)
+        Checkpoints.Record(&Fast_In[0], &Slow_In[0], &MA_Fast[0], &MA_Slow[0], sc.ArraySize - 1);
+
+    // The confirmation timeframes from the same bars. A full recalculation computes them over the whole history, in parallel.
+    c_TimeframeConfirmation<typename MAPolicy::TimeframeAverage>& Timeframes = p_State->Timeframes;
+    const int Timeframe_Legs = Timeframes.LegCount();
+
+    if (Timeframe_Legs > 0 && sc.ArraySize > 0)
+    {
+        const int Seconds_Start = Timeframes.StartBar(sc.UpdateStartIndex);
+        long long* Seconds = Timeframes.Seconds(Seconds_Start, sc.ArraySize);
+        for (int BarIndex = Seconds_Start; BarIndex < sc.ArraySize; BarIndex++)
+            Seconds[BarIndex - Seconds_Start] = static_cast<long long>(std::floor(sc.BaseDateTimeIn[BarIndex].GetAsDouble() * 86400.0 + 0.5));
+
+        float* Trend[TIMEFRAME_MAX_LEGS];
+        for (int Leg = 0; Leg < Timeframe_Legs; Leg++)
+            Trend[Leg] = &sc.Subgraph[CROSSOVER_TREND_SUBGRAPH + Leg][0];
+
+        const float* Volume = MAPolicy::TimeframeAverage::UsesVolume ? &sc.BaseDataIn[SC_VOLUME][0] : NULL;
+        Timeframes.Update(&Fast_In[0], &Slow_In[0], Volume, Crossover_TimeframeRule(Fast_Data_Index), Crossover_TimeframeRule(Slow_Data_Index), sc.UpdateStartIndex, sc.ArraySize, Trend);
+    }
+
+    Timing.End(TIMING_MA_COMPUTE, Start);
+
+    // Section 3 - Trade-side work, once per newly closed bar, and on a confirmed cross of the live bar when intrabar entries are on
+    // The state is kept when every bar it evaluated is unchanged, so a backfill after them does not evaluate or log them again.
+    int& LastProcessedBarIndex = sc.GetPersistentInt(0);
+    if (sc.IsFullRecalculation && (First_Changed == 0 || LastProcessedBarIndex >= First_Changed))
+    {
+        LastProcessedBarIndex = -1;
+        p_State->Intrabar.Clear();
+        p_State->ClosedBarCross = NO_CROSS;
+    }
+
+    int ClosedBarIndex = sc.ArraySize - 1;
+    const bool LastBarHasClosed = sc.GetBarHasClosedStatus(ClosedBarIndex) == BHCS_BAR_HAS_CLOSED;
+    if (!LastBarHasClosed)
+        ClosedBarIndex--;
+
+    c_TradeLog* p_Log = p_State->p_Log;
+    const int Log_Flags = sc.IsFullRecalculation ? TRADE_LOG_FULL_RECALCULATION : 0;
+
+    // The cross of each closed bar is evaluated once. Orders and the position lookup only happen when there is a cross to trade, or once per closed bar for the trade log.
+    // Every bar that closed since the last evaluated one is evaluated in order, so a call that closes several bars (a slow update, a reconnect) misses none of their crosses.
+    // A full recalculation is the chart loading its history: it only evaluates the newest closed bar, unless it is asked to trade, when it evaluates every bar as a backtest.
+    int FirstBarIndex = LastProcessedBarIndex + 1;
+    if (sc.IsFullRecalculation && !Settings.TradeFullRecalculation && FirstBarIndex < ClosedBarIndex)
+        FirstBarIndex = ClosedBarIndex;
+    if (FirstBarIndex < 1)
+        FirstBarIndex = 1;
+
+    for (int BarIndex = FirstBarIndex; BarIndex <= ClosedBarIndex; BarIndex++)
+    {
+        LastProcessedBarIndex = BarIndex;
+
+        Start = Timing.Begin();
+        p_State->ClosedBarCross = sc.CrossOver(MA_Fast, MA_Slow, BarIndex);
+        Timing.End(TIMING_CROSS_DETECTION, Start);
+
+        if (p_Log != NULL)
+        {
+            Crossover_LogPosition(sc, *p_Log, BarIndex, Log_Flags);
+            Crossover_LogSignal(sc, *p_Log, p_State->ClosedBarCross, BarIndex, Log_Flags);
+        }
+
+        // A bar that already traded intrabar is not entered again when it closes.
+        if (p_State->ClosedBarCross != NO_CROSS
+            && (!sc.IsFullRecalculation || Settings.TradeFullRecalculation)
+            && BarIndex != p_State->Intrabar.TradedBarIndex
+            && Crossover_TimeframesConfirm(sc, Timeframe_Legs, p_State->ClosedBarCross, BarIndex))
+        {
+            Crossover_Enter(sc, p_State->ClosedBarCross, BarIndex, Settings.Order, Timing, p_State->p_Tracer, p_Log, Log_Flags);
+        }
+    }
+
+    if (Settings.IntrabarSignals && !LastBarHasClosed && !sc.IsFullRecalculation)
+    {
+        const int LiveBarIndex = sc.ArraySize - 1;
+
+        Start = Timing.Begin();
+        // An update the higher timeframes do not confirm counts as no cross.
+        int Cross = sc.CrossOver(MA_Fast, MA_Slow, LiveBarIndex);
+        if (Cross != NO_CROSS && !Crossover_TimeframesConfirm(sc, Timeframe_Legs, Cross, LiveBarIndex))
+            Cross = NO_CROSS;
+
+        Cross = p_State->Intrabar.Update(Cross, LiveBarIndex, Settings.IntrabarConfirmation);
+        Timing.End(TIMING_CROSS_DETECTION, Start);
+
+        if (Cross != NO_CROSS)
+        {
+            if (p_Log != NULL)
+                Crossover_LogSignal(sc, *p_Log, Cross, LiveBarIndex, TRADE_LOG_INTRABAR);
+
+            Crossover_Enter(sc, Cross, LiveBarIndex, Settings.Order, Timing, p_State->p_Tracer, p_Log, TRADE_LOG_INTRABAR);
+        }
+    }
+
+    // Section 4 - Timing report, one message log line per phase
+    if (Timing.CountCall(Settings.TimingInterval))
+    {
+        char Label[64];
+        std::snprintf(Label, sizeof(Label), "%s Crossover", MAPolicy::Label());
+
+        for (int Phase = 0; Phase < TIMING_PHASE_COUNT; Phase++)
+        {
+            char Text[256];
+            Timing.Report(Label, Phase, Text, sizeof(Text));
+            sc.AddMessageToLog(Text, 0);
+        }
+
+        Timing.Clear();
+    }
+
+    // Section 5 - Debug builds: a heap allocation outside a full recalculation is reported once per instance
+    if (!sc.IsFullRecalculation && Allocation_Check.Allocations() > 0 && !p_State->AllocationReported)
+    {
+        p_State->AllocationReported = true;
+
+        SCString Message;
+        Message.Format("%s Crossover: %llu heap allocations in a call after the full recalculation.", MAPolicy::Label(), Allocation_Check.Allocations());
+        sc.AddMessageToLog(Message, 1);
+    }
+}
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef CROSSOVER_INDEX_H
+#define CROSSOVER_INDEX_H
+
+#include <vector>
+
+#include "MA_Batch_Kernels.h"
+
+/*
+Cross detection over whole arrays, for full recalculations and backtests.
+
+Crossover_BuildIndex finds every bar where Fast crosses Slow and writes them to a compact index list, so a backtest can go from one signal to the next without visiting the bars in between.
+The rule is that of sc.CrossOver, bar for bar: the sign of Fast - Slow (as a float difference) at a bar against the sign at the last bar before it where the two were not equal. Bars where they are equal never cross, and bar 0 has nothing before it.
+It runs in two steps over blocks of CROSS_BLOCK_BARS bars:
+Crossover_SignMasks - the signs as two bitmasks, bit i of word w for bar 64 * w + i: Positive where Fast - Slow > 0, Negative where it is < 0. The AVX2 version compares 8 bars per instruction and packs them with movemask.
+Crossover_MaskCrosses - 64 bars per step on the masks. The sign of each equal bar is filled in from the bar before it with six shift-and-or steps, so the previous sign of every bar is known without a scan back, and a cross is a Positive bit after a Negative one or the reverse.
+The sign of the last unequal bar is carried from one word to the next, so the result does not depend on where the blocks split.
+MA_Batch_Kernels.h provides the AVX2 detection; the _Scalar version is the fallback. Nothing here depends on sierrachart.h.
+*/
+
+// A cross at BarIndex. Direction is +1 when Fast crosses above Slow (CROSS_FROM_BOTTOM) and -1 when it crosses below (CROSS_FROM_TOP).
+struct s_CrossoverEvent
+{
+    int BarIndex;
+    int Direction;
+};
+
+const int CROSS_BLOCK_WORDS = 64;
+const int CROSS_BLOCK_BARS = CROSS_BLOCK_WORDS * 64;
+
+inline int Crossover_LowestBit(unsigned long long Word)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long Bit;
+    _BitScanForward64(&Bit, Word);
+    return static_cast<int>(Bit);
+#else
+    return __builtin_ctzll(Word);
+#endif
+}
+
+inline void Crossover_SignMasks_Scalar(const float* Fast, const float* Slow, int Count, unsigned long long* Positive, unsigned long long* Negative)
+{
+    const int Words = (Count + 63) / 64;
+
+    for (int Word = 0; Word < Words; Word++)
+    {
+        unsigned long long Above = 0;
+        unsigned long long Below = 0;
+        const int First = Word * 64;
+        const int Bars = Count - First < 64 ? Count - First : 64;
+
+        for (int Bit = 0; Bit < Bars; Bit++)
+        {
+            const float Difference = Fast[First + Bit] - Slow[First + Bit];
+            Above |= static_cast<unsigned long long>(Difference > 0.0f) << Bit;
+            Below |= static_cast<unsigned long long>(Difference < 0.0f) << Bit;
+        }
+
+        Positive[Word] = Above;
+        Negative[Word] = Below;
+    }
+}
+
+#if defined(MA_BATCH_X86)
+
+MA_TARGET_AVX2 inline void Crossover_SignMasks_AVX2(const float* Fast, const float* Slow, int Count, unsigned long long* Positive, unsigned long long* Negative)
+{
+    const __m256 Zero = _mm256_setzero_ps();
+    const int Full_Words = Count / 64;
+
+    for (int Word = 0; Word < Full_Words; Word++)
+    {
+        unsigned long long Above = 0;
+        unsigned long long Below = 0;
+        const float* p_Fast = Fast + Word * 64;
+        const float* p_Slow = Slow + Word * 64;
+
+        for (int Lane = 0; Lane < 8; Lane++)
+        {
+            const __m256 Difference = _mm256_sub_ps(_mm256_loadu_ps(p_Fast + Lane * 8), _mm256_loadu_ps(p_Slow + Lane * 8));
+            const unsigned long long Above_Bits = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(Difference, Zero, _CMP_GT_OQ)));
+            const unsigned long long Below_Bits = static_cast<unsigned int>(_mm256_movemask_ps(_mm256_cmp_ps(Difference, Zero, _CMP_LT_OQ)));
+            Above |= Above_Bits << (Lane * 8);
+            Below |= Below_Bits << (Lane * 8);
+        }
+
+        Positive[Word] = Above;
+        Negative[Word] = Below;
+    }
+
+    if (Count > Full_Words * 64)
+        Crossover_SignMasks_Scalar(Fast + Full_Words * 64, Slow + Full_Words * 64, Count - Full_Words * 64, Positive + Full_Words, Negative + Full_Words);
+}
+
+#endif
+
+inline void Crossover_SignMasks(const float* Fast, const float* Slow, int Count, unsigned long long* Positive, unsigned long long* Negative)
+{
+#if defined(MA_BATCH_X86)
+    if (MA_HasAVX2())
+    {
+        Crossover_SignMasks_AVX2(Fast, Slow, Count, Positive, Negative);
+        return;
+    }
+#endif
+    Crossover_SignMasks_Scalar(Fast, Slow, Count, Positive, Negative);
+}
+
+// Appends the crosses of the masks of Words words, the first of which is bar FirstBar. PreviousSign is the sign of the last unequal bar before them (0 for none) and is updated past them.
+inline void Crossover_MaskCrosses(const unsigned long long* Positive, const unsigned long long* Negative, int Words, int FirstBar, int& PreviousSign, std::vector<s_CrossoverEvent>& Crosses)
+{
+    for (int Word = 0; Word < Words; Word++)
+    {
+        const unsigned long long Above = Positive[Word];
+        const unsigned long long Below = Negative[Word];
+        unsigned long long Known = Above | Below;
+
+        // Each equal bar takes the sign of the bar before it, doubling the reach on every step. After 6 steps every bar after the first unequal one of the word has its sign.
+        unsigned long long Filled_Above = Above;
+        unsigned long long Filled_Below = Below;
+        for (int Shift = 1; Shift < 64; Shift <<= 1)
+        {
+            Filled_Above |= (Filled_Above << Shift) & ~Known;
+            Filled_Below |= (Filled_Below << Shift) & ~Known;
+            Known |= Known << Shift;
+        }
+
+        // The bars before the first unequal one carry the sign from the previous word.
+        const unsigned long long Unequal = Above | Below;
+        const unsigned long long Leading = Unequal != 0 ? (Unequal & (~Unequal + 1)) - 1 : ~0ULL;
+        if (PreviousSign > 0)
+            Filled_Above |= Leading;
+        else if (PreviousSign < 0)
+            Filled_Below |= Leading;
+
+        // The previous sign of bar i is the filled sign of bar i - 1.
+        const unsigned long long Previous_Above = (Filled_Above << 1) | (PreviousSign > 0 ? 1ULL : 0ULL);
+        const unsigned long long Previous_Below = (Filled_Below << 1) | (PreviousSign < 0 ? 1ULL : 0ULL);
+
+        const unsigned long long Up = Above & Previous_Below;
+        unsigned long long Events = Up | (Below & Previous_Above);
+
+        while (Events != 0)
+        {
+            const int Bit = Crossover_LowestBit(Events);
+
+            s_CrossoverEvent Event;
+            Event.BarIndex = FirstBar + Word * 64 + Bit;
+            Event.Direction = (Up >> Bit) & 1 ? 1 : -1;
+            Crosses.push_back(Event);
+
+            Events &= Events - 1;
+        }
+
+        if (Filled_Above >> 63)
+            PreviousSign = 1;
+        else if (Filled_Below >> 63)
+            PreviousSign = -1;
+    }
+}
+
+// Replaces Crosses with every cross of Fast over Slow in bars 0 to Count - 1, in bar order.
+inline void Crossover_BuildIndex(const float* Fast, const float* Slow, int Count, std::vector<s_CrossoverEvent>& Crosses)
+{
+    Crosses.clear();
+
+    unsigned long long Positive[CROSS_BLOCK_WORDS];
+    unsigned long long Negative[CROSS_BLOCK_WORDS];
+    int PreviousSign = 0;
+
+    for (int First = 0; First < Count; First += CROSS_BLOCK_BARS)
+    {
+        const int Bars = Count - First < CROSS_BLOCK_BARS ? Count - First : CROSS_BLOCK_BARS;
+
+        Crossover_SignMasks(Fast + First, Slow + First, Bars, Positive, Negative);
+        Crossover_MaskCrosses(Positive, Negative, (Bars + 63) / 64, First, PreviousSign, Crosses);
+    }
+}
+
+#endif
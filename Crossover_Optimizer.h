@@ -0,0 +1,423 @@
+#ifndef CROSSOVER_OPTIMIZER_H
+#define CROSSOVER_OPTIMIZER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Crossover_Sweep.h"
+
+/*
+Multi-threaded optimizer over the crossover sweep.
+
+The pair list is cut into blocks of consecutive pairs. Consecutive grid pairs share their fast period, so a block keeps most of the single-pass sharing of c_CrossoverSweep.
+Each worker thread owns a queue of blocks. It takes blocks from the back of its own queue and, when that is empty, steals from the front of the other workers' queues, so a worker that drew cheap blocks helps the others instead of idling.
+A block runs its own c_CrossoverSweep (its own averages, positions and statistics) over a read-only view of the bars, and writes its results and signals to its own slice of the outputs, so the workers share nothing but the queues.
+After the run the results are ranked by net profit, max drawdown or Sharpe (s_TradeStats::Sharpe), and the ranked table can be written to a CSV file with the rank of each pair on all three.
+A pair without trades has no drawdown to compare, so the drawdown ranking puts those pairs last rather than first.
+Run blocks the calling thread, which is one of the workers. No blocks are added while running, so a worker stops when its own queue and all the others are empty.
+Start runs the same on a background thread over its own copy of the bars and returns at once, so a large sweep does not hold the chart thread; the study polls Finished on its later calls.
+A block runs its bars OPTIMIZER_CANCEL_BARS at a time and checks for Cancel between them, so a new recalculation or closing the chart does not wait for the whole sweep.
+*/
+
+const int OPTIMIZER_CANCEL_BARS = 65536;
+
+enum e_OptimizerRank
+{
+    OPTIMIZER_RANK_NET_PROFIT = 0,
+    OPTIMIZER_RANK_DRAWDOWN = 1,
+    OPTIMIZER_RANK_SHARPE = 2
+};
+
+// Read-only view of the bar data shared by all the workers.
+struct s_OptimizerBars
+{
+    const float* In;
+    const float* High;
+    const float* Low;
+    const float* Close;
+    int Count;
+
+    s_OptimizerBars()
+        : In(NULL)
+        , High(NULL)
+        , Low(NULL)
+        , Close(NULL)
+        , Count(0)
+    {
+    }
+};
+
+// A block of pairs [Begin, End).
+struct s_OptimizerBlock
+{
+    int Begin;
+    int End;
+};
+
+class c_WorkStealingQueue
+{
+public:
+    void Push(const s_OptimizerBlock& Block)
+    {
+        std::lock_guard<std::mutex> Guard(m_Lock);
+        m_Blocks.push_back(Block);
+    }
+
+    // Used by the owner.
+    bool PopBack(s_OptimizerBlock& Block)
+    {
+        std::lock_guard<std::mutex> Guard(m_Lock);
+        if (m_Blocks.empty())
+            return false;
+
+        Block = m_Blocks.back();
+        m_Blocks.pop_back();
+        return true;
+    }
+
+    // Used by the other workers.
+    bool StealFront(s_OptimizerBlock& Block)
+    {
+        std::lock_guard<std::mutex> Guard(m_Lock);
+        if (m_Blocks.empty())
+            return false;
+
+        Block = m_Blocks.front();
+        m_Blocks.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex m_Lock;
+    std::deque<s_OptimizerBlock> m_Blocks;
+};
+
+class c_CrossoverOptimizer
+{
+public:
+    c_CrossoverOptimizer()
+        : m_Type(SWEEP_MA_SMA)
+        , m_TargetOffset(0.0)
+        , m_StopOffset(0.0)
+        , m_Signals(NULL)
+        , m_SignalCount(0)
+        , m_Queues(NULL)
+        , m_ThreadCount(0)
+        , m_Cancel(false)
+        , m_Done(false)
+    {
+    }
+
+    ~c_CrossoverOptimizer()
+    {
+        Cancel();
+    }
+
+    // Runs every pair over the bars with ThreadCount workers (0 for one per hardware thread).
+    // Signals may be NULL; otherwise Signals[p] for the first SignalCount pairs receives the pair's cross signals, as in c_CrossoverSweep::Run.
+    void Run(int Type, const std::vector<s_SweepPair>& Pairs, const s_OptimizerBars& Bars, double TargetOffset, double StopOffset, int ThreadCount, float* const* Signals, int SignalCount)
+    {
+        m_Cancel.store(false);
+        Execute(Type, Pairs, Bars, TargetOffset, StopOffset, ThreadCount, Signals, SignalCount);
+    }
+
+    // Starts Run on a background thread over a copy of the bars and returns. A run still going is cancelled first.
+    // The signals of the first SignalCount pairs are kept for Signals(p) to read once Finished returns true.
+    void Start(int Type, const std::vector<s_SweepPair>& Pairs, const s_OptimizerBars& Bars, double TargetOffset, double StopOffset, int ThreadCount, int SignalCount)
+    {
+        Cancel();
+
+        const size_t Count = static_cast<size_t>(Bars.Count);
+        m_BarCopy.assign(4 * Count, 0.0f);
+        std::copy(Bars.In, Bars.In + Count, m_BarCopy.begin());
+        std::copy(Bars.High, Bars.High + Count, m_BarCopy.begin() + Count);
+        std::copy(Bars.Low, Bars.Low + Count, m_BarCopy.begin() + 2 * Count);
+        std::copy(Bars.Close, Bars.Close + Count, m_BarCopy.begin() + 3 * Count);
+
+        s_OptimizerBars Copy;
+        Copy.In = &m_BarCopy[0];
+        Copy.High = Copy.In + Count;
+        Copy.Low = Copy.High + Count;
+        Copy.Close = Copy.Low + Count;
+        Copy.Count = Bars.Count;
+
+        SignalCount = std::max(0, std::min(SignalCount, static_cast<int>(Pairs.size())));
+        m_SignalStore.assign(SignalCount * Count, 0.0f);
+        m_SignalRows.resize(SignalCount);
+        for (int PairIndex = 0; PairIndex < SignalCount; PairIndex++)
+            m_SignalRows[PairIndex] = &m_SignalStore[0] + PairIndex * Count;
+
+        m_Cancel.store(false);
+        m_Done.store(false);
+        m_Background = std::thread(&c_CrossoverOptimizer::BackgroundLoop, this, Type, Pairs, Copy, TargetOffset, StopOffset, ThreadCount);
+    }
+
+    // True once a Start run has completed; the results, ranking and signals are then ready. Does not wait.
+    bool Finished()
+    {
+        if (!m_Background.joinable() || !m_Done.load(std::memory_order_acquire))
+            return false;
+
+        m_Background.join();
+        return !m_Cancel.load();
+    }
+
+    bool IsRunning() const
+    {
+        return m_Background.joinable();
+    }
+
+    // Stops a Start run at the workers' next check and waits for them.
+    void Cancel()
+    {
+        if (!m_Background.joinable())
+            return;
+
+        m_Cancel.store(true);
+        m_Background.join();
+    }
+
+    // The cross signals of pair PairIndex from the last Start run, one per bar.
+    const float* Signals(int PairIndex) const
+    {
+        return PairIndex >= 0 && PairIndex < static_cast<int>(m_SignalRows.size()) ? m_SignalRows[PairIndex] : NULL;
+    }
+
+    int SignalCount() const
+    {
+        return static_cast<int>(m_SignalRows.size());
+    }
+
+    int BarCount() const
+    {
+        return m_Bars.Count;
+    }
+
+    int Type() const
+    {
+        return m_Type;
+    }
+
+    // Results in the order of the input pairs.
+    const std::vector<s_SweepPair>& Results() const
+    {
+        return m_Results;
+    }
+
+    int ThreadCount() const
+    {
+        return m_ThreadCount;
+    }
+
+    // Indexes into Results(), best first.
+    void Rank(int By, std::vector<int>& Order) const
+    {
+        Order.resize(m_Results.size());
+        for (size_t PairIndex = 0; PairIndex < Order.size(); PairIndex++)
+            Order[PairIndex] = static_cast<int>(PairIndex);
+
+        std::stable_sort(Order.begin(), Order.end(), c_RankLess(m_Results, By));
+    }
+
+    // Writes the results ranked by By, with the rank of each pair by net profit, drawdown and Sharpe.
+    bool WriteRanking(const char* Path, int By) const
+    {
+        std::vector<int> Orders[3];
+        std::vector<int> Ranks[3];
+
+        for (int Criterion = 0; Criterion < 3; Criterion++)
+        {
+            Rank(Criterion, Orders[Criterion]);
+            Ranks[Criterion].resize(m_Results.size());
+
+            for (size_t Position = 0; Position < Orders[Criterion].size(); Position++)
+                Ranks[Criterion][Orders[Criterion][Position]] = static_cast<int>(Position) + 1;
+        }
+
+        FILE* File = std::fopen(Path, "w");
+        if (File == NULL)
+            return false;
+
+        std::fprintf(File, "Rank,Type,Fast,Slow,Trades,Wins,NetProfit,MaxDrawdown,Sharpe,ProfitFactor,NetProfitRank,DrawdownRank,SharpeRank\n");
+
+        const std::vector<int>& Order = Orders[By >= 0 && By < 3 ? By : OPTIMIZER_RANK_NET_PROFIT];
+        for (size_t Position = 0; Position < Order.size(); Position++)
+        {
+            const int PairIndex = Order[Position];
+            const s_SweepPair& Pair = m_Results[PairIndex];
+            const s_TradeStats& Stats = Pair.Stats;
+
+            std::fprintf(File, "%d,%s,%d,%d,%d,%d,%.6f,%.6f,%.4f,%.4f,%d,%d,%d\n",
+                static_cast<int>(Position) + 1, Sweep_MATypeLabel(m_Type), Pair.FastPeriod, Pair.SlowPeriod, Stats.Trades, Stats.Wins,
+                Stats.NetProfit, Stats.MaxDrawdown, Stats.Sharpe(), Stats.ProfitFactor(),
+                Ranks[OPTIMIZER_RANK_NET_PROFIT][PairIndex], Ranks[OPTIMIZER_RANK_DRAWDOWN][PairIndex], Ranks[OPTIMIZER_RANK_SHARPE][PairIndex]);
+        }
+
+        return std::fclose(File) == 0;
+    }
+
+private:
+    c_CrossoverOptimizer(const c_CrossoverOptimizer&);
+    c_CrossoverOptimizer& operator=(const c_CrossoverOptimizer&);
+
+    class c_RankLess
+    {
+    public:
+        c_RankLess(const std::vector<s_SweepPair>& Pairs, int By)
+            : m_Pairs(Pairs)
+            , m_By(By)
+        {
+        }
+
+        bool operator()(int Left, int Right) const
+        {
+            const s_TradeStats& A = m_Pairs[Left].Stats;
+            const s_TradeStats& B = m_Pairs[Right].Stats;
+
+            switch (m_By)
+            {
+                case OPTIMIZER_RANK_DRAWDOWN:
+                    if ((A.Trades == 0) != (B.Trades == 0))
+                        return B.Trades == 0;
+                    if (A.MaxDrawdown != B.MaxDrawdown)
+                        return A.MaxDrawdown < B.MaxDrawdown;
+                    break;
+
+                case OPTIMIZER_RANK_SHARPE:
+                    if (A.Sharpe() != B.Sharpe())
+                        return A.Sharpe() > B.Sharpe();
+                    break;
+            }
+
+            return A.NetProfit > B.NetProfit;
+        }
+
+    private:
+        const std::vector<s_SweepPair>& m_Pairs;
+        int m_By;
+    };
+
+    void BackgroundLoop(int Type, std::vector<s_SweepPair> Pairs, s_OptimizerBars Bars, double TargetOffset, double StopOffset, int ThreadCount)
+    {
+        Execute(Type, Pairs, Bars, TargetOffset, StopOffset, ThreadCount, m_SignalRows.empty() ? NULL : &m_SignalRows[0], static_cast<int>(m_SignalRows.size()));
+        m_Done.store(true, std::memory_order_release);
+    }
+
+    void Execute(int Type, const std::vector<s_SweepPair>& Pairs, const s_OptimizerBars& Bars, double TargetOffset, double StopOffset, int ThreadCount, float* const* Signals, int SignalCount)
+    {
+        m_Type = Type;
+        m_Results = Pairs;
+        m_Bars = Bars;
+        m_TargetOffset = TargetOffset;
+        m_StopOffset = StopOffset;
+        m_Signals = Signals;
+        m_SignalCount = Signals != NULL ? SignalCount : 0;
+
+        const int PairCount = static_cast<int>(m_Results.size());
+        if (PairCount == 0)
+            return;
+
+        if (ThreadCount <= 0)
+            ThreadCount = static_cast<int>(std::thread::hardware_concurrency());
+
+        m_ThreadCount = std::max(1, std::min(ThreadCount, PairCount));
+
+        // About 8 blocks per worker, so stealing can even out the load near the end.
+        const int BlockSize = std::max(1, PairCount / (m_ThreadCount * 8));
+
+        m_Queues = new c_WorkStealingQueue[m_ThreadCount];
+
+        int Worker = 0;
+        for (int Begin = 0; Begin < PairCount; Begin += BlockSize)
+        {
+            s_OptimizerBlock Block;
+            Block.Begin = Begin;
+            Block.End = std::min(Begin + BlockSize, PairCount);
+
+            m_Queues[Worker].Push(Block);
+            Worker = (Worker + 1) % m_ThreadCount;
+        }
+
+        std::vector<std::thread> Threads;
+        for (int ThreadIndex = 1; ThreadIndex < m_ThreadCount; ThreadIndex++)
+            Threads.push_back(std::thread(&c_CrossoverOptimizer::WorkerLoop, this, ThreadIndex));
+
+        WorkerLoop(0);
+
+        for (size_t ThreadIndex = 0; ThreadIndex < Threads.size(); ThreadIndex++)
+            Threads[ThreadIndex].join();
+
+        delete[] m_Queues;
+        m_Queues = NULL;
+    }
+
+    bool NextBlock(int Worker, s_OptimizerBlock& Block)
+    {
+        if (m_Queues[Worker].PopBack(Block))
+            return true;
+
+        for (int Offset = 1; Offset < m_ThreadCount; Offset++)
+        {
+            if (m_Queues[(Worker + Offset) % m_ThreadCount].StealFront(Block))
+                return true;
+        }
+
+        return false;
+    }
+
+    void WorkerLoop(int Worker)
+    {
+        s_OptimizerBlock Block;
+        while (NextBlock(Worker, Block))
+            RunBlock(Block);
+    }
+
+    void RunBlock(const s_OptimizerBlock& Block)
+    {
+        std::vector<s_SweepPair> Pairs(m_Results.begin() + Block.Begin, m_Results.begin() + Block.End);
+
+        float* const* Signals = NULL;
+        int SignalCount = 0;
+        if (Block.Begin < m_SignalCount)
+        {
+            Signals = m_Signals + Block.Begin;
+            SignalCount = std::min(Block.End, m_SignalCount) - Block.Begin;
+        }
+
+        c_CrossoverSweep Sweep;
+        Sweep.Init(m_Type, Pairs, m_TargetOffset, m_StopOffset);
+
+        for (int Begin = 0; Begin < m_Bars.Count; Begin += OPTIMIZER_CANCEL_BARS)
+        {
+            if (m_Cancel.load(std::memory_order_relaxed))
+                return;
+
+            Sweep.RunBars(m_Bars.In, m_Bars.High, m_Bars.Low, m_Bars.Close, Begin, std::min(Begin + OPTIMIZER_CANCEL_BARS, m_Bars.Count), Signals, SignalCount);
+        }
+
+        std::copy(Sweep.Pairs().begin(), Sweep.Pairs().end(), m_Results.begin() + Block.Begin);
+    }
+
+    int m_Type;
+    std::vector<s_SweepPair> m_Results;
+    s_OptimizerBars m_Bars;
+    double m_TargetOffset;
+    double m_StopOffset;
+    float* const* m_Signals;
+    int m_SignalCount;
+    c_WorkStealingQueue* m_Queues;
+    int m_ThreadCount;
+    std::atomic<bool> m_Cancel;
+    std::atomic<bool> m_Done;
+    std::thread m_Background;
+    std::vector<float> m_BarCopy;
+    std::vector<float> m_SignalStore;
+    std::vector<float*> m_SignalRows;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef CROSSOVER_PORTFOLIO_H
+#define CROSSOVER_PORTFOLIO_H
+
+#include <cstdlib>
+#include <vector>
+
+/*
+EMA crossovers of many symbols at once, for the portfolio study.
+
+The state of every symbol is kept in parallel arrays (one double per symbol for each average, one int for the sign of Fast - Slow), so one step updates all the symbols in a single loop the compiler vectorizes.
+Symbols can have different numbers of new bars. A step takes one value per symbol and an Active mask (1.0 or 0.0); an inactive symbol keeps its state unchanged, so the loop has no branch.
+The recurrence is the one of s_EMAKernel and MA_Batch_EMA: the first value seeds the average, then Average += Alpha * (Value - Average), with Alpha = 2 / (Length + 1).
+A cross is a change of the sign of Fast - Slow, ignoring values where the two are equal, as sc.CrossOver does.
+The portfolio code does not depend on sierrachart.h.
+*/
+
+class c_PortfolioCrossovers
+{
+public:
+    c_PortfolioCrossovers()
+        : m_FastAlpha(1.0)
+        , m_SlowAlpha(1.0)
+    {
+    }
+
+    void Init(int SymbolCount, int FastLength, int SlowLength)
+    {
+        m_FastAlpha = 2.0 / ((FastLength < 1 ? 1 : FastLength) + 1);
+        m_SlowAlpha = 2.0 / ((SlowLength < 1 ? 1 : SlowLength) + 1);
+
+        m_Fast.assign(SymbolCount, 0.0);
+        m_Slow.assign(SymbolCount, 0.0);
+        m_Seeded.assign(SymbolCount, 0.0);
+        m_Sign.assign(SymbolCount, 0);
+        m_Bars.assign(SymbolCount, 0);
+    }
+
+    int SymbolCount() const
+    {
+        return static_cast<int>(m_Fast.size());
+    }
+
+    // Bars of the symbol taken in so far. The next step for the symbol is bar Bars(Symbol).
+    int Bars(int Symbol) const
+    {
+        return m_Bars[Symbol];
+    }
+
+    // Starts the symbol over from bar 0, for a reloaded chart.
+    void ResetSymbol(int Symbol)
+    {
+        m_Fast[Symbol] = 0.0;
+        m_Slow[Symbol] = 0.0;
+        m_Seeded[Symbol] = 0.0;
+        m_Sign[Symbol] = 0;
+        m_Bars[Symbol] = 0;
+    }
+
+    // One bar for every symbol with Active[Symbol] = 1.0. Cross[Symbol] is set to +1 where the fast average crossed above the slow one, -1 where it crossed below, 0 otherwise.
+    void Step(const double* Value, const double* Active, int* Cross)
+    {
+        const int Count = SymbolCount();
+
+        double* Fast = Count > 0 ? &m_Fast[0] : NULL;
+        double* Slow = Count > 0 ? &m_Slow[0] : NULL;
+        double* Seeded = Count > 0 ? &m_Seeded[0] : NULL;
+        const double FastAlpha = m_FastAlpha;
+        const double SlowAlpha = m_SlowAlpha;
+
+        // Section 1 - The averages. The first active step of a symbol uses an alpha of 1, which seeds it with the value.
+        for (int Symbol = 0; Symbol < Count; Symbol++)
+        {
+            const double Seed = 1.0 - Seeded[Symbol];
+            const double Fast_Step = Active[Symbol] * (FastAlpha + Seed * (1.0 - FastAlpha));
+            const double Slow_Step = Active[Symbol] * (SlowAlpha + Seed * (1.0 - SlowAlpha));
+
+            Fast[Symbol] += Fast_Step * (Value[Symbol] - Fast[Symbol]);
+            Slow[Symbol] += Slow_Step * (Value[Symbol] - Slow[Symbol]);
+            Seeded[Symbol] = Seeded[Symbol] > Active[Symbol] ? Seeded[Symbol] : Active[Symbol];
+        }
+
+        // Section 2 - The signs and crosses. Equal averages keep the previous sign.
+        for (int Symbol = 0; Symbol < Count; Symbol++)
+        {
+            const float Difference = static_cast<float>(Fast[Symbol]) - static_cast<float>(Slow[Symbol]);
+            const int Sign = (Difference > 0.0f) - (Difference < 0.0f);
+            const int Previous = m_Sign[Symbol];
+            const bool Moved = Active[Symbol] != 0.0 && Sign != 0;
+
+            Cross[Symbol] = Moved && Previous != 0 && Sign != Previous ? Sign : 0;
+            m_Sign[Symbol] = Moved ? Sign : Previous;
+            m_Bars[Symbol] += Active[Symbol] != 0.0;
+        }
+    }
+
+    float Fast(int Symbol) const
+    {
+        return static_cast<float>(m_Fast[Symbol]);
+    }
+
+    float Slow(int Symbol) const
+    {
+        return static_cast<float>(m_Slow[Symbol]);
+    }
+
+private:
+    double m_FastAlpha;
+    double m_SlowAlpha;
+    std::vector<double> m_Fast;
+    std::vector<double> m_Slow;
+    std::vector<double> m_Seeded;
+    std::vector<int> m_Sign;
+    std::vector<int> m_Bars;
+};
+
+// Parses a list of chart numbers like "2, 3, 5-9". Returns false when nothing was parsed or the text is malformed.
+inline bool Portfolio_ParseCharts(const char* Text, std::vector<int>& Charts)
+{
+    Charts.clear();
+
+    const char* Position = Text;
+    while (Position != NULL && *Position != '\0')
+    {
+        while (*Position == ' ' || *Position == ',' || *Position == ';')
+            Position++;
+
+        if (*Position == '\0')
+            break;
+
+        char* End = NULL;
+        const long First = std::strtol(Position, &End, 10);
+        if (End == Position || First < 1)
+            return false;
+
+        long Last = First;
+        Position = End;
+
+        while (*Position == ' ')
+            Position++;
+
+        if (*Position == '-')
+        {
+            Position++;
+            Last = std::strtol(Position, &End, 10);
+            if (End == Position || Last < First)
+                return false;
+
+            Position = End;
+        }
+
+        for (long Chart = First; Chart <= Last; Chart++)
+            Charts.push_back(static_cast<int>(Chart));
+    }
+
+    return !Charts.empty();
+}
+
+#endif
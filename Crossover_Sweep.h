@@ -0,0 +1,422 @@
+#ifndef CROSSOVER_SWEEP_H
+#define CROSSOVER_SWEEP_H
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "MA_Kernels.h"
+#include "Study_Arena.h"
+#include "Trade_Sim.h"
+
+/*
+Parameter sweep over many fast/slow period pairs of one moving average type.
+
+All pairs are evaluated in a single streaming pass over the bars. Every distinct period is computed once per bar and shared by all the pairs that use it, from one read of the input value:
+SMA - one s_SMAKernel (a compensated s_MASum window) per period, the kernel the SMA study runs.
+EMA, ZLEMA - one recurrence per period.
+Hull - one s_HMAKernel (O(1) WMA windows, and the live value through their lines, s_HMALive) per period, the kernel the Hull study runs.
+The per-period values and recurrences, the SMA windows and the WMA windows all come from one arena (Study_Arena.h) sized by Init, so the bar loop makes no heap allocations.
+Each pair keeps its crossover state, a simulated position with the strategy's target and trailing stop bracket (Trade_Sim.h), and its closed trade statistics.
+A cross is a change of the sign of Fast - Slow, ignoring bars where the two are equal, as sc.CrossOver does. Bars before both averages have a full window are skipped.
+The SMA and Hull values are those of the studies' kernels, bit for bit, however long the history; the sweep mode of Headless/Replay_Regression.cpp checks them against the studies' subgraphs. The EMA and ZLEMA recurrences are computed in double and can differ from the studies' float subgraphs by rounding, so a pair whose averages touch exactly can flip a cross compared to the single study.
+The sweep does not depend on sierrachart.h.
+*/
+
+enum e_SweepMAType
+{
+    SWEEP_MA_SMA = 0,
+    SWEEP_MA_EMA = 1,
+    SWEEP_MA_ZLEMA = 2,
+    SWEEP_MA_HULL = 3
+};
+
+inline const char* Sweep_MATypeLabel(int Type)
+{
+    switch (Type)
+    {
+        case SWEEP_MA_SMA: return "SMA";
+        case SWEEP_MA_EMA: return "EMA";
+        case SWEEP_MA_ZLEMA: return "ZLEMA";
+        case SWEEP_MA_HULL: return "Hull";
+    }
+
+    return "Unknown";
+}
+
+struct s_SweepPair
+{
+    int FastPeriod;
+    int SlowPeriod;
+    int FastSlot;
+    int SlowSlot;
+    int PreviousSign;
+    s_BracketPosition Position;
+    s_TradeStats Stats;
+
+    s_SweepPair(int InFastPeriod = 0, int InSlowPeriod = 0)
+        : FastPeriod(InFastPeriod)
+        , SlowPeriod(InSlowPeriod)
+        , FastSlot(-1)
+        , SlowSlot(-1)
+        , PreviousSign(0)
+    {
+    }
+};
+
+// Adds every Fast < Slow combination of the two period ranges.
+inline void Sweep_AddGrid(std::vector<s_SweepPair>& Pairs, int FastFrom, int FastTo, int FastStep, int SlowFrom, int SlowTo, int SlowStep)
+{
+    if (FastStep < 1)
+        FastStep = 1;
+    if (SlowStep < 1)
+        SlowStep = 1;
+
+    for (int Fast = FastFrom; Fast <= FastTo; Fast += FastStep)
+    {
+        for (int Slow = SlowFrom; Slow <= SlowTo; Slow += SlowStep)
+        {
+            if (Fast >= 1 && Fast < Slow)
+                Pairs.push_back(s_SweepPair(Fast, Slow));
+        }
+    }
+}
+
+// Parses a list of "Fast/Slow" pairs separated by commas, semicolons or spaces, for example "9/21, 12/26".
+// Returns false when a token is not a valid pair, or its fast period is not below its slow period.
+inline bool Sweep_ParsePairs(const char* Text, std::vector<s_SweepPair>& Pairs)
+{
+    const char* Position = Text;
+
+    while (*Position != '\0')
+    {
+        if (*Position == ',' || *Position == ';' || *Position == ' ' || *Position == '\t')
+        {
+            Position++;
+            continue;
+        }
+
+        char* End = NULL;
+        const long Fast = std::strtol(Position, &End, 10);
+        if (End == Position || *End != '/')
+            return false;
+
+        Position = End + 1;
+        const long Slow = std::strtol(Position, &End, 10);
+        if (End == Position || Fast < 1 || Slow <= Fast)
+            return false;
+
+        Pairs.push_back(s_SweepPair(static_cast<int>(Fast), static_cast<int>(Slow)));
+        Position = End;
+    }
+
+    return true;
+}
+
+// Writes one CSV line of statistics per pair, in the order of Pairs.
+inline bool Sweep_WriteStats(const char* Path, int Type, const std::vector<s_SweepPair>& Pairs)
+{
+    FILE* File = std::fopen(Path, "w");
+    if (File == NULL)
+        return false;
+
+    std::fprintf(File, "Type,Fast,Slow,Trades,Wins,NetProfit,GrossProfit,GrossLoss,MaxDrawdown,AverageTrade,ProfitFactor,Sharpe\n");
+
+    for (size_t PairIndex = 0; PairIndex < Pairs.size(); PairIndex++)
+    {
+        const s_SweepPair& Pair = Pairs[PairIndex];
+        const s_TradeStats& Stats = Pair.Stats;
+
+        std::fprintf(File, "%s,%d,%d,%d,%d,%.6f,%.6f,%.6f,%.6f,%.6f,%.4f,%.4f\n",
+            Sweep_MATypeLabel(Type), Pair.FastPeriod, Pair.SlowPeriod, Stats.Trades, Stats.Wins,
+            Stats.NetProfit, Stats.GrossProfit, Stats.GrossLoss, Stats.MaxDrawdown, Stats.AverageTrade(), Stats.ProfitFactor(), Stats.Sharpe());
+    }
+
+    return std::fclose(File) == 0;
+}
+
+//================================================================================================//
+// All distinct periods of one moving average type, stepped together bar by bar.
+
+class c_SweepAverages
+{
+public:
+    c_SweepAverages()
+        : m_Type(SWEEP_MA_SMA)
+        , m_Index(-1)
+        , m_Values(NULL)
+        , m_ReadyIndex(NULL)
+        , m_Recurrence(NULL)
+        , m_SMA(NULL)
+        , m_HMA(NULL)
+    {
+    }
+
+    ~c_SweepAverages()
+    {
+        delete[] m_SMA;
+        delete[] m_HMA;
+    }
+
+    void Init(int Type, const std::vector<int>& Periods)
+    {
+        m_Type = Type;
+        m_Periods = Periods;
+        m_Index = -1;
+
+        const int Count = static_cast<int>(m_Periods.size());
+
+        size_t Window_Bytes = 0;
+        for (int Slot = 0; Slot < Count; Slot++)
+        {
+            if (m_Type == SWEEP_MA_SMA)
+                Window_Bytes += c_StudyArena::SizeOf<float>(s_SMAKernel::ScratchFloats(m_Periods[Slot]));
+            else if (m_Type == SWEEP_MA_HULL)
+                Window_Bytes += c_StudyArena::SizeOf<float>(s_HMAKernel::ScratchFloats(m_Periods[Slot]));
+        }
+
+        m_Arena.Reset(c_StudyArena::SizeOf<float>(Count) + c_StudyArena::SizeOf<int>(Count) + c_StudyArena::SizeOf<double>(Count) + Window_Bytes);
+
+        m_Values = m_Arena.Allocate<float>(Count);
+        m_ReadyIndex = m_Arena.Allocate<int>(Count);
+        m_Recurrence = m_Arena.Allocate<double>(Count);
+
+        std::fill(m_Values, m_Values + Count, 0.0f);
+        std::fill(m_ReadyIndex, m_ReadyIndex + Count, 0);
+        std::fill(m_Recurrence, m_Recurrence + Count, 0.0);
+
+        delete[] m_SMA;
+        m_SMA = NULL;
+        delete[] m_HMA;
+        m_HMA = NULL;
+
+        if (m_Type == SWEEP_MA_SMA && Count > 0)
+            m_SMA = new s_SMAKernel[Count];
+        else if (m_Type == SWEEP_MA_HULL && Count > 0)
+            m_HMA = new s_HMAKernel[Count];
+
+        for (int Slot = 0; Slot < Count; Slot++)
+        {
+            const int Length = m_Periods[Slot];
+
+            if (m_Type == SWEEP_MA_SMA)
+            {
+                m_SMA[Slot].Attach(m_Arena.Allocate<float>(s_SMAKernel::ScratchFloats(Length)), Length);
+                m_ReadyIndex[Slot] = Length - 1;
+            }
+            else if (m_Type == SWEEP_MA_HULL)
+            {
+                m_HMA[Slot].Attach(m_Arena.Allocate<float>(s_HMAKernel::ScratchFloats(Length)), Length);
+                m_ReadyIndex[Slot] = m_HMA[Slot].State.WarmupBars();
+            }
+        }
+    }
+
+    int Slot(int Period) const
+    {
+        const std::vector<int>::const_iterator Found = std::lower_bound(m_Periods.begin(), m_Periods.end(), Period);
+        return Found != m_Periods.end() && *Found == Period ? static_cast<int>(Found - m_Periods.begin()) : -1;
+    }
+
+    // Computes every period for bar Index (called with Index = 0, 1, 2, ...). In is needed for the ZLEMA lag.
+    void Step(const float* In, int Index)
+    {
+        m_Index = Index;
+
+        const float Value = In[Index];
+        const int Count = static_cast<int>(m_Periods.size());
+
+        switch (m_Type)
+        {
+            case SWEEP_MA_SMA:
+            {
+                for (int Slot = 0; Slot < Count; Slot++)
+                    m_Values[Slot] = m_SMA[Slot].Update(In, Index, m_Periods[Slot]);
+            }
+            break;
+
+            case SWEEP_MA_EMA:
+            case SWEEP_MA_ZLEMA:
+            {
+                for (int Slot = 0; Slot < Count; Slot++)
+                {
+                    const int Length = m_Periods[Slot];
+                    const int Lag = m_Type == SWEEP_MA_ZLEMA ? (Length - 1) / 2 : 0;
+
+                    double Term = Value;
+                    if (Lag > 0 && Index >= Lag)
+                        Term = 2.0 * Value - In[Index - Lag];
+
+                    if (Index == 0)
+                        m_Recurrence[Slot] = Value;
+                    else
+                    {
+                        const double Alpha = 2.0 / (Length + 1);
+                        m_Recurrence[Slot] = Alpha * Term + (1.0 - Alpha) * m_Recurrence[Slot];
+                    }
+
+                    m_Values[Slot] = static_cast<float>(m_Recurrence[Slot]);
+                }
+            }
+            break;
+
+            case SWEEP_MA_HULL:
+            {
+                for (int Slot = 0; Slot < Count; Slot++)
+                    m_Values[Slot] = m_HMA[Slot].Update(In, Index, m_Periods[Slot]);
+            }
+            break;
+        }
+    }
+
+    float Value(int Slot) const
+    {
+        return m_Values[Slot];
+    }
+
+    bool IsReady(int Slot) const
+    {
+        return m_Index >= m_ReadyIndex[Slot];
+    }
+
+private:
+    c_SweepAverages(const c_SweepAverages&);
+    c_SweepAverages& operator=(const c_SweepAverages&);
+
+    int m_Type;
+    int m_Index;
+    std::vector<int> m_Periods;
+    c_StudyArena m_Arena;
+    float* m_Values;
+    int* m_ReadyIndex;
+    double* m_Recurrence;
+    s_SMAKernel* m_SMA;
+    s_HMAKernel* m_HMA;
+};
+
+//================================================================================================//
+
+class c_CrossoverSweep
+{
+public:
+    c_CrossoverSweep()
+        : m_Type(SWEEP_MA_SMA)
+        , m_TargetOffset(0.0)
+        , m_StopOffset(0.0)
+    {
+    }
+
+    void Init(int Type, const std::vector<s_SweepPair>& Pairs, double TargetOffset, double StopOffset)
+    {
+        m_Type = Type;
+        m_Pairs = Pairs;
+        m_TargetOffset = TargetOffset;
+        m_StopOffset = StopOffset;
+
+        std::vector<int> Periods;
+        for (size_t PairIndex = 0; PairIndex < m_Pairs.size(); PairIndex++)
+        {
+            Periods.push_back(m_Pairs[PairIndex].FastPeriod);
+            Periods.push_back(m_Pairs[PairIndex].SlowPeriod);
+        }
+
+        std::sort(Periods.begin(), Periods.end());
+        Periods.erase(std::unique(Periods.begin(), Periods.end()), Periods.end());
+
+        m_Averages.Init(m_Type, Periods);
+
+        for (size_t PairIndex = 0; PairIndex < m_Pairs.size(); PairIndex++)
+        {
+            s_SweepPair& Pair = m_Pairs[PairIndex];
+            Pair.FastSlot = m_Averages.Slot(Pair.FastPeriod);
+            Pair.SlowSlot = m_Averages.Slot(Pair.SlowPeriod);
+        }
+    }
+
+    // Runs the whole sweep over bars 0 to Count - 1. In is the moving average input, Close the entry and exit price on signals.
+    // Signals may be NULL; otherwise Signals[p] for the first SignalCount pairs receives +1 / -1 on the bars with a cross and 0 elsewhere.
+    void Run(const float* In, const float* High, const float* Low, const float* Close, int Count, float* const* Signals, int SignalCount)
+    {
+        RunBars(In, High, Low, Close, 0, Count, Signals, SignalCount);
+    }
+
+    // Runs bars Begin to End - 1 and returns, so a caller can stop between calls. Begin is 0 on the first call and the previous End on the next ones.
+    void RunBars(const float* In, const float* High, const float* Low, const float* Close, int Begin, int End, float* const* Signals, int SignalCount)
+    {
+        const int PairCount = static_cast<int>(m_Pairs.size());
+        if (Signals == NULL)
+            SignalCount = 0;
+        else if (SignalCount > PairCount)
+            SignalCount = PairCount;
+
+        for (int Index = Begin; Index < End; Index++)
+        {
+            m_Averages.Step(In, Index);
+
+            for (int PairIndex = 0; PairIndex < PairCount; PairIndex++)
+            {
+                const int Signal = StepPair(m_Pairs[PairIndex], Index, High[Index], Low[Index], Close[Index]);
+
+                if (PairIndex < SignalCount)
+                    Signals[PairIndex][Index] = static_cast<float>(Signal);
+            }
+        }
+    }
+
+    const std::vector<s_SweepPair>& Pairs() const
+    {
+        return m_Pairs;
+    }
+
+    int Type() const
+    {
+        return m_Type;
+    }
+
+    // Writes one CSV line of statistics per pair.
+    bool WriteStats(const char* Path) const
+    {
+        return Sweep_WriteStats(Path, m_Type, m_Pairs);
+    }
+
+private:
+    // Returns +1 / -1 when the pair crosses on this bar, 0 otherwise.
+    int StepPair(s_SweepPair& Pair, int Index, float High, float Low, float Close)
+    {
+        double ExitPrice = 0.0;
+        if (Pair.Position.IsOpen() && Index > Pair.Position.EntryIndex && Pair.Position.Step(High, Low, ExitPrice))
+            Pair.Stats.Add(Pair.Position.Close(ExitPrice));
+
+        if (!m_Averages.IsReady(Pair.FastSlot) || !m_Averages.IsReady(Pair.SlowSlot))
+            return 0;
+
+        const float Difference = m_Averages.Value(Pair.FastSlot) - m_Averages.Value(Pair.SlowSlot);
+        const int Sign = Difference > 0.0f ? 1 : (Difference < 0.0f ? -1 : 0);
+        if (Sign == 0)
+            return 0;
+
+        const int PreviousSign = Pair.PreviousSign;
+        Pair.PreviousSign = Sign;
+
+        if (PreviousSign == 0 || PreviousSign == Sign)
+            return 0;
+
+        if (Pair.Position.IsOpen() && Pair.Position.Direction != Sign)
+            Pair.Stats.Add(Pair.Position.Close(Close));
+
+        if (!Pair.Position.IsOpen())
+            Pair.Position.Open(Sign, Index, Close, m_TargetOffset, m_StopOffset);
+
+        return Sign;
+    }
+
+    int m_Type;
+    double m_TargetOffset;
+    double m_StopOffset;
+    std::vector<s_SweepPair> m_Pairs;
+    c_SweepAverages m_Averages;
+};
+
+#endif
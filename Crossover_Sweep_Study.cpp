@@ -0,0 +1,281 @@
+#include "sierrachart.h"
+#include "Crossover_Optimizer.h"
+
+SCDLLName("Crossover Sweep Study")
+
+/*
+This study runs the moving average crossover strategy for many fast/slow period pairs at once, to compare the pairs on the same chart. It does not place any orders.
+
+Inputs:
+Moving Average Type - SMA, EMA, ZLEMA or Hull.
+Input Data - the series the averages are computed from. Entries and exits on crosses use the bar close, as the strategies do on the closed bar.
+Faster / Slower Period From, To and Step - a grid of periods. Every combination with Fast < Slow is evaluated.
+Period Pairs - an explicit list like "9/21, 12/26, 20/50". When it is not empty it is used instead of the grid. Every pair's fast period must be below its slow period.
+Target and Stop Value in terms of Ticks - the same bracket as the strategies: a limit target and a trailing stop.
+Stats Output File - when set, a CSV line of statistics per pair is written after every recalculation.
+Optimizer Mode - splits the pairs across a work-stealing thread pool (c_CrossoverOptimizer in Crossover_Optimizer.h) on background threads instead of one pass on the chart thread. Optimizer Threads sets the number of workers, 0 uses every hardware thread.
+Rank By and Ranking Output File - in optimizer mode, the pairs ranked by net profit, max drawdown or Sharpe are written to this CSV file, with the rank of each pair on all three. Pairs without trades rank last by drawdown.
+Main Logic:
+All the pairs are evaluated in a single streaming pass over sc.BaseDataIn (c_CrossoverSweep in Crossover_Sweep.h). Each distinct period is computed once per bar from one read of the input and shared by every pair that uses it; each SMA period keeps the compensated window sum of the SMA study, so its crosses are the study's.
+Each pair keeps its own simulated position and closed trade statistics (Trade_Sim.h describes the fill model).
+The first 60 pairs get a signal subgraph: +1 on a bar where the fast average crosses above the slow one, -1 where it crosses below, 0 elsewhere. The subgraphs are hidden by default; their values show in the Chart Values window and the spreadsheets.
+The number of pairs and the best pair by net profit are written to the message log.
+In optimizer mode the recalculation only starts the run and returns. The chart keeps updating while it runs: sc.UpdateAlways is set until a later call finds the run finished and fills in the signals, the log message and the files. A new recalculation cancels a run still going.
+Additional Notes:
+The sweep runs when the study recalculates from bar 0 (chart load, input change, recalculate). New bars are not added incrementally; recalculate the chart to include them.
+Open positions at the end of the data are not counted in the statistics.
+*/
+
+const int SWEEP_MAX_SIGNAL_SUBGRAPHS = 60;
+
+// Writes the best pair to the message log and the statistics to Stats_Path when it is set.
+static void Sweep_Report(SCStudyInterfaceRef sc, int Type, const std::vector<s_SweepPair>& Results, int BarCount, const char* Stats_Path)
+{
+    size_t Best = 0;
+    for (size_t PairIndex = 1; PairIndex < Results.size(); PairIndex++)
+    {
+        if (Results[PairIndex].Stats.NetProfit > Results[Best].Stats.NetProfit)
+            Best = PairIndex;
+    }
+
+    SCString Message;
+    Message.Format("Crossover Sweep: %d %s pairs over %d bars. Best net profit %d/%d: %.2f in %d trades, max drawdown %.2f.",
+        static_cast<int>(Results.size()), Sweep_MATypeLabel(Type), BarCount,
+        Results[Best].FastPeriod, Results[Best].SlowPeriod, Results[Best].Stats.NetProfit, Results[Best].Stats.Trades, Results[Best].Stats.MaxDrawdown);
+    sc.AddMessageToLog(Message, 0);
+
+    if (Stats_Path != NULL && Stats_Path[0] != '\0' && !Sweep_WriteStats(Stats_Path, Type, Results))
+    {
+        Message.Format("Crossover Sweep: could not write the stats file %s.", Stats_Path);
+        sc.AddMessageToLog(Message, 1);
+    }
+}
+
+SCSFExport scsf_Crossover_Sweep(SCStudyInterfaceRef sc)
+{
+    SCInputRef MA_Type = sc.Input[0];
+    SCInputRef MA_Data = sc.Input[1];
+    SCInputRef Fast_From = sc.Input[2];
+    SCInputRef Fast_To = sc.Input[3];
+    SCInputRef Fast_Step = sc.Input[4];
+    SCInputRef Slow_From = sc.Input[5];
+    SCInputRef Slow_To = sc.Input[6];
+    SCInputRef Slow_Step = sc.Input[7];
+    SCInputRef Target_Ticks = sc.Input[8];
+    SCInputRef Stop_Ticks = sc.Input[9];
+    SCInputRef Stats_File = sc.Input[10];
+    SCInputRef Period_Pairs = sc.Input[11];
+    SCInputRef Optimizer_Mode = sc.Input[12];
+    SCInputRef Optimizer_Threads = sc.Input[13];
+    SCInputRef Rank_By = sc.Input[14];
+    SCInputRef Ranking_File = sc.Input[15];
+
+    // Section 1 - Set the configuration variables and defaults
+    if (sc.SetDefaults)
+    {
+        sc.GraphName = "Crossover Parameter Sweep";
+
+        sc.AutoLoop = 0;
+        sc.GraphRegion = 1;
+
+        MA_Type.Name = "Moving Average Type";
+        MA_Type.SetCustomInputStrings("SMA;EMA;ZLEMA;Hull");
+        MA_Type.SetCustomInputIndex(SWEEP_MA_SMA);
+
+        MA_Data.Name = "Input Data";
+        MA_Data.SetInputDataIndex(SC_LAST);
+
+        Fast_From.Name = "Faster Period From";
+        Fast_From.SetInt(5);
+        Fast_From.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        Fast_To.Name = "Faster Period To";
+        Fast_To.SetInt(20);
+        Fast_To.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        Fast_Step.Name = "Faster Period Step";
+        Fast_Step.SetInt(5);
+        Fast_Step.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        Slow_From.Name = "Slower Period From";
+        Slow_From.SetInt(20);
+        Slow_From.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        Slow_To.Name = "Slower Period To";
+        Slow_To.SetInt(100);
+        Slow_To.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        Slow_Step.Name = "Slower Period Step";
+        Slow_Step.SetInt(10);
+        Slow_Step.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        Target_Ticks.Name = "Target Value in terms of Ticks";
+        Target_Ticks.SetInt(80);
+
+        Stop_Ticks.Name = "Stop Value in terms of Ticks";
+        Stop_Ticks.SetInt(80);
+
+        Stats_File.Name = "Stats Output File (CSV, empty for none)";
+        Stats_File.SetString("");
+
+        Period_Pairs.Name = "Period Pairs (Fast/Slow list, overrides the grid)";
+        Period_Pairs.SetString("");
+
+        Optimizer_Mode.Name = "Optimizer Mode (multi-threaded)";
+        Optimizer_Mode.SetYesNo(0);
+
+        Optimizer_Threads.Name = "Optimizer Threads (0 = all cores)";
+        Optimizer_Threads.SetInt(0);
+        Optimizer_Threads.SetIntLimits(0, 1024);
+
+        Rank_By.Name = "Rank By";
+        Rank_By.SetCustomInputStrings("Net Profit;Max Drawdown;Sharpe");
+        Rank_By.SetCustomInputIndex(OPTIMIZER_RANK_NET_PROFIT);
+
+        Ranking_File.Name = "Ranking Output File (CSV, empty for none)";
+        Ranking_File.SetString("");
+
+        for (int SubgraphIndex = 0; SubgraphIndex < SWEEP_MAX_SIGNAL_SUBGRAPHS; SubgraphIndex++)
+        {
+            sc.Subgraph[SubgraphIndex].Name.Format("Pair %d Signal", SubgraphIndex + 1);
+            sc.Subgraph[SubgraphIndex].DrawStyle = DRAWSTYLE_HIDDEN;
+        }
+
+        return;
+    }
+
+    // The background optimizer run, when there is one
+    c_CrossoverOptimizer* p_Optimizer = static_cast<c_CrossoverOptimizer*>(sc.GetPersistentPointer(0));
+
+    if (sc.LastCallToFunction)
+    {
+        if (p_Optimizer != NULL)
+        {
+            delete p_Optimizer;
+            sc.SetPersistentPointer(0, NULL);
+        }
+
+        return;
+    }
+
+    // Section 2 - Deliver an optimizer run that finished since the last call
+    if (p_Optimizer != NULL && sc.UpdateStartIndex != 0 && p_Optimizer->Finished())
+    {
+        sc.UpdateAlways = 0;
+
+        const int Bar_Count = std::min(p_Optimizer->BarCount(), sc.ArraySize);
+        for (int SubgraphIndex = 0; SubgraphIndex < p_Optimizer->SignalCount(); SubgraphIndex++)
+        {
+            const float* Run_Signals = p_Optimizer->Signals(SubgraphIndex);
+            SCSubgraphRef Signal = sc.Subgraph[SubgraphIndex];
+
+            for (int BarIndex = 0; BarIndex < Bar_Count; BarIndex++)
+                Signal[BarIndex] = Run_Signals[BarIndex];
+        }
+
+        Sweep_Report(sc, p_Optimizer->Type(), p_Optimizer->Results(), p_Optimizer->BarCount(), Stats_File.GetString());
+
+        const char* Ranking_Path = Ranking_File.GetString();
+        if (Ranking_Path != NULL && Ranking_Path[0] != '\0' && !p_Optimizer->WriteRanking(Ranking_Path, Rank_By.GetIndex()))
+        {
+            SCString Message;
+            Message.Format("Crossover Sweep: could not write the ranking file %s.", Ranking_Path);
+            sc.AddMessageToLog(Message, 1);
+        }
+    }
+
+    // Section 3 - Build the list of pairs
+    if (sc.UpdateStartIndex != 0 || sc.ArraySize <= 0)
+        return;
+
+    if (p_Optimizer != NULL && p_Optimizer->IsRunning())
+    {
+        p_Optimizer->Cancel();
+        sc.UpdateAlways = 0;
+    }
+
+    const int Type = MA_Type.GetIndex();
+
+    std::vector<s_SweepPair> Pairs;
+    const char* Pair_List = Period_Pairs.GetString();
+
+    if (Pair_List != NULL && Pair_List[0] != '\0')
+    {
+        if (!Sweep_ParsePairs(Pair_List, Pairs))
+        {
+            sc.AddMessageToLog("Crossover Sweep: the Period Pairs input is not a list of Fast/Slow pairs with Fast < Slow like \"9/21, 12/26\".", 1);
+            return;
+        }
+    }
+    else
+    {
+        Sweep_AddGrid(Pairs, Fast_From.GetInt(), Fast_To.GetInt(), Fast_Step.GetInt(), Slow_From.GetInt(), Slow_To.GetInt(), Slow_Step.GetInt());
+    }
+
+    if (Pairs.empty())
+    {
+        sc.AddMessageToLog("Crossover Sweep: no period pairs with Fast < Slow to evaluate.", 1);
+        return;
+    }
+
+    // Section 4 - One streaming pass over the bars for every pair, or the optimizer run started in the background
+    const int Signal_Count = static_cast<int>(std::min(Pairs.size(), static_cast<size_t>(SWEEP_MAX_SIGNAL_SUBGRAPHS)));
+    float* Signals[SWEEP_MAX_SIGNAL_SUBGRAPHS];
+
+    for (int SubgraphIndex = 0; SubgraphIndex < SWEEP_MAX_SIGNAL_SUBGRAPHS; SubgraphIndex++)
+    {
+        SCSubgraphRef Signal = sc.Subgraph[SubgraphIndex];
+
+        if (SubgraphIndex < Signal_Count)
+        {
+            Signal.Name.Format("%s %d/%d Signal", Sweep_MATypeLabel(Type), Pairs[SubgraphIndex].FastPeriod, Pairs[SubgraphIndex].SlowPeriod);
+            Signals[SubgraphIndex] = &Signal[0];
+        }
+        else
+        {
+            Signal.Name.Format("Pair %d Signal", SubgraphIndex + 1);
+        }
+
+        // An optimizer run fills its signals in when it has finished.
+        if (SubgraphIndex >= Signal_Count || Optimizer_Mode.GetYesNo())
+        {
+            for (int BarIndex = 0; BarIndex < sc.ArraySize; BarIndex++)
+                Signal[BarIndex] = 0.0f;
+        }
+    }
+
+    s_OptimizerBars Bars;
+    Bars.In = &sc.BaseDataIn[MA_Data.GetInputDataIndex()][0];
+    Bars.High = &sc.BaseDataIn[SC_HIGH][0];
+    Bars.Low = &sc.BaseDataIn[SC_LOW][0];
+    Bars.Close = &sc.BaseDataIn[SC_LAST][0];
+    Bars.Count = sc.ArraySize;
+
+    const double Target_Offset = Target_Ticks.GetInt() * sc.TickSize;
+    const double Stop_Offset = Stop_Ticks.GetInt() * sc.TickSize;
+
+    if (Optimizer_Mode.GetYesNo())
+    {
+        if (p_Optimizer == NULL)
+        {
+            p_Optimizer = new c_CrossoverOptimizer;
+            sc.SetPersistentPointer(0, p_Optimizer);
+        }
+
+        p_Optimizer->Start(Type, Pairs, Bars, Target_Offset, Stop_Offset, Optimizer_Threads.GetInt(), Signal_Count);
+        sc.UpdateAlways = 1;
+
+        SCString Message;
+        Message.Format("Crossover Sweep: optimizing %d %s pairs over %d bars in the background.", static_cast<int>(Pairs.size()), Sweep_MATypeLabel(Type), sc.ArraySize);
+        sc.AddMessageToLog(Message, 0);
+        return;
+    }
+
+    c_CrossoverSweep Sweep;
+    Sweep.Init(Type, Pairs, Target_Offset, Stop_Offset);
+    Sweep.Run(Bars.In, Bars.High, Bars.Low, Bars.Close, Bars.Count, Signals, Signal_Count);
+
+    // Section 5 - Report the results
+    Sweep_Report(sc, Type, Sweep.Pairs(), sc.ArraySize, Stats_File.GetString());
+}
+//================================================================================================//
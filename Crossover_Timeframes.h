@@ -0,0 +1,688 @@
+#ifndef CROSSOVER_TIMEFRAMES_H
+#define CROSSOVER_TIMEFRAMES_H
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "MA_Adaptive_Kernels.h"
+#include "MA_Kernels.h"
+#include "Study_Arena.h"
+
+/*
+Higher timeframe confirmation for the crossover studies: the same fast and slow averages on up to TIMEFRAME_MAX_LEGS higher timeframes, built from the chart's own bars.
+
+A leg (c_TimeframeLeg) aggregates the chart's bars into bars of its period, aligned to multiples of the period in chart time (so to the start of the day for a period that divides one), and runs the study's type of average over them with the O(1) kernels of MA_Kernels.h.
+The higher timeframe bar that is still forming holds the bars up to the one being computed, so each chart bar sees the leg as it was at that bar's close, on a full recalculation as live: there is no look ahead into the rest of the higher timeframe bar.
+Each chart bar costs each leg one aggregation step and one kernel update, the live line of MA_Kernels.h while the higher timeframe bar forms and a commit when it closes.
+The trend of a leg at a chart bar is the sign of its fast minus slow average, +1, -1, or 0 while either average is still warming up.
+The input fields aggregate by their rule (e_TimeframeRule): the first open, the highest high, the lowest low, the summed volume, and the last value of the other fields.
+An average that weighs by volume (UsesVolume, the VWMA) also gets the summed chart volume of each higher timeframe bar; the others do not pay for it.
+The legs share nothing but the read-only chart arrays, so on a full recalculation of at least TIMEFRAME_PARALLEL_BARS bars each leg after the first runs on its own thread.
+The arrays of a leg are sized on each full recalculation with room for TIMEFRAME_HEADROOM_BARS more higher timeframe bars, so the calls in between do not allocate until that many have formed. The chart bars' start times are only kept for the bars a call computes.
+This replaces pulling each higher timeframe from another chart with sc.GetStudyArrayFromChart, which makes those charts recalculate with this one.
+Nothing here depends on sierrachart.h.
+*/
+
+const int TIMEFRAME_MAX_LEGS = 3;
+const int TIMEFRAME_PARALLEL_BARS = 50000;
+const int TIMEFRAME_HEADROOM_BARS = 4096;
+
+enum e_TimeframeRule
+{
+    TIMEFRAME_FIRST = 0,
+    TIMEFRAME_MAX = 1,
+    TIMEFRAME_MIN = 2,
+    TIMEFRAME_SUM = 3,
+    TIMEFRAME_LAST = 4
+};
+
+// Parses a list of periods in minutes separated by commas, semicolons or spaces, for example "5, 15, 60", into Minutes.
+// Returns false when a token is not a positive whole number or there are more than TIMEFRAME_MAX_LEGS.
+inline bool Timeframe_ParseMinutes(const char* Text, int* Minutes, int& Count)
+{
+    Count = 0;
+    const char* Position = Text;
+
+    while (*Position != '\0')
+    {
+        if (*Position == ',' || *Position == ';' || *Position == ' ' || *Position == '\t')
+        {
+            Position++;
+            continue;
+        }
+
+        char* End = NULL;
+        const long Value = std::strtol(Position, &End, 10);
+        if (End == Position || Value < 1 || Value > 100000 || Count == TIMEFRAME_MAX_LEGS)
+            return false;
+
+        Minutes[Count++] = static_cast<int>(Value);
+        Position = End;
+    }
+
+    return true;
+}
+
+// The value of the higher timeframe bar so far (Aggregate over Bars bars) with Value of the next chart bar.
+inline double Timeframe_Combine(int Rule, double Aggregate, int Bars, float Value)
+{
+    if (Bars == 0)
+        return Value;
+
+    switch (Rule)
+    {
+        case TIMEFRAME_FIRST: return Aggregate;
+        case TIMEFRAME_MAX: return Value > Aggregate ? Value : Aggregate;
+        case TIMEFRAME_MIN: return Value < Aggregate ? Value : Aggregate;
+        case TIMEFRAME_SUM: return Aggregate + Value;
+    }
+
+    return Value;
+}
+
+// The chart arrays a leg reads. Seconds holds the start time in whole seconds of chart bars SecondsFirst on, Seconds[0] for bar SecondsFirst.
+// Volume is only read for an average that uses it.
+struct s_TimeframeBars
+{
+    const float* FastIn;
+    const float* SlowIn;
+    const float* Volume;
+    const long long* Seconds;
+    int SecondsFirst;
+    int FastRule;
+    int SlowRule;
+
+    s_TimeframeBars()
+        : FastIn(NULL)
+        , SlowIn(NULL)
+        , Volume(NULL)
+        , Seconds(NULL)
+        , SecondsFirst(0)
+        , FastRule(TIMEFRAME_LAST)
+        , SlowRule(TIMEFRAME_LAST)
+    {
+    }
+};
+
+//================================================================================================//
+// The averages of the legs, one per study type (the TimeframeAverage of the policies in Crossover_Engine.h). Each runs the MA_Kernels.h or MA_Adaptive_Kernels.h kernels of that type over the arrays of a leg.
+// Volume is the leg's summed volume per higher timeframe bar when UsesVolume is set, NULL otherwise.
+
+struct s_TimeframeSMA
+{
+    static const bool UsesVolume = false;
+
+    s_SMAKernel Fast;
+    s_SMAKernel Slow;
+
+    static int ScratchFloats(int FastLength, int SlowLength)
+    {
+        return s_SMAKernel::ScratchFloats(FastLength) + s_SMAKernel::ScratchFloats(SlowLength);
+    }
+
+    // The first index at which both averages have their full window.
+    static int ReadyIndex(int FastLength, int SlowLength)
+    {
+        return (FastLength > SlowLength ? FastLength : SlowLength) - 1;
+    }
+
+    void Attach(float* Scratch, int FastLength, int SlowLength)
+    {
+        Fast.Attach(Scratch, FastLength);
+        Slow.Attach(Scratch + s_SMAKernel::ScratchFloats(FastLength), SlowLength);
+    }
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        FastOut[Index] = Fast.Update(FastIn, Index, FastLength);
+        SlowOut[Index] = Slow.Update(SlowIn, Index, SlowLength);
+    }
+};
+
+template <bool ZeroLag>
+struct s_TimeframeEMABase
+{
+    static const bool UsesVolume = false;
+
+    s_EMAKernel Fast;
+    s_EMAKernel Slow;
+
+    s_TimeframeEMABase()
+        : Fast(ZeroLag)
+        , Slow(ZeroLag)
+    {
+    }
+
+    static int ScratchFloats(int, int)
+    {
+        return 0;
+    }
+
+    static int ReadyIndex(int FastLength, int SlowLength)
+    {
+        return (FastLength > SlowLength ? FastLength : SlowLength) - 1;
+    }
+
+    void Attach(float*, int, int)
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        FastOut[Index] = Fast.Update(FastIn, FastOut, Index, FastLength);
+        SlowOut[Index] = Slow.Update(SlowIn, SlowOut, Index, SlowLength);
+    }
+};
+
+typedef s_TimeframeEMABase<false> s_TimeframeEMA;
+typedef s_TimeframeEMABase<true> s_TimeframeZLEMA;
+
+struct s_TimeframeHull
+{
+    static const bool UsesVolume = false;
+
+    s_HMAPairKernel Kernel;
+
+    static int ScratchFloats(int FastLength, int SlowLength)
+    {
+        return s_HMAPairKernel::ScratchFloats(FastLength, SlowLength);
+    }
+
+    static int ReadyIndex(int FastLength, int SlowLength)
+    {
+        const int Fast_Warmup = (FastLength - 1) + (MA_HullRootLength(FastLength) - 1);
+        const int Slow_Warmup = (SlowLength - 1) + (MA_HullRootLength(SlowLength) - 1);
+        return Fast_Warmup > Slow_Warmup ? Fast_Warmup : Slow_Warmup;
+    }
+
+    void Attach(float* Scratch, int FastLength, int SlowLength)
+    {
+        Kernel.Attach(Scratch, FastLength, SlowLength);
+    }
+
+    void Reset()
+    {
+        Kernel.Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        Kernel.Update(FastIn, SlowIn, Index, FastLength, SlowLength, FastOut[Index], SlowOut[Index]);
+    }
+};
+
+// KAMA, ALMA and VWMA: the fast and slow kernels over the scratch of the leg, one after the other. T3 has none.
+struct s_TimeframeKAMA
+{
+    static const bool UsesVolume = false;
+
+    s_KAMAKernel Fast;
+    s_KAMAKernel Slow;
+
+    static int ScratchFloats(int FastLength, int SlowLength)
+    {
+        return s_KAMAKernel::ScratchFloats(FastLength) + s_KAMAKernel::ScratchFloats(SlowLength);
+    }
+
+    static int ReadyIndex(int FastLength, int SlowLength)
+    {
+        return (FastLength > SlowLength ? FastLength : SlowLength) - 1;
+    }
+
+    void Attach(float* Scratch, int FastLength, int SlowLength)
+    {
+        Fast.Attach(Scratch, FastLength);
+        Slow.Attach(Scratch + s_KAMAKernel::ScratchFloats(FastLength), SlowLength);
+    }
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        FastOut[Index] = Fast.Update(FastIn, FastOut, Index, FastLength);
+        SlowOut[Index] = Slow.Update(SlowIn, SlowOut, Index, SlowLength);
+    }
+};
+
+struct s_TimeframeALMA
+{
+    static const bool UsesVolume = false;
+
+    s_ALMAKernel Fast;
+    s_ALMAKernel Slow;
+
+    static int ScratchFloats(int FastLength, int SlowLength)
+    {
+        return s_ALMAKernel::ScratchFloats(FastLength) + s_ALMAKernel::ScratchFloats(SlowLength);
+    }
+
+    static int ReadyIndex(int FastLength, int SlowLength)
+    {
+        return (FastLength > SlowLength ? FastLength : SlowLength) - 1;
+    }
+
+    void Attach(float* Scratch, int FastLength, int SlowLength)
+    {
+        Fast.Attach(Scratch, FastLength);
+        Slow.Attach(Scratch + s_ALMAKernel::ScratchFloats(FastLength), SlowLength);
+    }
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        FastOut[Index] = Fast.Update(FastIn, Index, FastLength);
+        SlowOut[Index] = Slow.Update(SlowIn, Index, SlowLength);
+    }
+};
+
+// A rewind replays the leg's bars from its first one, the only way to rebuild the T3 state (MA_Adaptive_Kernels.h).
+struct s_TimeframeT3
+{
+    static const bool UsesVolume = false;
+
+    s_T3Kernel Fast;
+    s_T3Kernel Slow;
+
+    static int ScratchFloats(int, int)
+    {
+        return 0;
+    }
+
+    static int ReadyIndex(int FastLength, int SlowLength)
+    {
+        return (FastLength > SlowLength ? FastLength : SlowLength) - 1;
+    }
+
+    void Attach(float*, int, int)
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        FastOut[Index] = Fast.Update(FastIn, Index, FastLength);
+        SlowOut[Index] = Slow.Update(SlowIn, Index, SlowLength);
+    }
+};
+
+struct s_TimeframeVWMA
+{
+    static const bool UsesVolume = true;
+
+    s_VWMAKernel Fast;
+    s_VWMAKernel Slow;
+
+    static int ScratchFloats(int FastLength, int SlowLength)
+    {
+        return s_VWMAKernel::ScratchFloats(FastLength) + s_VWMAKernel::ScratchFloats(SlowLength);
+    }
+
+    static int ReadyIndex(int FastLength, int SlowLength)
+    {
+        return (FastLength > SlowLength ? FastLength : SlowLength) - 1;
+    }
+
+    void Attach(float* Scratch, int FastLength, int SlowLength)
+    {
+        Fast.Attach(Scratch, FastLength);
+        Slow.Attach(Scratch + s_VWMAKernel::ScratchFloats(FastLength), SlowLength);
+    }
+
+    void Reset()
+    {
+        Fast.Reset();
+        Slow.Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, const float* Volume, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        FastOut[Index] = Fast.Update(FastIn, Volume, Index, FastLength);
+        SlowOut[Index] = Slow.Update(SlowIn, Volume, Index, SlowLength);
+    }
+};
+
+//================================================================================================//
+
+template <typename t_Average>
+class c_TimeframeLeg
+{
+public:
+    c_TimeframeLeg()
+        : m_Seconds(60)
+        , m_FastLength(1)
+        , m_SlowLength(1)
+        , m_ReadyIndex(0)
+        , m_SharedInput(false)
+        , m_PeriodStart(0)
+        , m_LastBar(-1)
+        , m_FastAggregate(0.0)
+        , m_SlowAggregate(0.0)
+        , m_VolumeAggregate(0.0)
+        , m_AggregateBars(0)
+    {
+    }
+
+    // Sets the period and the averages and drops the history.
+    void Configure(int Minutes, int FastLength, int SlowLength, bool SharedInput)
+    {
+        m_Seconds = static_cast<long long>(Minutes) * 60;
+        m_FastLength = FastLength;
+        m_SlowLength = SlowLength;
+        m_ReadyIndex = t_Average::ReadyIndex(FastLength, SlowLength);
+        m_SharedInput = SharedInput;
+
+        const int Floats = t_Average::ScratchFloats(FastLength, SlowLength);
+        m_Arena.Reset(c_StudyArena::SizeOf<float>(Floats));
+        m_Average.Attach(m_Arena.Allocate<float>(Floats), FastLength, SlowLength);
+
+        Clear();
+    }
+
+    void Clear()
+    {
+        m_FastIn.clear();
+        m_SlowIn.clear();
+        m_FastOut.clear();
+        m_SlowOut.clear();
+        m_Volume.clear();
+        m_FirstBar.clear();
+        m_LastBar = -1;
+        m_AggregateBars = 0;
+        m_Average.Reset();
+    }
+
+    // The chart bar an Update from First computes from.
+    int StartBar(int First) const
+    {
+        if (First <= 0 || First == m_LastBar || First == m_LastBar + 1)
+            return First > 0 ? First : 0;
+
+        const int Keep = KeepCount(First);
+        return Keep > 0 ? m_FirstBar[Keep - 1] : 0;
+    }
+
+    // Computes the trend of chart bars First to End - 1 into Trend. From the bar after the last one computed, or the last one again (a tick) continues;
+    // any other First goes back to the start of the higher timeframe bar that holds it.
+    // A computation from bar 0 ends by making room for TIMEFRAME_HEADROOM_BARS more higher timeframe bars.
+    void Update(const s_TimeframeBars& Bars, int First, int End, float* Trend)
+    {
+        const bool Full = First <= 0;
+
+        if (Full)
+            Clear();
+        else if (First != m_LastBar && First != m_LastBar + 1)
+            First = Rewind(First);
+
+        for (int BarIndex = First; BarIndex < End; BarIndex++)
+            Trend[BarIndex] = Step(Bars, BarIndex);
+
+        if (Full)
+            Reserve(m_FirstBar.size() + TIMEFRAME_HEADROOM_BARS);
+    }
+
+private:
+    c_TimeframeLeg(const c_TimeframeLeg&);
+    c_TimeframeLeg& operator=(const c_TimeframeLeg&);
+
+    void Reserve(size_t Capacity)
+    {
+        m_FastIn.reserve(Capacity);
+        m_SlowIn.reserve(Capacity);
+        m_FastOut.reserve(Capacity);
+        m_SlowOut.reserve(Capacity);
+        m_FirstBar.reserve(Capacity);
+
+        if (t_Average::UsesVolume)
+            m_Volume.reserve(Capacity);
+    }
+
+    // The higher timeframe bars up to the one holding chart bar BarIndex.
+    int KeepCount(int BarIndex) const
+    {
+        int Keep = static_cast<int>(m_FirstBar.size());
+        while (Keep > 0 && m_FirstBar[Keep - 1] > BarIndex)
+            Keep--;
+
+        return Keep;
+    }
+
+    // Drops the higher timeframe bar holding chart bar BarIndex and everything after it. Returns the chart bar to compute from, the first of that bar.
+    int Rewind(int BarIndex)
+    {
+        const int Keep = KeepCount(BarIndex);
+
+        if (Keep == 0)
+        {
+            Clear();
+            return 0;
+        }
+
+        const int First = m_FirstBar[Keep - 1];
+        m_FastIn.resize(Keep - 1);
+        m_SlowIn.resize(Keep - 1);
+        m_FastOut.resize(Keep - 1);
+        m_SlowOut.resize(Keep - 1);
+        m_FirstBar.resize(Keep - 1);
+
+        if (t_Average::UsesVolume)
+            m_Volume.resize(Keep - 1);
+
+        m_LastBar = -1;
+        m_AggregateBars = 0;
+        return First;
+    }
+
+    float Step(const s_TimeframeBars& Bars, int BarIndex)
+    {
+        const long long Seconds = Bars.Seconds[BarIndex - Bars.SecondsFirst];
+        int Index = static_cast<int>(m_FirstBar.size()) - 1;
+
+        // The previous chart bar has closed: its final values go into its higher timeframe bar, and into the aggregate when the bar goes on.
+        if (m_LastBar >= 0 && BarIndex == m_LastBar + 1)
+        {
+            m_FastAggregate = Timeframe_Combine(Bars.FastRule, m_FastAggregate, m_AggregateBars, Bars.FastIn[m_LastBar]);
+            m_SlowAggregate = Timeframe_Combine(Bars.SlowRule, m_SlowAggregate, m_AggregateBars, Bars.SlowIn[m_LastBar]);
+
+            if (t_Average::UsesVolume)
+            {
+                m_VolumeAggregate = Timeframe_Combine(TIMEFRAME_SUM, m_VolumeAggregate, m_AggregateBars, Bars.Volume[m_LastBar]);
+                m_Volume[Index] = static_cast<float>(m_VolumeAggregate);
+            }
+
+            m_AggregateBars++;
+            m_FastIn[Index] = static_cast<float>(m_FastAggregate);
+            m_SlowIn[Index] = static_cast<float>(m_SlowAggregate);
+        }
+
+        // A new higher timeframe bar, also after a rewind. The kernels commit the one before when they see its index.
+        if (m_LastBar < 0 || Seconds < m_PeriodStart || Seconds >= m_PeriodStart + m_Seconds)
+        {
+            m_PeriodStart = (Seconds >= 0 ? Seconds : Seconds - m_Seconds + 1) / m_Seconds * m_Seconds;
+            m_FirstBar.push_back(BarIndex);
+            m_FastIn.push_back(0.0f);
+            m_SlowIn.push_back(0.0f);
+            m_FastOut.push_back(0.0f);
+            m_SlowOut.push_back(0.0f);
+
+            if (t_Average::UsesVolume)
+                m_Volume.push_back(0.0f);
+
+            m_AggregateBars = 0;
+            Index++;
+        }
+
+        m_LastBar = BarIndex;
+        m_FastIn[Index] = static_cast<float>(Timeframe_Combine(Bars.FastRule, m_FastAggregate, m_AggregateBars, Bars.FastIn[BarIndex]));
+        m_SlowIn[Index] = static_cast<float>(Timeframe_Combine(Bars.SlowRule, m_SlowAggregate, m_AggregateBars, Bars.SlowIn[BarIndex]));
+
+        if (t_Average::UsesVolume)
+            m_Volume[Index] = static_cast<float>(Timeframe_Combine(TIMEFRAME_SUM, m_VolumeAggregate, m_AggregateBars, Bars.Volume[BarIndex]));
+
+        const float* Slow_In = m_SharedInput ? &m_FastIn[0] : &m_SlowIn[0];
+        const float* Volume = t_Average::UsesVolume ? &m_Volume[0] : NULL;
+        m_Average.Update(&m_FastIn[0], Slow_In, Volume, &m_FastOut[0], &m_SlowOut[0], Index, m_FastLength, m_SlowLength);
+
+        if (Index < m_ReadyIndex)
+            return 0.0f;
+
+        const float Difference = m_FastOut[Index] - m_SlowOut[Index];
+        return Difference > 0.0f ? 1.0f : (Difference < 0.0f ? -1.0f : 0.0f);
+    }
+
+    long long m_Seconds;
+    int m_FastLength;
+    int m_SlowLength;
+    int m_ReadyIndex;
+    bool m_SharedInput;
+
+    // Per higher timeframe bar: the aggregated inputs, the averages, the summed volume when the average uses it, and the first chart bar.
+    std::vector<float> m_FastIn;
+    std::vector<float> m_SlowIn;
+    std::vector<float> m_FastOut;
+    std::vector<float> m_SlowOut;
+    std::vector<float> m_Volume;
+    std::vector<int> m_FirstBar;
+
+    // The forming higher timeframe bar: the start of its period in seconds, the last chart bar computed, and the aggregate of its closed chart bars before that one.
+    long long m_PeriodStart;
+    int m_LastBar;
+    double m_FastAggregate;
+    double m_SlowAggregate;
+    double m_VolumeAggregate;
+    int m_AggregateBars;
+
+    c_StudyArena m_Arena;
+    t_Average m_Average;
+};
+
+//================================================================================================//
+
+template <typename t_Average>
+class c_TimeframeConfirmation
+{
+public:
+    c_TimeframeConfirmation()
+        : m_LegCount(0)
+        , m_SecondsFirst(0)
+    {
+    }
+
+    // Sets up one leg per period in Minutes (Count of them, 0 for none) for a chart of ChartBars bars.
+    void Configure(const int* Minutes, int Count, int FastLength, int SlowLength, bool SharedInput, int ChartBars)
+    {
+        m_LegCount = Count < TIMEFRAME_MAX_LEGS ? Count : TIMEFRAME_MAX_LEGS;
+
+        for (int Leg = 0; Leg < m_LegCount; Leg++)
+            m_Legs[Leg].Configure(Minutes[Leg], FastLength, SlowLength, SharedInput);
+
+        if (m_LegCount > 0)
+            Reserve(ChartBars);
+    }
+
+    int LegCount() const
+    {
+        return m_LegCount;
+    }
+
+    // The chart bar an Update from First computes from, the earliest of the legs. Before First when a leg has to go back to the start of a higher timeframe bar.
+    int StartBar(int First) const
+    {
+        int Start = First;
+        for (int Leg = 0; Leg < m_LegCount; Leg++)
+        {
+            const int Leg_Start = m_Legs[Leg].StartBar(First);
+            Start = Leg_Start < Start ? Leg_Start : Start;
+        }
+
+        return Start;
+    }
+
+    // Room for the start times in seconds of chart bars Start (from StartBar) to End - 1, for the caller to fill before Update, Seconds[0] for bar Start.
+    long long* Seconds(int Start, int End)
+    {
+        if (static_cast<size_t>(End - Start) > m_Seconds.size())
+            Reserve(End - Start);
+
+        m_SecondsFirst = Start;
+        return &m_Seconds[0];
+    }
+
+    // Computes the trend of every leg for chart bars First to End - 1, Trend[Leg] for each. A full computation (First 0) of many bars runs the legs in parallel.
+    // Volume is the chart's volume, read only when the average uses it.
+    void Update(const float* FastIn, const float* SlowIn, const float* Volume, int FastRule, int SlowRule, int First, int End, float* const* Trend)
+    {
+        if (m_LegCount == 0 || End <= 0)
+            return;
+
+        s_TimeframeBars Bars;
+        Bars.FastIn = FastIn;
+        Bars.SlowIn = SlowIn;
+        Bars.Volume = Volume;
+        Bars.Seconds = &m_Seconds[0];
+        Bars.SecondsFirst = m_SecondsFirst;
+        Bars.FastRule = FastRule;
+        Bars.SlowRule = SlowRule;
+
+        if (First > 0 || m_LegCount == 1 || End - First < TIMEFRAME_PARALLEL_BARS)
+        {
+            for (int Leg = 0; Leg < m_LegCount; Leg++)
+                m_Legs[Leg].Update(Bars, First, End, Trend[Leg]);
+
+            return;
+        }
+
+        std::thread Threads[TIMEFRAME_MAX_LEGS];
+        for (int Leg = 1; Leg < m_LegCount; Leg++)
+            Threads[Leg] = std::thread(&c_TimeframeLeg<t_Average>::Update, &m_Legs[Leg], Bars, First, End, Trend[Leg]);
+
+        m_Legs[0].Update(Bars, First, End, Trend[0]);
+
+        for (int Leg = 1; Leg < m_LegCount; Leg++)
+            Threads[Leg].join();
+    }
+
+private:
+    c_TimeframeConfirmation(const c_TimeframeConfirmation&);
+    c_TimeframeConfirmation& operator=(const c_TimeframeConfirmation&);
+
+    void Reserve(int Bars)
+    {
+        m_Seconds.resize(static_cast<size_t>(Bars) + TIMEFRAME_HEADROOM_BARS);
+    }
+
+    int m_LegCount;
+    c_TimeframeLeg<t_Average> m_Legs[TIMEFRAME_MAX_LEGS];
+    std::vector<long long> m_Seconds;
+    int m_SecondsFirst;
+};
+
+#endif
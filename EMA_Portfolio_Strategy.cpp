@@ -0,0 +1,335 @@
+#include <vector>
+
+#include "sierrachart.h"
+#include "Crossover_Portfolio.h"
+#include "Study_Arena.h"
+
+SCDLLName("EMA Portfolio Crossover Strategy")
+
+/*
+This study runs the EMA crossover strategy for a list of charts from one study instance, instead of one EMA Crossover Strategy instance on each chart.
+
+Inputs:
+Faster / Slower EMA Period - the same averages as the EMA Crossover Strategy, on the close of each chart.
+Chart Numbers - the charts of the portfolio, like "2, 3, 5-9". Each chart is one symbol; open the charts in the same chartbook as the chart this study is on.
+Target and Stop Value in % of Entry - the bracket of each entry: a limit target and a trailing stop, offset from the close by this percentage of it. A percentage is used because the symbols of a portfolio have different tick sizes and prices.
+Maximum Open Positions - the portfolio-wide limit. A cross of a flat symbol does not enter while this many symbols hold a position. A reversal of an open position does not raise the count and is always taken.
+Main Logic:
+Every chart update, the close arrays of all the charts are read with sc.GetChartBaseData, and the new bars of every symbol go through one batched EMA update (c_PortfolioCrossovers in Crossover_Portfolio.h), which keeps the state of all the symbols side by side and steps them together.
+The last bar of each chart may still be forming, so only the bars before it are taken; a cross is acted on when the bar it happened on is the newest closed bar of its chart.
+When the study loads, or a chart is reloaded, the history is taken in to build the averages without trading.
+Orders are routed to each chart's symbol (sc.GetChartSymbol) with sc.BuyOrder and sc.SellOrder. An entry against an open position of that symbol first cancels the bracket it placed for it and closes the position with a market order.
+The position lookup (sc.GetTradePositionForSymbolAndAccount) only happens on a cross.
+The scratch arrays of a call come from an arena (Study_Arena.h) sized when the symbol list is built, so chart updates do not allocate.
+A cross that the position limit blocks is written to the message log.
+Additional Notes:
+sc.UpdateAlways is set so the study runs when other charts receive data while this one does not.
+Orders go to the simulation system unless sc.SendOrdersToTradeService is set.
+*/
+
+// Per chart of the portfolio.
+struct s_PortfolioSymbol
+{
+    int ChartNumber;
+    SCString Symbol;
+    int TargetOrderID;
+    int StopOrderID;
+
+    s_PortfolioSymbol()
+        : ChartNumber(0)
+        , TargetOrderID(0)
+        , StopOrderID(0)
+    {
+    }
+};
+
+struct s_PortfolioState
+{
+    std::vector<s_PortfolioSymbol> Symbols;
+    c_PortfolioCrossovers Crossovers;
+
+    // Scratch arrays of one call, one value per symbol, from Arena. Taken again whenever the symbol list is built.
+    c_StudyArena Arena;
+    const float** Close;
+    int* ClosedBars;
+    double* Value;
+    double* Active;
+    int* Cross;
+    char* Reloaded;
+
+    s_PortfolioState()
+        : Close(NULL)
+        , ClosedBars(NULL)
+        , Value(NULL)
+        , Active(NULL)
+        , Cross(NULL)
+        , Reloaded(NULL)
+    {
+    }
+
+    void Reserve(int Count)
+    {
+        Arena.Reset(c_StudyArena::SizeOf<const float*>(Count) + c_StudyArena::SizeOf<int>(Count) + c_StudyArena::SizeOf<double>(Count)
+            + c_StudyArena::SizeOf<double>(Count) + c_StudyArena::SizeOf<int>(Count) + c_StudyArena::SizeOf<char>(Count));
+
+        Close = Arena.Allocate<const float*>(Count);
+        ClosedBars = Arena.Allocate<int>(Count);
+        Value = Arena.Allocate<double>(Count);
+        Active = Arena.Allocate<double>(Count);
+        Cross = Arena.Allocate<int>(Count);
+        Reloaded = Arena.Allocate<char>(Count);
+
+        for (int SymbolIndex = 0; SymbolIndex < Count; SymbolIndex++)
+        {
+            Close[SymbolIndex] = NULL;
+            ClosedBars[SymbolIndex] = 0;
+            Value[SymbolIndex] = 0.0;
+            Active[SymbolIndex] = 0.0;
+            Cross[SymbolIndex] = 0;
+            Reloaded[SymbolIndex] = 0;
+        }
+    }
+
+private:
+    s_PortfolioState(const s_PortfolioState&);
+    s_PortfolioState& operator=(const s_PortfolioState&);
+};
+
+static int Portfolio_OpenPositions(SCStudyInterfaceRef sc, const s_PortfolioState& State)
+{
+    int Open = 0;
+
+    for (size_t SymbolIndex = 0; SymbolIndex < State.Symbols.size(); SymbolIndex++)
+    {
+        s_SCPositionData PositionData;
+        sc.GetTradePositionForSymbolAndAccount(PositionData, State.Symbols[SymbolIndex].Symbol, sc.SelectedTradeAccount);
+        Open += PositionData.PositionQuantity != 0;
+    }
+
+    return Open;
+}
+
+// Enters Cross (+1 long, -1 short) on the symbol, closing an opposite position first. Returns false when the portfolio limit blocks the entry.
+static bool Portfolio_Enter(SCStudyInterfaceRef sc, s_PortfolioState& State, int SymbolIndex, int Cross, float Price, float TargetPercent, float StopPercent, int MaxOpen)
+{
+    s_PortfolioSymbol& Symbol = State.Symbols[SymbolIndex];
+
+    s_SCPositionData PositionData;
+    sc.GetTradePositionForSymbolAndAccount(PositionData, Symbol.Symbol, sc.SelectedTradeAccount);
+
+    if ((Cross > 0 && PositionData.PositionQuantity > 0) || (Cross < 0 && PositionData.PositionQuantity < 0))
+        return true;
+
+    if (PositionData.PositionQuantity == 0 && Portfolio_OpenPositions(sc, State) >= MaxOpen)
+        return false;
+
+    if (PositionData.PositionQuantity != 0)
+    {
+        if (Symbol.TargetOrderID != 0)
+            sc.CancelOrder(Symbol.TargetOrderID);
+        if (Symbol.StopOrderID != 0)
+            sc.CancelOrder(Symbol.StopOrderID);
+
+        s_SCNewOrder ExitOrder;
+        ExitOrder.Symbol = Symbol.Symbol;
+        ExitOrder.TradeAccount = sc.SelectedTradeAccount;
+        ExitOrder.OrderQuantity = static_cast<int>(PositionData.PositionQuantity > 0 ? PositionData.PositionQuantity : -PositionData.PositionQuantity);
+        ExitOrder.OrderType = SCT_ORDERTYPE_MARKET;
+        ExitOrder.TimeInForce = SCT_TIF_GOOD_TILL_CANCELED;
+
+        if (PositionData.PositionQuantity > 0)
+            sc.SellOrder(ExitOrder);
+        else
+            sc.BuyOrder(ExitOrder);
+    }
+
+    s_SCNewOrder NewOrder;
+    NewOrder.Symbol = Symbol.Symbol;
+    NewOrder.TradeAccount = sc.SelectedTradeAccount;
+    NewOrder.OrderQuantity = 1;
+    NewOrder.OrderType = SCT_ORDERTYPE_MARKET;
+    NewOrder.TimeInForce = SCT_TIF_GOOD_TILL_CANCELED;
+    NewOrder.AttachedOrderTarget1Type = SCT_ORDERTYPE_LIMIT;
+    NewOrder.AttachedOrderStop1Type = SCT_ORDERTYPE_TRAILING_STOP;
+    NewOrder.Target1Offset = Price * TargetPercent / 100.0;
+    NewOrder.Stop1Offset = Price * StopPercent / 100.0;
+
+    const double Result = Cross > 0 ? sc.BuyOrder(NewOrder) : sc.SellOrder(NewOrder);
+
+    Symbol.TargetOrderID = Result > 0 ? NewOrder.Target1InternalOrderID : 0;
+    Symbol.StopOrderID = Result > 0 ? NewOrder.Stop1InternalOrderID : 0;
+
+    return true;
+}
+
+SCSFExport scsf_EMA_Portfolio_Crossover_Trading(SCStudyInterfaceRef sc)
+{
+    SCInputRef MA_Fast_Period = sc.Input[0];
+    SCInputRef MA_Slow_Period = sc.Input[1];
+    SCInputRef Chart_Numbers = sc.Input[2];
+    SCInputRef Target_Percent = sc.Input[3];
+    SCInputRef Stop_Percent = sc.Input[4];
+    SCInputRef Max_Open_Positions = sc.Input[5];
+
+    // Section 1 - Set the configuration variables and defaults
+    if (sc.SetDefaults)
+    {
+        sc.GraphName = "EMA Portfolio Crossover Strategy";
+
+        sc.AutoLoop = 0;
+        sc.GraphRegion = 1;
+        sc.UpdateAlways = 1;
+
+        MA_Fast_Period.Name = "Faster EMA Period";
+        MA_Fast_Period.SetInt(9);
+        MA_Fast_Period.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        MA_Slow_Period.Name = "Slower EMA Period";
+        MA_Slow_Period.SetInt(21);
+        MA_Slow_Period.SetIntLimits(1, MAX_STUDY_LENGTH);
+
+        Chart_Numbers.Name = "Chart Numbers (like 2, 3, 5-9)";
+        Chart_Numbers.SetString("");
+
+        Target_Percent.Name = "Target Value in % of Entry";
+        Target_Percent.SetFloat(0.5f);
+
+        Stop_Percent.Name = "Stop Value in % of Entry";
+        Stop_Percent.SetFloat(0.5f);
+
+        Max_Open_Positions.Name = "Maximum Open Positions";
+        Max_Open_Positions.SetInt(10);
+        Max_Open_Positions.SetIntLimits(1, 10000);
+
+        // This is false by default. Orders will go to the simulation system always.
+        sc.SendOrdersToTradeService = false;
+
+        sc.AllowMultipleEntriesInSameDirection = false;
+        sc.SupportReversals = false;
+        sc.SupportAttachedOrdersForTrading = false;
+        sc.CancelAllOrdersOnEntriesAndReversals = false;
+        sc.AllowEntryWithWorkingOrders = false;
+        sc.MaintainTradeStatisticsAndTradesData = true;
+
+        return;
+    }
+
+    // Persistent state for all the symbols
+    s_PortfolioState* p_State = static_cast<s_PortfolioState*>(sc.GetPersistentPointer(0));
+
+    if (sc.LastCallToFunction)
+    {
+        if (p_State != NULL)
+        {
+            delete p_State;
+            sc.SetPersistentPointer(0, NULL);
+        }
+
+        return;
+    }
+
+    // Section 2 - Build the symbol list when the study loads or its inputs change
+    bool Loading = false;
+
+    if (p_State == NULL || sc.IsFullRecalculation)
+    {
+        if (p_State == NULL)
+        {
+            p_State = new s_PortfolioState;
+            sc.SetPersistentPointer(0, p_State);
+        }
+
+        std::vector<int> Charts;
+        const char* Chart_List = Chart_Numbers.GetString();
+
+        if (Chart_List != NULL && Chart_List[0] != '\0' && !Portfolio_ParseCharts(Chart_List, Charts))
+            sc.AddMessageToLog("EMA Portfolio: the Chart Numbers input is not a list of chart numbers like \"2, 3, 5-9\".", 1);
+
+        const int Count = static_cast<int>(Charts.size());
+
+        p_State->Symbols.assign(Count, s_PortfolioSymbol());
+        for (int SymbolIndex = 0; SymbolIndex < Count; SymbolIndex++)
+        {
+            p_State->Symbols[SymbolIndex].ChartNumber = Charts[SymbolIndex];
+            p_State->Symbols[SymbolIndex].Symbol = sc.GetChartSymbol(Charts[SymbolIndex]);
+        }
+
+        p_State->Crossovers.Init(Count, MA_Fast_Period.GetInt(), MA_Slow_Period.GetInt());
+        p_State->Reserve(Count);
+
+        Loading = true;
+    }
+
+    s_PortfolioState& State = *p_State;
+    c_PortfolioCrossovers& Crossovers = State.Crossovers;
+    const int Symbol_Count = Crossovers.SymbolCount();
+
+    if (Symbol_Count == 0)
+        return;
+
+    // Section 3 - The closed bars of every chart. A chart with fewer bars than taken in was reloaded and starts over.
+    int Max_Pending = 0;
+
+    for (int SymbolIndex = 0; SymbolIndex < Symbol_Count; SymbolIndex++)
+    {
+        State.Reloaded[SymbolIndex] = 0;
+
+        SCGraphData BaseData;
+        sc.GetChartBaseData(State.Symbols[SymbolIndex].ChartNumber, BaseData);
+
+        SCFloatArrayRef Close = BaseData[SC_LAST];
+        const int Closed_Bars = Close.GetArraySize() - 1;
+
+        State.Close[SymbolIndex] = Closed_Bars > 0 ? &Close[0] : NULL;
+        State.ClosedBars[SymbolIndex] = Closed_Bars > 0 ? Closed_Bars : 0;
+
+        if (State.ClosedBars[SymbolIndex] < Crossovers.Bars(SymbolIndex))
+        {
+            Crossovers.ResetSymbol(SymbolIndex);
+            State.Reloaded[SymbolIndex] = 1;
+        }
+
+        const int Pending = State.ClosedBars[SymbolIndex] - Crossovers.Bars(SymbolIndex);
+        if (Pending > Max_Pending)
+            Max_Pending = Pending;
+    }
+
+    // Section 4 - Step all the symbols together, one bar of each per step, and trade the crosses of the newest closed bars
+    const int Max_Open = Max_Open_Positions.GetInt();
+    const float Target = Target_Percent.GetFloat();
+    const float Stop = Stop_Percent.GetFloat();
+
+    for (int Step = 0; Step < Max_Pending; Step++)
+    {
+        for (int SymbolIndex = 0; SymbolIndex < Symbol_Count; SymbolIndex++)
+        {
+            const int BarIndex = Crossovers.Bars(SymbolIndex);
+            const bool Active = BarIndex < State.ClosedBars[SymbolIndex];
+
+            State.Active[SymbolIndex] = Active ? 1.0 : 0.0;
+            State.Value[SymbolIndex] = Active ? State.Close[SymbolIndex][BarIndex] : 0.0;
+        }
+
+        Crossovers.Step(&State.Value[0], &State.Active[0], &State.Cross[0]);
+
+        for (int SymbolIndex = 0; SymbolIndex < Symbol_Count; SymbolIndex++)
+        {
+            if (State.Cross[SymbolIndex] == 0 || Loading || State.Reloaded[SymbolIndex])
+                continue;
+
+            // Only the newest closed bar trades; older bars were missed between updates.
+            const int BarIndex = Crossovers.Bars(SymbolIndex) - 1;
+            if (BarIndex != State.ClosedBars[SymbolIndex] - 1)
+                continue;
+
+            if (!Portfolio_Enter(sc, State, SymbolIndex, State.Cross[SymbolIndex], State.Close[SymbolIndex][BarIndex], Target, Stop, Max_Open))
+            {
+                SCString Message;
+                Message.Format("EMA Portfolio: %s %s cross not taken, the limit of %d open positions is reached.",
+                    State.Symbols[SymbolIndex].Symbol.GetChars(), State.Cross[SymbolIndex] > 0 ? "up" : "down", Max_Open);
+                sc.AddMessageToLog(Message, 0);
+            }
+        }
+    }
+}
+//================================================================================================//
@@ -0,0 +1,142 @@
+#ifndef BAR_FILE_H
+#define BAR_FILE_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+Bar data for the headless harness, loaded from a Sierra Chart text export (Edit >> Export Bar Data To Text File) or any CSV with the same columns:
+Date, Time, Open, High, Low, Last, Volume, NumberOfTrades, BidVolume, AskVolume
+The date is Y/M/D or Y-M-D, the time H:M:S with optional fractional seconds. A header line and any columns after Volume are optional.
+Date-times are stored as Sierra Chart date-time doubles (days since 1899-12-30).
+*/
+
+// Days from 1970-01-01 to Year-Month-Day in the proleptic Gregorian calendar.
+inline long Bar_DaysFromCivil(int Year, int Month, int Day)
+{
+    Year -= Month <= 2;
+    const long Era = (Year >= 0 ? Year : Year - 399) / 400;
+    const long YearOfEra = Year - Era * 400;
+    const long DayOfYear = (153 * (Month + (Month > 2 ? -3 : 9)) + 2) / 5 + Day - 1;
+    const long DayOfEra = YearOfEra * 365 + YearOfEra / 4 - YearOfEra / 100 + DayOfYear;
+    return Era * 146097 + DayOfEra - 719468;
+}
+
+inline double Bar_SCDateTime(int Year, int Month, int Day, int Hour, int Minute, double Second)
+{
+    const long SierraEpoch = Bar_DaysFromCivil(1899, 12, 30);
+    return static_cast<double>(Bar_DaysFromCivil(Year, Month, Day) - SierraEpoch) + (Hour * 3600.0 + Minute * 60.0 + Second) / 86400.0;
+}
+
+struct s_BarData
+{
+    std::vector<double> DateTime;
+    std::vector<float> Open;
+    std::vector<float> High;
+    std::vector<float> Low;
+    std::vector<float> Close;
+    std::vector<float> Volume;
+    std::vector<float> NumTrades;
+    std::vector<float> BidVolume;
+    std::vector<float> AskVolume;
+
+    int Count() const
+    {
+        return static_cast<int>(Close.size());
+    }
+
+    void Reserve(size_t Count)
+    {
+        DateTime.reserve(Count);
+        Open.reserve(Count);
+        High.reserve(Count);
+        Low.reserve(Count);
+        Close.reserve(Count);
+        Volume.reserve(Count);
+        NumTrades.reserve(Count);
+        BidVolume.reserve(Count);
+        AskVolume.reserve(Count);
+    }
+};
+
+// Parses one data line. Returns false for a header or malformed line.
+inline bool Bar_ParseLine(const char* Line, s_BarData& Bars)
+{
+    int Year = 0, Month = 0, Day = 0, Hour = 0, Minute = 0;
+    char DateSeparator = 0;
+    int Consumed = 0;
+
+    if (std::sscanf(Line, " %d%c%d%*c%d , %d:%d:%n", &Year, &DateSeparator, &Month, &Day, &Hour, &Minute, &Consumed) != 6 || Consumed == 0)
+        return false;
+
+    char* Position = NULL;
+    const double Second = std::strtod(Line + Consumed, &Position);
+
+    float Values[8] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+    int ValueCount = 0;
+
+    while (ValueCount < 8)
+    {
+        while (*Position == ',' || *Position == ' ' || *Position == '\t')
+            Position++;
+
+        char* End = NULL;
+        const double Value = std::strtod(Position, &End);
+        if (End == Position)
+            break;
+
+        Values[ValueCount++] = static_cast<float>(Value);
+        Position = End;
+    }
+
+    if (ValueCount < 4)
+        return false;
+
+    Bars.DateTime.push_back(Bar_SCDateTime(Year, Month, Day, Hour, Minute, Second));
+    Bars.Open.push_back(Values[0]);
+    Bars.High.push_back(Values[1]);
+    Bars.Low.push_back(Values[2]);
+    Bars.Close.push_back(Values[3]);
+    Bars.Volume.push_back(Values[4]);
+    Bars.NumTrades.push_back(Values[5]);
+    Bars.BidVolume.push_back(Values[6]);
+    Bars.AskVolume.push_back(Values[7]);
+    return true;
+}
+
+// Loads a bar file. Returns false when the file cannot be opened or has no bars.
+inline bool Bar_LoadTextFile(const char* Path, s_BarData& Bars, std::string& Error)
+{
+    FILE* File = std::fopen(Path, "r");
+    if (File == NULL)
+    {
+        Error = std::string("cannot open ") + Path;
+        return false;
+    }
+
+    char Line[512];
+    int LineNumber = 0;
+
+    while (std::fgets(Line, sizeof(Line), File) != NULL)
+    {
+        LineNumber++;
+
+        if (!Bar_ParseLine(Line, Bars) && LineNumber > 1 && Line[0] != '\n' && Line[0] != '\r')
+            std::fprintf(stderr, "%s: skipped malformed line %d\n", Path, LineNumber);
+    }
+
+    std::fclose(File);
+
+    if (Bars.Count() == 0)
+    {
+        Error = std::string("no bars in ") + Path;
+        return false;
+    }
+
+    return true;
+}
+
+#endif
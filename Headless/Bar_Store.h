@@ -0,0 +1,288 @@
+#ifndef BAR_STORE_H
+#define BAR_STORE_H
+
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "sierrachart.h"
+#include "Bar_File.h"
+#include "Scid_File.h"
+
+/*
+Columnar bar store for the headless harness.
+
+Each sc.BaseDataIn field is one contiguous float column (and sc.BaseDateTimeIn one SCDateTime column), allocated on a 64 byte boundary and padded with zeros to a whole number of cache lines, so the MA kernels read dense cache lines and the SIMD kernels can use aligned loads without a tail check.
+Columns are built lazily, per field, the first time they are asked for:
+From a .scid file (one bar per record), a field is transposed straight from the mapped records, so fields the study never reads are never touched.
+From loaded bars (s_BarData, a text export or time bars built from a .scid file), a field is copied once into its aligned column.
+SC_OHLC_AVG, SC_HLC_AVG and SC_HL_AVG are computed from the price columns when asked for.
+A built column never moves and is read-only afterwards, so any number of runs and threads can view it. Building is serialized by a lock; the first run pays for it.
+*/
+
+const int BAR_STORE_ALIGNMENT = 64;
+
+class c_BarStore
+{
+public:
+    c_BarStore()
+        : m_Bars(NULL)
+        , m_Scid(NULL)
+        , m_First(0)
+        , m_Count(0)
+        , m_DateTime(NULL)
+    {
+        std::memset(m_Columns, 0, sizeof(m_Columns));
+    }
+
+    ~c_BarStore()
+    {
+        Clear();
+    }
+
+    // Bars is used in place and must outlive the store.
+    void SetSource(const s_BarData& Bars)
+    {
+        Clear();
+        m_Bars = &Bars;
+        m_Count = Bars.Count();
+    }
+
+    // One bar per record of [First, First + Count). The file must stay open while the store is used.
+    void SetSource(const c_ScidFile& File, int First = 0, int Count = -1)
+    {
+        Clear();
+
+        if (First < 0)
+            First = 0;
+        if (Count < 0 || First + Count > File.RecordCount())
+            Count = File.RecordCount() - First;
+
+        m_Scid = &File;
+        m_First = First;
+        m_Count = Count > 0 ? Count : 0;
+    }
+
+    int Count() const
+    {
+        return m_Count;
+    }
+
+    // The field's column with at least Count() values (SC_OPEN to SC_ASKVOL). NULL for an unknown field or an empty store.
+    const float* Column(int Field)
+    {
+        if (Field < 0 || Field >= SC_BASE_DATA_ARRAYS || m_Count == 0)
+            return NULL;
+
+        std::lock_guard<std::mutex> Guard(m_Lock);
+
+        if (m_Columns[Field] == NULL)
+            m_Columns[Field] = BuildColumn(Field);
+
+        return m_Columns[Field];
+    }
+
+    // Only the columns built so far, without building any.
+    const float* BuiltColumn(int Field)
+    {
+        if (Field < 0 || Field >= SC_BASE_DATA_ARRAYS)
+            return NULL;
+
+        std::lock_guard<std::mutex> Guard(m_Lock);
+        return m_Columns[Field];
+    }
+
+    const SCDateTime* DateTime()
+    {
+        if (m_Count == 0)
+            return NULL;
+
+        std::lock_guard<std::mutex> Guard(m_Lock);
+
+        if (m_DateTime == NULL)
+        {
+            m_DateTime = Allocate<SCDateTime>();
+
+            if (m_Scid != NULL)
+            {
+                for (int Index = 0; Index < m_Count; Index++)
+                    m_DateTime[Index] = SCDateTime(m_Scid->DateTime(m_First + Index));
+            }
+            else
+            {
+                for (int Index = 0; Index < m_Count; Index++)
+                    m_DateTime[Index] = SCDateTime(m_Bars->DateTime[Index]);
+            }
+        }
+
+        return m_DateTime;
+    }
+
+    // Builds every column now, for callers that do not know which fields they will read.
+    void BuildAll()
+    {
+        for (int Field = 0; Field < SC_BASE_DATA_ARRAYS; Field++)
+            Column(Field);
+
+        DateTime();
+    }
+
+private:
+    c_BarStore(const c_BarStore&);
+    c_BarStore& operator=(const c_BarStore&);
+
+    void Clear()
+    {
+        for (int Field = 0; Field < SC_BASE_DATA_ARRAYS; Field++)
+        {
+            Free(m_Columns[Field]);
+            m_Columns[Field] = NULL;
+        }
+
+        Free(m_DateTime);
+        m_DateTime = NULL;
+
+        m_Bars = NULL;
+        m_Scid = NULL;
+        m_First = 0;
+        m_Count = 0;
+    }
+
+    // Count() elements rounded up to a whole number of cache lines, zeroed.
+    template <typename T>
+    T* Allocate() const
+    {
+        const size_t Bytes = (m_Count * sizeof(T) + BAR_STORE_ALIGNMENT - 1) / BAR_STORE_ALIGNMENT * BAR_STORE_ALIGNMENT;
+
+        void* Memory = NULL;
+        if (posix_memalign(&Memory, BAR_STORE_ALIGNMENT, Bytes) != 0)
+            return NULL;
+
+        std::memset(Memory, 0, Bytes);
+        return static_cast<T*>(Memory);
+    }
+
+    static void Free(void* Memory)
+    {
+        std::free(Memory);
+    }
+
+    // Called with the lock held. The average fields build on the price columns.
+    float* BuildColumn(int Field)
+    {
+        float* Values = Allocate<float>();
+        if (Values == NULL)
+            return NULL;
+
+        if (Field == SC_OHLC_AVG || Field == SC_HLC_AVG || Field == SC_HL_AVG)
+        {
+            const float* Open = Field == SC_OHLC_AVG ? Price(SC_OPEN) : NULL;
+            const float* High = Price(SC_HIGH);
+            const float* Low = Price(SC_LOW);
+            const float* Close = Field != SC_HL_AVG ? Price(SC_LAST) : NULL;
+
+            for (int Index = 0; Index < m_Count; Index++)
+            {
+                if (Field == SC_OHLC_AVG)
+                    Values[Index] = (Open[Index] + High[Index] + Low[Index] + Close[Index]) * 0.25f;
+                else if (Field == SC_HLC_AVG)
+                    Values[Index] = (High[Index] + Low[Index] + Close[Index]) / 3.0f;
+                else
+                    Values[Index] = (High[Index] + Low[Index]) * 0.5f;
+            }
+
+            return Values;
+        }
+
+        if (m_Scid != NULL)
+            TransposeScid(Field, Values);
+        else
+            CopyBars(Field, Values);
+
+        return Values;
+    }
+
+    const float* Price(int Field)
+    {
+        if (m_Columns[Field] == NULL)
+            m_Columns[Field] = BuildColumn(Field);
+
+        return m_Columns[Field];
+    }
+
+    void CopyBars(int Field, float* Values) const
+    {
+        const std::vector<float>* Source = NULL;
+
+        switch (Field)
+        {
+            case SC_OPEN: Source = &m_Bars->Open; break;
+            case SC_HIGH: Source = &m_Bars->High; break;
+            case SC_LOW: Source = &m_Bars->Low; break;
+            case SC_LAST: Source = &m_Bars->Close; break;
+            case SC_VOLUME: Source = &m_Bars->Volume; break;
+            case SC_NUM_TRADES: Source = &m_Bars->NumTrades; break;
+            case SC_BIDVOL: Source = &m_Bars->BidVolume; break;
+            case SC_ASKVOL: Source = &m_Bars->AskVolume; break;
+        }
+
+        if (Source != NULL && !Source->empty())
+            std::memcpy(Values, &(*Source)[0], m_Count * sizeof(float));
+    }
+
+    // Same single trade rule as Scid_ReadBars: the trade price stands in for the open, high and low.
+    void TransposeScid(int Field, float* Values) const
+    {
+        const c_ScidFile& File = *m_Scid;
+        const int First = m_First;
+
+        switch (Field)
+        {
+            case SC_OPEN:
+            case SC_HIGH:
+            case SC_LOW:
+            {
+                const s_ScidColumn<float> Open = File.OpenColumn();
+                const s_ScidColumn<float> Close = File.CloseColumn();
+                const s_ScidColumn<float> Source = Field == SC_OPEN ? Open : (Field == SC_HIGH ? File.HighColumn() : File.LowColumn());
+
+                for (int Index = 0; Index < m_Count; Index++)
+                    Values[Index] = Scid_IsSingleTrade(Open[First + Index]) ? Close[First + Index] : Source[First + Index];
+            }
+            break;
+
+            case SC_LAST:
+            {
+                const s_ScidColumn<float> Close = File.CloseColumn();
+                for (int Index = 0; Index < m_Count; Index++)
+                    Values[Index] = Close[First + Index];
+            }
+            break;
+
+            case SC_VOLUME:
+            case SC_NUM_TRADES:
+            case SC_BIDVOL:
+            case SC_ASKVOL:
+            {
+                const s_ScidColumn<unsigned int> Source = Field == SC_VOLUME ? File.VolumeColumn()
+                    : (Field == SC_NUM_TRADES ? File.NumTradesColumn() : (Field == SC_BIDVOL ? File.BidVolumeColumn() : File.AskVolumeColumn()));
+
+                for (int Index = 0; Index < m_Count; Index++)
+                    Values[Index] = static_cast<float>(Source[First + Index]);
+            }
+            break;
+        }
+    }
+
+    const s_BarData* m_Bars;
+    const c_ScidFile* m_Scid;
+    int m_First;
+    int m_Count;
+
+    std::mutex m_Lock;
+    float* m_Columns[SC_BASE_DATA_ARRAYS];
+    SCDateTime* m_DateTime;
+};
+
+#endif
@@ -0,0 +1,360 @@
+// With STUDY_ALLOCATION_COUNTER, this program defines the counting operator new (Study_Arena.h).
+#define STUDY_ALLOCATION_COUNTER_OPERATORS 1
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sierrachart.h"
+#include "Headless_Host.h"
+#include "Scid_File.h"
+#include "Signal_Backtest.h"
+#include "../Crossover_Engine.h"
+#include "../Crossover_Sweep.h"
+
+/*
+Command line backtester for the crossover studies.
+
+The study files in the repository root are compiled unchanged against the headless sierrachart.h in this folder and linked into this program (see README.md here for the build command).
+Each run is one study instance replayed over the bar file by c_HeadlessChart. Runs are independent and are spread over --threads worker threads; they share one copy of the bar data.
+One line of comma separated results per run is written to standard output, in the order of the runs.
+--mode signals backtests a crossover study from its cross index instead (c_SignalBacktest, Signal_Backtest.h): the same trades, at a cost that grows with the number of trades and the bars spent in them rather than with every bar.
+
+crossover_backtest --study sma|ema|ema9_21|zlema|hull|hull16_64|kama|alma|t3|vwma|sweep --bars FILE [options]
+--bars FILE            a bar text export, or a Sierra Chart intraday data file (.scid) read through a memory map
+--bar-seconds N        for a .scid file, builds N second bars from the records (default 0, one bar per record)
+--symbol NAME          sc.Symbol (default HEADLESS)
+--tick-size VALUE      sc.TickSize (default 0.25)
+--input N=VALUE        sets study input N, as in the Study Settings window (repeatable)
+--pairs F/S,F/S,...    one run per pair, setting inputs 0 and 1 (the faster and slower periods of the crossover studies, not of the fixed-period ones)
+--mode replay|recalculate|signals
+--threads N            worker threads for the runs (default 1, 0 = one per hardware thread)
+--quiet                drops the studies' message log output
+*/
+
+SCSFExport scsf_SMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_EMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_EMA_9_21_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_ZLEMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Hull_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Hull_16_64_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_KAMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_ALMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_T3_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_VWMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Crossover_Sweep(SCStudyInterfaceRef sc);
+
+struct s_StudyEntry
+{
+    const char* Name;
+    SCStudyFunction Function;
+    int DefaultMode;
+    int SignalType;
+    // The study reads fields other than its inputs' (c_HeadlessChart::SetBuildAllColumns).
+    bool AllColumns;
+    // The periods are compiled in (FixedFastLength, FixedSlowLength), so inputs 0 and 1 cannot be set.
+    bool FixedPeriods;
+};
+
+static const s_StudyEntry s_Studies[] =
+{
+    { "sma", scsf_SMA_Crossover_Trading, HEADLESS_MODE_REPLAY, SWEEP_MA_SMA, false, false },
+    { "ema", scsf_EMA_Crossover_Trading, HEADLESS_MODE_REPLAY, SWEEP_MA_EMA, false, false },
+    { "ema9_21", scsf_EMA_9_21_Crossover_Trading, HEADLESS_MODE_REPLAY, SWEEP_MA_EMA, false, true },
+    { "zlema", scsf_ZLEMA_Crossover_Trading, HEADLESS_MODE_REPLAY, SWEEP_MA_ZLEMA, false, false },
+    { "hull", scsf_Hull_Crossover_Trading, HEADLESS_MODE_REPLAY, SWEEP_MA_HULL, false, false },
+    { "hull16_64", scsf_Hull_16_64_Crossover_Trading, HEADLESS_MODE_REPLAY, SWEEP_MA_HULL, false, true },
+    { "kama", scsf_KAMA_Crossover_Trading, HEADLESS_MODE_REPLAY, -1, false, false },
+    { "alma", scsf_ALMA_Crossover_Trading, HEADLESS_MODE_REPLAY, -1, false, false },
+    { "t3", scsf_T3_Crossover_Trading, HEADLESS_MODE_REPLAY, -1, false, false },
+    { "vwma", scsf_VWMA_Crossover_Trading, HEADLESS_MODE_REPLAY, -1, true, false },
+    { "sweep", scsf_Crossover_Sweep, HEADLESS_MODE_RECALCULATE, -1, false, false },
+};
+
+struct s_BacktestRun
+{
+    std::vector<s_HeadlessInput> Inputs;
+    s_HeadlessResult Result;
+};
+
+static void PrintUsage()
+{
+    std::fprintf(stderr,
+        "usage: crossover_backtest --study sma|ema|ema9_21|zlema|hull|hull16_64|kama|alma|t3|vwma|sweep --bars FILE\n"
+        "    [--bar-seconds N] [--symbol NAME] [--tick-size VALUE] [--input N=VALUE]... [--pairs F/S,F/S,...]\n"
+        "    [--mode replay|recalculate|signals] [--threads N] [--quiet]\n");
+}
+
+static bool ParseInput(const char* Text, s_HeadlessInput& Input)
+{
+    const char* Equals = std::strchr(Text, '=');
+    if (Equals == NULL || Equals == Text)
+        return false;
+
+    Input.Index = std::atoi(Text);
+    Input.Text = Equals + 1;
+    return Input.Index >= 0 && Input.Index < SC_INPUTS_AVAILABLE;
+}
+
+static std::string FormatInputs(const std::vector<s_HeadlessInput>& Inputs)
+{
+    std::string Text;
+
+    for (size_t InputIndex = 0; InputIndex < Inputs.size(); InputIndex++)
+    {
+        char Buffer[32];
+        std::snprintf(Buffer, sizeof(Buffer), "%s%d=", InputIndex > 0 ? ";" : "", Inputs[InputIndex].Index);
+        Text += Buffer;
+        Text += Inputs[InputIndex].Text;
+    }
+
+    return Text;
+}
+
+int main(int argc, char** argv)
+{
+    const s_StudyEntry* Study = NULL;
+    const char* Bars_Path = NULL;
+    const char* Symbol = "HEADLESS";
+    float Tick_Size = 0.25f;
+    int Mode = -1;
+    int Thread_Count = 1;
+    int Bar_Seconds = 0;
+    bool Quiet = false;
+    std::vector<s_HeadlessInput> Base_Inputs;
+    std::vector<s_SweepPair> Pairs;
+
+    for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++)
+    {
+        const char* Argument = argv[ArgumentIndex];
+        const char* Value = ArgumentIndex + 1 < argc ? argv[ArgumentIndex + 1] : NULL;
+
+        if (std::strcmp(Argument, "--quiet") == 0)
+        {
+            Quiet = true;
+            continue;
+        }
+
+        if (Value == NULL)
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        ArgumentIndex++;
+
+        if (std::strcmp(Argument, "--study") == 0)
+        {
+            for (size_t StudyIndex = 0; StudyIndex < sizeof(s_Studies) / sizeof(s_Studies[0]); StudyIndex++)
+            {
+                if (std::strcmp(Value, s_Studies[StudyIndex].Name) == 0)
+                    Study = &s_Studies[StudyIndex];
+            }
+
+            if (Study == NULL)
+            {
+                std::fprintf(stderr, "unknown study %s\n", Value);
+                return 2;
+            }
+        }
+        else if (std::strcmp(Argument, "--bars") == 0)
+            Bars_Path = Value;
+        else if (std::strcmp(Argument, "--symbol") == 0)
+            Symbol = Value;
+        else if (std::strcmp(Argument, "--tick-size") == 0)
+            Tick_Size = static_cast<float>(std::atof(Value));
+        else if (std::strcmp(Argument, "--bar-seconds") == 0)
+            Bar_Seconds = std::atoi(Value);
+        else if (std::strcmp(Argument, "--threads") == 0)
+            Thread_Count = std::atoi(Value);
+        else if (std::strcmp(Argument, "--mode") == 0)
+        {
+            if (std::strcmp(Value, "replay") == 0)
+                Mode = HEADLESS_MODE_REPLAY;
+            else if (std::strcmp(Value, "recalculate") == 0)
+                Mode = HEADLESS_MODE_RECALCULATE;
+            else if (std::strcmp(Value, "signals") == 0)
+                Mode = HEADLESS_MODE_SIGNALS;
+            else
+            {
+                PrintUsage();
+                return 2;
+            }
+        }
+        else if (std::strcmp(Argument, "--input") == 0)
+        {
+            s_HeadlessInput Input;
+            if (!ParseInput(Value, Input))
+            {
+                std::fprintf(stderr, "bad input %s, expected N=VALUE\n", Value);
+                return 2;
+            }
+
+            Base_Inputs.push_back(Input);
+        }
+        else if (std::strcmp(Argument, "--pairs") == 0)
+        {
+            if (!Sweep_ParsePairs(Value, Pairs))
+            {
+                std::fprintf(stderr, "bad pairs %s, expected F/S,F/S,...\n", Value);
+                return 2;
+            }
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (Study == NULL || Bars_Path == NULL)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    if (Study->FixedPeriods)
+    {
+        bool Sets_Periods = !Pairs.empty();
+        for (size_t InputIndex = 0; InputIndex < Base_Inputs.size(); InputIndex++)
+            Sets_Periods = Sets_Periods || Base_Inputs[InputIndex].Index <= 1;
+
+        if (Sets_Periods)
+        {
+            std::fprintf(stderr, "%s has fixed periods; --pairs and --input 0 or 1 do not apply to it\n", Study->Name);
+            return 2;
+        }
+    }
+
+    if (Mode < 0)
+        Mode = Study->DefaultMode;
+
+    if (Mode == HEADLESS_MODE_SIGNALS && Study->SignalType < 0)
+    {
+        std::fprintf(stderr, "--mode signals needs an SMA, EMA, ZLEMA or Hull crossover study\n");
+        return 2;
+    }
+
+    s_BarData Bars;
+    std::string Error;
+
+    // One bar per .scid record is transposed from the mapping into the store without an intermediate copy.
+    c_ScidFile File;
+    c_BarStore Store;
+
+    const size_t Path_Length = std::strlen(Bars_Path);
+    if (Path_Length > 5 && std::strcmp(Bars_Path + Path_Length - 5, ".scid") == 0)
+    {
+        if (!File.Open(Bars_Path, Error))
+        {
+            std::fprintf(stderr, "%s\n", Error.c_str());
+            return 1;
+        }
+
+        if (Bar_Seconds > 0)
+        {
+            Scid_ReadBars(File, 0, -1, Bar_Seconds, Bars);
+            Store.SetSource(Bars);
+        }
+        else
+            Store.SetSource(File);
+
+        if (Store.Count() == 0)
+        {
+            std::fprintf(stderr, "no records in %s\n", Bars_Path);
+            return 1;
+        }
+    }
+    else if (Bar_LoadTextFile(Bars_Path, Bars, Error))
+    {
+        Store.SetSource(Bars);
+    }
+    else
+    {
+        std::fprintf(stderr, "%s\n", Error.c_str());
+        return 1;
+    }
+
+    // One run per pair, or a single run with the base inputs.
+    std::vector<s_BacktestRun> Runs(Pairs.empty() ? 1 : Pairs.size());
+    for (size_t RunIndex = 0; RunIndex < Runs.size(); RunIndex++)
+    {
+        Runs[RunIndex].Inputs = Base_Inputs;
+
+        if (!Pairs.empty())
+        {
+            char Period[16];
+            s_HeadlessInput Input;
+
+            std::snprintf(Period, sizeof(Period), "%d", Pairs[RunIndex].FastPeriod);
+            Input.Index = 0;
+            Input.Text = Period;
+            Runs[RunIndex].Inputs.push_back(Input);
+
+            std::snprintf(Period, sizeof(Period), "%d", Pairs[RunIndex].SlowPeriod);
+            Input.Index = 1;
+            Input.Text = Period;
+            Runs[RunIndex].Inputs.push_back(Input);
+        }
+    }
+
+    c_HeadlessChart Chart(Store, Symbol, Tick_Size);
+    Chart.SetLogMessages(!Quiet);
+    Chart.SetBuildAllColumns(Study->AllColumns);
+
+    if (Thread_Count <= 0)
+        Thread_Count = static_cast<int>(std::thread::hardware_concurrency());
+    if (Thread_Count < 1)
+        Thread_Count = 1;
+    if (Thread_Count > static_cast<int>(Runs.size()))
+        Thread_Count = static_cast<int>(Runs.size());
+
+    const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+    std::atomic<size_t> Next_Run(0);
+    std::vector<std::thread> Threads;
+
+    for (int ThreadIndex = 0; ThreadIndex < Thread_Count; ThreadIndex++)
+    {
+        Threads.push_back(std::thread([&]()
+        {
+            c_SignalBacktest Signals;
+
+            for (size_t RunIndex = Next_Run++; RunIndex < Runs.size(); RunIndex = Next_Run++)
+            {
+                if (Mode == HEADLESS_MODE_SIGNALS)
+                    Signals.Run(Store, Signal_StudySettings(Study->Function, Study->SignalType, Runs[RunIndex].Inputs, Tick_Size), Runs[RunIndex].Result);
+                else
+                    Chart.Run(Study->Function, Runs[RunIndex].Inputs, Mode, static_cast<int>(RunIndex) + 1, Runs[RunIndex].Result);
+            }
+        }));
+    }
+
+    for (size_t ThreadIndex = 0; ThreadIndex < Threads.size(); ThreadIndex++)
+        Threads[ThreadIndex].join();
+
+    const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+    std::printf("Study,Inputs,Trades,Wins,NetProfit,GrossProfit,GrossLoss,MaxDrawdown,ProfitFactor,Sharpe,OpenPosition\n");
+
+    for (size_t RunIndex = 0; RunIndex < Runs.size(); RunIndex++)
+    {
+        const s_TradeStats& Stats = Runs[RunIndex].Result.Stats;
+
+        std::printf("%s,\"%s\",%d,%d,%.6f,%.6f,%.6f,%.6f,%.4f,%.4f,%d\n",
+            Study->Name, FormatInputs(Runs[RunIndex].Inputs).c_str(), Stats.Trades, Stats.Wins,
+            Stats.NetProfit, Stats.GrossProfit, Stats.GrossLoss, Stats.MaxDrawdown, Stats.ProfitFactor(), Stats.Sharpe(),
+            Runs[RunIndex].Result.OpenDirection);
+    }
+
+    std::fprintf(stderr, "%d runs over %d bars in %.3f s (%.1f M bars/s) on %d threads\n",
+        static_cast<int>(Runs.size()), Store.Count(), Seconds,
+        Seconds > 0.0 ? Runs.size() * static_cast<double>(Store.Count()) / Seconds / 1e6 : 0.0, Thread_Count);
+
+    return 0;
+}
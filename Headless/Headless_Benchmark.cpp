@@ -0,0 +1,500 @@
+// With STUDY_ALLOCATION_COUNTER, this program defines the counting operator new (Study_Arena.h).
+#define STUDY_ALLOCATION_COUNTER_OPERATORS 1
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sierrachart.h"
+#include "Headless_Host.h"
+#include "Signal_Backtest.h"
+#include "../Crossover_Index.h"
+#include "../MA_Kernels.h"
+#include "../MA_Batch_Kernels.h"
+
+/*
+Benchmarks of the moving average kernels and the crossover studies, written as JSON for tracking between releases.
+
+Every case runs --repetitions times on the same synthetic random walk bars; the best and the median time per item are reported (an item is one bar, or one tick for the tick cases).
+batch - the full-history recalculation kernels of MA_Batch_Kernels.h (AVX2 when the CPU has it) at periods 9, 50, 200, 1000 over --bars and --large-bars bars.
+batch_scalar - the same kernels forced to the scalar path, over --bars bars, for the AVX2 speedup.
+bar - the incremental kernels of MA_Kernels.h, one Update per new bar (the commit path), over --bars bars.
+tick - the incremental kernels updating the live bar, one Update per tick at the same index (the s_LiveLine path).
+cross - Crossover_BuildIndex over two batch EMAs (9 and 21) of --bars bars, the cross index of the backtester's signal mode.
+study - the crossover strategies replayed bar by bar through c_HeadlessChart, including cross detection and the simulated order and bracket path, and the sweep study's single recalculation. study/.../signals is the same backtest from the cross index (c_SignalBacktest). study/EMA_9_21 and study/HMA_16_64 are the fixed-period variants, the latter against study/HMA_16_64_inputs, the configurable study at 16/64.
+No benchmark library is needed; the timings use std::chrono::steady_clock and a checksum of the outputs keeps the compiler from dropping the work.
+
+crossover_benchmark [options] > results.json
+--bars N          bars of the batch, bar and study cases (default 1000000)
+--large-bars N    bars of the second batch size (default 10000000, 0 skips it)
+--ticks N         ticks of the tick cases (default 1000000)
+--repetitions N   timed runs per case (default 5)
+--filter TEXT     only the cases whose name contains TEXT
+*/
+
+SCSFExport scsf_SMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_EMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_EMA_9_21_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_ZLEMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Hull_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Hull_16_64_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Crossover_Sweep(SCStudyInterfaceRef sc);
+
+enum e_BenchmarkMA
+{
+    BENCHMARK_MA_SMA = 0,
+    BENCHMARK_MA_EMA = 1,
+    BENCHMARK_MA_ZLEMA = 2,
+    BENCHMARK_MA_HMA = 3,
+    BENCHMARK_MA_COUNT = 4
+};
+
+static const char* const s_MALabels[BENCHMARK_MA_COUNT] = { "SMA", "EMA", "ZLEMA", "HMA" };
+static const int s_Periods[] = { 9, 50, 200, 1000 };
+
+struct s_BenchmarkResult
+{
+    std::string Name;
+    std::string Group;
+    std::string MA;
+    int Period;
+    long long Items;
+    double BestNanoseconds;
+    double MedianNanoseconds;
+};
+
+struct s_BenchmarkOptions
+{
+    int Bars;
+    int LargeBars;
+    int Ticks;
+    int Repetitions;
+    std::string Filter;
+
+    s_BenchmarkOptions()
+        : Bars(1000000)
+        , LargeBars(10000000)
+        , Ticks(1000000)
+        , Repetitions(5)
+    {
+    }
+};
+
+// Kept in a volatile so the outputs of every case are used.
+static volatile double s_Checksum = 0.0;
+
+static void Benchmark_RandomWalk(std::vector<float>& Close, std::vector<float>& High, std::vector<float>& Low, int Count)
+{
+    Close.resize(Count);
+    High.resize(Count);
+    Low.resize(Count);
+
+    unsigned int State = 12345u;
+    double Price = 4000.0;
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        State = State * 1664525u + 1013904223u;
+        Price += (static_cast<int>(State >> 24) % 9 - 4) * 0.25;
+        if (Price < 100.0)
+            Price = 100.0;
+
+        Close[Index] = static_cast<float>(Price);
+        High[Index] = static_cast<float>(Price + ((State >> 8) & 3) * 0.25);
+        Low[Index] = static_cast<float>(Price - ((State >> 12) & 3) * 0.25);
+    }
+}
+
+static bool Benchmark_Selected(const s_BenchmarkOptions& Options, const std::string& Name)
+{
+    return Options.Filter.empty() || Name.find(Options.Filter) != std::string::npos;
+}
+
+// Times Function (which does Items items of work) Options.Repetitions times.
+template <typename FunctionType>
+static void Benchmark_Run(const s_BenchmarkOptions& Options, std::vector<s_BenchmarkResult>& Results,
+    const std::string& Name, const char* Group, const char* MA, int Period, long long Items, FunctionType Function)
+{
+    if (!Benchmark_Selected(Options, Name) || Items <= 0)
+        return;
+
+    std::vector<double> Nanoseconds;
+
+    for (int Repetition = 0; Repetition < Options.Repetitions; Repetition++)
+    {
+        const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+        Function();
+        const double Elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+        Nanoseconds.push_back(Elapsed / Items);
+    }
+
+    std::sort(Nanoseconds.begin(), Nanoseconds.end());
+
+    s_BenchmarkResult Result;
+    Result.Name = Name;
+    Result.Group = Group;
+    Result.MA = MA;
+    Result.Period = Period;
+    Result.Items = Items;
+    Result.BestNanoseconds = Nanoseconds.front();
+    Result.MedianNanoseconds = Nanoseconds[Nanoseconds.size() / 2];
+    Results.push_back(Result);
+
+    std::fprintf(stderr, "%-32s %10.3f ns/item\n", Name.c_str(), Result.MedianNanoseconds);
+}
+
+static void Benchmark_Batch(int MA, const float* In, float* Out, float* Diff, int Count, int Period, bool Scalar)
+{
+    switch (MA)
+    {
+        case BENCHMARK_MA_SMA:
+            Scalar ? MA_Batch_SMA_Scalar(In, Out, Count, Period) : MA_Batch_SMA(In, Out, Count, Period);
+            break;
+
+        case BENCHMARK_MA_EMA:
+            Scalar ? MA_Batch_EMA_Scalar(In, Out, Count, Period) : MA_Batch_EMA(In, Out, Count, Period);
+            break;
+
+        case BENCHMARK_MA_ZLEMA:
+            Scalar ? MA_Batch_ZLEMA_Scalar(In, Out, Count, Period) : MA_Batch_ZLEMA(In, Out, Count, Period);
+            break;
+
+        case BENCHMARK_MA_HMA:
+            Scalar ? MA_Batch_HMA_Scalar(In, Out, Diff, Count, Period) : MA_Batch_HMA(In, Out, Diff, Count, Period);
+            break;
+    }
+
+    s_Checksum += Out[Count - 1];
+}
+
+static float Kernel_Update(s_SMAKernel& Kernel, const float* In, const float*, int Index, int Period)
+{
+    return Kernel.Update(In, Index, Period);
+}
+
+static float Kernel_Update(s_EMAKernel& Kernel, const float* In, const float* Out, int Index, int Period)
+{
+    return Kernel.Update(In, Out, Index, Period);
+}
+
+static float Kernel_Update(s_HMAKernel& Kernel, const float* In, const float*, int Index, int Period)
+{
+    return Kernel.Update(In, Index, Period);
+}
+
+// One Update per bar (Ticks = 0) or Ticks updates of the last bar. For the ticks, In[Count - 1] is moved around the close.
+template <typename KernelType>
+static void Benchmark_Incremental(KernelType& Kernel, float* In, float* Out, int Count, int Period, int Ticks)
+{
+    double Sum = 0.0;
+
+    if (Ticks == 0)
+    {
+        Kernel.Reset();
+        for (int Index = 0; Index < Count; Index++)
+            Out[Index] = Kernel_Update(Kernel, In, Out, Index, Period);
+
+        Sum = Out[Count - 1];
+    }
+    else
+    {
+        const int LiveIndex = Count - 1;
+        const float Close = In[LiveIndex];
+
+        for (int Tick = 0; Tick < Ticks; Tick++)
+        {
+            In[LiveIndex] = Close + (Tick & 7) * 0.25f;
+            Sum += Kernel_Update(Kernel, In, Out, LiveIndex, Period);
+        }
+
+        In[LiveIndex] = Close;
+    }
+
+    s_Checksum += Sum;
+}
+
+// The incremental kernels of one case. The tick case runs on the kernels the bar case left on the last bar.
+struct s_BenchmarkKernels
+{
+    s_SMAKernel SMA;
+    s_EMAKernel EMA;
+    s_ZLEMAKernel ZLEMA;
+    s_HMAKernel HMA;
+};
+
+static void Benchmark_Kernel(s_BenchmarkKernels& Kernels, int MA, float* In, float* Out, int Count, int Period, int Ticks)
+{
+    switch (MA)
+    {
+        case BENCHMARK_MA_SMA:
+            Benchmark_Incremental<s_SMAKernel>(Kernels.SMA, In, Out, Count, Period, Ticks);
+            break;
+
+        case BENCHMARK_MA_EMA:
+            Benchmark_Incremental<s_EMAKernel>(Kernels.EMA, In, Out, Count, Period, Ticks);
+            break;
+
+        case BENCHMARK_MA_ZLEMA:
+            Benchmark_Incremental<s_EMAKernel>(Kernels.ZLEMA, In, Out, Count, Period, Ticks);
+            break;
+
+        case BENCHMARK_MA_HMA:
+            Benchmark_Incremental<s_HMAKernel>(Kernels.HMA, In, Out, Count, Period, Ticks);
+            break;
+    }
+}
+
+static void Benchmark_WriteJSON(const s_BenchmarkOptions& Options, const std::vector<s_BenchmarkResult>& Results)
+{
+    std::printf("{\n");
+    std::printf("  \"benchmark\": \"crossover\",\n");
+    std::printf("  \"avx2\": %s,\n", MA_HasAVX2() ? "true" : "false");
+    std::printf("  \"bars\": %d,\n", Options.Bars);
+    std::printf("  \"large_bars\": %d,\n", Options.LargeBars);
+    std::printf("  \"ticks\": %d,\n", Options.Ticks);
+    std::printf("  \"repetitions\": %d,\n", Options.Repetitions);
+    std::printf("  \"results\": [\n");
+
+    for (size_t ResultIndex = 0; ResultIndex < Results.size(); ResultIndex++)
+    {
+        const s_BenchmarkResult& Result = Results[ResultIndex];
+        const double PerSecond = Result.MedianNanoseconds > 0.0 ? 1e9 / Result.MedianNanoseconds : 0.0;
+
+        std::printf("    { \"name\": \"%s\", \"group\": \"%s\", \"ma\": \"%s\", \"period\": %d, \"items\": %lld, "
+            "\"best_ns_per_item\": %.4f, \"median_ns_per_item\": %.4f, \"items_per_second\": %.0f }%s\n",
+            Result.Name.c_str(), Result.Group.c_str(), Result.MA.c_str(), Result.Period, Result.Items,
+            Result.BestNanoseconds, Result.MedianNanoseconds, PerSecond, ResultIndex + 1 < Results.size() ? "," : "");
+    }
+
+    std::printf("  ]\n");
+    std::printf("}\n");
+}
+
+static void PrintUsage()
+{
+    std::fprintf(stderr,
+        "usage: crossover_benchmark [--bars N] [--large-bars N] [--ticks N] [--repetitions N] [--filter TEXT]\n");
+}
+
+int main(int argc, char** argv)
+{
+    s_BenchmarkOptions Options;
+
+    for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++)
+    {
+        const char* Argument = argv[ArgumentIndex];
+        const char* Value = ArgumentIndex + 1 < argc ? argv[ArgumentIndex + 1] : NULL;
+
+        if (Value == NULL)
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        ArgumentIndex++;
+
+        if (std::strcmp(Argument, "--bars") == 0)
+            Options.Bars = std::atoi(Value);
+        else if (std::strcmp(Argument, "--large-bars") == 0)
+            Options.LargeBars = std::atoi(Value);
+        else if (std::strcmp(Argument, "--ticks") == 0)
+            Options.Ticks = std::atoi(Value);
+        else if (std::strcmp(Argument, "--repetitions") == 0)
+            Options.Repetitions = std::atoi(Value);
+        else if (std::strcmp(Argument, "--filter") == 0)
+            Options.Filter = Value;
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (Options.Bars < 2 || Options.Repetitions < 1)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    std::vector<s_BenchmarkResult> Results;
+    std::vector<float> Close, High, Low;
+    std::vector<float> Out, Diff;
+    char Name[128];
+
+    // Section 1 - Full-history batch kernels
+    const int Sizes[2] = { Options.Bars, Options.LargeBars };
+
+    for (int SizeIndex = 0; SizeIndex < 2; SizeIndex++)
+    {
+        const int Count = Sizes[SizeIndex];
+        if (Count < 2)
+            continue;
+
+        Benchmark_RandomWalk(Close, High, Low, Count);
+        Out.assign(Count, 0.0f);
+        Diff.assign(Count, 0.0f);
+
+        for (int MA = 0; MA < BENCHMARK_MA_COUNT; MA++)
+        {
+            for (size_t PeriodIndex = 0; PeriodIndex < sizeof(s_Periods) / sizeof(s_Periods[0]); PeriodIndex++)
+            {
+                const int Period = s_Periods[PeriodIndex];
+
+                for (int Scalar = 0; Scalar < (SizeIndex == 0 ? 2 : 1); Scalar++)
+                {
+                    std::snprintf(Name, sizeof(Name), "%s/%s/%d/%d", Scalar ? "batch_scalar" : "batch", s_MALabels[MA], Period, Count);
+
+                    Benchmark_Run(Options, Results, Name, Scalar ? "batch_scalar" : "batch", s_MALabels[MA], Period, Count, [&]()
+                    {
+                        Benchmark_Batch(MA, &Close[0], &Out[0], &Diff[0], Count, Period, Scalar != 0);
+                    });
+                }
+            }
+        }
+    }
+
+    // Section 2 - Incremental kernels, per bar and per tick
+    Benchmark_RandomWalk(Close, High, Low, Options.Bars);
+    Out.assign(Options.Bars, 0.0f);
+
+    for (int MA = 0; MA < BENCHMARK_MA_COUNT; MA++)
+    {
+        for (size_t PeriodIndex = 0; PeriodIndex < sizeof(s_Periods) / sizeof(s_Periods[0]); PeriodIndex++)
+        {
+            const int Period = s_Periods[PeriodIndex];
+            s_BenchmarkKernels Kernels;
+
+            std::snprintf(Name, sizeof(Name), "bar/%s/%d/%d", s_MALabels[MA], Period, Options.Bars);
+            Benchmark_Run(Options, Results, Name, "bar", s_MALabels[MA], Period, Options.Bars, [&]()
+            {
+                Benchmark_Kernel(Kernels, MA, &Close[0], &Out[0], Options.Bars, Period, 0);
+            });
+
+            // The ticks are all intrabar updates of the last bar, after a pass over the bars.
+            Benchmark_Kernel(Kernels, MA, &Close[0], &Out[0], Options.Bars, Period, 0);
+
+            std::snprintf(Name, sizeof(Name), "tick/%s/%d/%d", s_MALabels[MA], Period, Options.Ticks);
+            Benchmark_Run(Options, Results, Name, "tick", s_MALabels[MA], Period, Options.Ticks, [&]()
+            {
+                Benchmark_Kernel(Kernels, MA, &Close[0], &Out[0], Options.Bars, Period, Options.Ticks);
+            });
+        }
+    }
+
+    // Section 3 - Cross index over whole arrays
+    {
+        std::vector<float> Fast(Options.Bars, 0.0f);
+        std::vector<float> Slow(Options.Bars, 0.0f);
+        std::vector<s_CrossoverEvent> Crosses;
+
+        MA_Batch_EMA(&Close[0], &Fast[0], Options.Bars, 9);
+        MA_Batch_EMA(&Close[0], &Slow[0], Options.Bars, 21);
+        Crosses.reserve(Options.Bars / 2);
+
+        std::snprintf(Name, sizeof(Name), "cross/EMA/9/%d", Options.Bars);
+        Benchmark_Run(Options, Results, Name, "cross", "EMA", 9, Options.Bars, [&]()
+        {
+            Crossover_BuildIndex(&Fast[0], &Slow[0], Options.Bars, Crosses);
+            s_Checksum += static_cast<double>(Crosses.size());
+        });
+    }
+
+    // Section 4 - The studies through the headless host: averages, cross detection, orders and the simulated bracket
+    s_BarData Bars;
+    Bars.Reserve(Options.Bars);
+
+    for (int Index = 0; Index < Options.Bars; Index++)
+    {
+        Bars.DateTime.push_back(45000.0 + Index / 1440.0);
+        Bars.Open.push_back(Index > 0 ? Close[Index - 1] : Close[Index]);
+        Bars.High.push_back(std::max(High[Index], std::max(Close[Index], Bars.Open.back())));
+        Bars.Low.push_back(std::min(Low[Index], std::min(Close[Index], Bars.Open.back())));
+        Bars.Close.push_back(Close[Index]);
+        Bars.Volume.push_back(1.0f);
+        Bars.NumTrades.push_back(1.0f);
+        Bars.BidVolume.push_back(0.0f);
+        Bars.AskVolume.push_back(1.0f);
+    }
+
+    c_BarStore Store;
+    Store.SetSource(Bars);
+
+    c_HeadlessChart Chart(Store, "BENCHMARK", 0.25f);
+    Chart.SetLogMessages(false);
+
+    struct s_StudyCase
+    {
+        const char* MA;
+        SCStudyFunction Function;
+        int Mode;
+        const char* Fast;
+        const char* Slow;
+    };
+
+    // The fixed-period variants against the configurable study at the same periods.
+    const s_StudyCase Studies[] =
+    {
+        { "SMA", scsf_SMA_Crossover_Trading, HEADLESS_MODE_REPLAY, "9", "21" },
+        { "EMA", scsf_EMA_Crossover_Trading, HEADLESS_MODE_REPLAY, "9", "21" },
+        { "EMA_9_21", scsf_EMA_9_21_Crossover_Trading, HEADLESS_MODE_REPLAY, "9", "21" },
+        { "ZLEMA", scsf_ZLEMA_Crossover_Trading, HEADLESS_MODE_REPLAY, "9", "21" },
+        { "HMA", scsf_Hull_Crossover_Trading, HEADLESS_MODE_REPLAY, "9", "21" },
+        { "HMA_16_64_inputs", scsf_Hull_Crossover_Trading, HEADLESS_MODE_REPLAY, "16", "64" },
+        { "HMA_16_64", scsf_Hull_16_64_Crossover_Trading, HEADLESS_MODE_REPLAY, "16", "64" },
+        { "Sweep", scsf_Crossover_Sweep, HEADLESS_MODE_RECALCULATE, NULL, NULL },
+    };
+
+    std::vector<s_HeadlessInput> Inputs;
+
+    for (size_t StudyIndex = 0; StudyIndex < sizeof(Studies) / sizeof(Studies[0]); StudyIndex++)
+    {
+        const s_StudyCase& Study = Studies[StudyIndex];
+
+        Inputs.clear();
+        if (Study.Mode == HEADLESS_MODE_REPLAY)
+        {
+            s_HeadlessInput Input;
+            Input.Index = 0;
+            Input.Text = Study.Fast;
+            Inputs.push_back(Input);
+            Input.Index = 1;
+            Input.Text = Study.Slow;
+            Inputs.push_back(Input);
+        }
+
+        std::snprintf(Name, sizeof(Name), "study/%s/%s/%d", Study.MA, Study.Mode == HEADLESS_MODE_REPLAY ? "replay" : "recalculate", Options.Bars);
+        Benchmark_Run(Options, Results, Name, "study", Study.MA, Study.Fast != NULL ? std::atoi(Study.Fast) : 0, Options.Bars, [&]()
+        {
+            s_HeadlessResult Result;
+            Chart.Run(Study.Function, Inputs, Study.Mode, 1, Result);
+            s_Checksum += Result.Stats.NetProfit;
+        });
+    }
+
+    const int Signal_Types[BENCHMARK_MA_COUNT] = { SWEEP_MA_SMA, SWEEP_MA_EMA, SWEEP_MA_ZLEMA, SWEEP_MA_HULL };
+    c_SignalBacktest Signals;
+
+    for (int MA = 0; MA < BENCHMARK_MA_COUNT; MA++)
+    {
+        s_SignalBacktestSettings Settings;
+        Settings.Type = Signal_Types[MA];
+        Settings.FastLength = 9;
+        Settings.SlowLength = 21;
+
+        std::snprintf(Name, sizeof(Name), "study/%s/signals/%d", s_MALabels[MA], Options.Bars);
+        Benchmark_Run(Options, Results, Name, "study", s_MALabels[MA], 9, Options.Bars, [&]()
+        {
+            s_HeadlessResult Result;
+            Signals.Run(Store, Settings, Result);
+            s_Checksum += Result.Stats.NetProfit;
+        });
+    }
+
+    Benchmark_WriteJSON(Options, Results);
+    return 0;
+}
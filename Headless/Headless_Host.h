@@ -0,0 +1,242 @@
+#ifndef HEADLESS_HOST_H
+#define HEADLESS_HOST_H
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sierrachart.h"
+#include "Bar_Store.h"
+
+/*
+Runs a study function over bar data outside Sierra Chart, the way a chart would call it.
+
+Replay mode (the backtest) adds the bars one at a time, as a chart does when it replays or a live feed closes bars:
+bar 0 is a full recalculation with sc.UpdateStartIndex = 0, every later call has sc.ArraySize = Index + 1 and sc.UpdateStartIndex = Index.
+Each bar is complete when the study sees it, so the last bar reports BHCS_BAR_HAS_CLOSED and the strategies trade it.
+Before the call for a bar, the attached target and stop of an open position are checked against that bar's High and Low.
+Recalculate mode makes the single full recalculation call of a chart load (sc.ArraySize = bar count), for studies like the sweep that do their work there.
+While the study keeps sc.UpdateAlways set (the sweep's optimizer running in the background), it is called again every millisecond without new bars, as a chart calls it on each update interval.
+After the last bar the study gets its sc.LastCallToFunction call, so persistent memory is freed as in the host.
+sc.BaseDataIn views the columns of a c_BarStore without copying them, so any number of runs, on any number of threads, share one copy of the data.
+Only the columns a run needs are built: SC_HIGH, SC_LOW and SC_LAST for the simulated account, and the field of every input set with SetInputDataIndex. Columns another run already built are attached as well; set BuildAllColumns for a study that reads other fields directly.
+Subgraphs with a name get their Data array and the first ExtraArrays of sc.Subgraph[].Arrays (the studies here use Arrays[0] only). The others stay empty, so 60 subgraphs with 12 extra arrays each are not allocated for every bar.
+*/
+
+// HEADLESS_MODE_SIGNALS is the backtester's cross index mode (Signal_Backtest.h); c_HeadlessChart does not run it.
+enum e_HeadlessMode
+{
+    HEADLESS_MODE_REPLAY = 0,
+    HEADLESS_MODE_RECALCULATE = 1,
+    HEADLESS_MODE_SIGNALS = 2
+};
+
+// One input override, as set in the Study Settings window.
+struct s_HeadlessInput
+{
+    int Index;
+    std::string Text;
+};
+
+// Sets the inputs after the study's SetDefaults call.
+inline void Headless_ApplyInputs(s_sc& sc, const std::vector<s_HeadlessInput>& Inputs)
+{
+    for (size_t InputIndex = 0; InputIndex < Inputs.size(); InputIndex++)
+    {
+        if (Inputs[InputIndex].Index >= 0 && Inputs[InputIndex].Index < SC_INPUTS_AVAILABLE)
+            sc.Input[Inputs[InputIndex].Index].SetFromText(Inputs[InputIndex].Text.c_str());
+    }
+}
+
+// Gives the named subgraphs Count elements of Data and of their first ExtraArrays extra arrays.
+inline void Headless_AllocateSubgraphs(s_sc& sc, int Count, int ExtraArrays)
+{
+    for (int SubgraphIndex = 0; SubgraphIndex < SC_SUBGRAPHS_AVAILABLE; SubgraphIndex++)
+    {
+        s_SCSubgraph& Subgraph = sc.Subgraph[SubgraphIndex];
+        if (Subgraph.Name.GetLength() == 0)
+            continue;
+
+        Subgraph.Data.Resize(Count);
+        for (int ArrayIndex = 0; ArrayIndex < ExtraArrays; ArrayIndex++)
+            Subgraph.Arrays[ArrayIndex].Resize(Count);
+    }
+}
+
+struct s_HeadlessResult
+{
+    s_TradeStats Stats;
+    int OpenDirection;
+    double OpenEntryPrice;
+    // The Data of the first subgraphs after the last bar, when SetCaptureSubgraphs asked for them.
+    std::vector<std::vector<float> > Subgraphs;
+
+    s_HeadlessResult()
+        : OpenDirection(0)
+        , OpenEntryPrice(0.0)
+    {
+    }
+};
+
+class c_HeadlessChart
+{
+public:
+    c_HeadlessChart(c_BarStore& Bars, const char* Symbol, float TickSize)
+        : m_Bars(Bars)
+        , m_Symbol(Symbol)
+        , m_TickSize(TickSize)
+        , m_ExtraArrays(1)
+        , m_LogMessages(true)
+        , m_BuildAllColumns(false)
+        , m_CaptureSubgraphs(0)
+    {
+    }
+
+    void SetExtraArrays(int ExtraArrays)
+    {
+        m_ExtraArrays = ExtraArrays < 0 ? 0 : (ExtraArrays > SC_SUBGRAPH_EXTRA_ARRAYS ? SC_SUBGRAPH_EXTRA_ARRAYS : ExtraArrays);
+    }
+
+    void SetLogMessages(bool LogMessages)
+    {
+        m_LogMessages = LogMessages;
+    }
+
+    void SetBuildAllColumns(bool BuildAllColumns)
+    {
+        m_BuildAllColumns = BuildAllColumns;
+    }
+
+    // Copies the Data of the first Count subgraphs into each run's result, for a caller that checks the study's values.
+    void SetCaptureSubgraphs(int Count)
+    {
+        m_CaptureSubgraphs = Count < 0 ? 0 : (Count > SC_SUBGRAPHS_AVAILABLE ? SC_SUBGRAPHS_AVAILABLE : Count);
+    }
+
+    int BarCount() const
+    {
+        return m_Bars.Count();
+    }
+
+    // Runs one instance of Study over all the bars. Safe to call from several threads at once.
+    // StudyID is the instance's sc.StudyGraphInstanceID. Runs at the same time need their own, as the instances on one chart have, since the studies name their checkpoint files and tag their trade log rows with it.
+    void Run(SCStudyFunction Study, const std::vector<s_HeadlessInput>& Inputs, int Mode, int StudyID, s_HeadlessResult& Result)
+    {
+        s_sc* p_sc = new s_sc;
+        s_sc& sc = *p_sc;
+
+        sc.StudyGraphInstanceID = StudyID;
+
+        sc.Symbol = m_Symbol.c_str();
+        sc.TickSize = m_TickSize;
+        sc.LogMessages = m_LogMessages;
+
+        sc.SetDefaults = 1;
+        Study(sc);
+        sc.SetDefaults = 0;
+
+        Headless_ApplyInputs(sc, Inputs);
+        AttachBars(sc);
+        Headless_AllocateSubgraphs(sc, m_Bars.Count(), m_ExtraArrays);
+
+        const int Count = m_Bars.Count();
+
+        if (Mode == HEADLESS_MODE_RECALCULATE)
+        {
+            sc.ArraySize = Count;
+            sc.UpdateStartIndex = 0;
+            sc.IsFullRecalculation = 1;
+            sc.Index = Count - 1;
+            sc.LatestDateTimeForLastBar = sc.BaseDateTimeIn[Count - 1];
+            Study(sc);
+
+            sc.IsFullRecalculation = 0;
+            sc.UpdateStartIndex = Count - 1;
+            while (sc.UpdateAlways)
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                Study(sc);
+            }
+        }
+        else
+        {
+            const float* High = m_Bars.Column(SC_HIGH);
+            const float* Low = m_Bars.Column(SC_LOW);
+
+            for (int BarIndex = 0; BarIndex < Count; BarIndex++)
+            {
+                sc.Account.StepBar(BarIndex, High[BarIndex], Low[BarIndex]);
+
+                sc.ArraySize = BarIndex + 1;
+                sc.UpdateStartIndex = BarIndex;
+                sc.IsFullRecalculation = BarIndex == 0;
+                sc.Index = BarIndex;
+                sc.LatestDateTimeForLastBar = sc.BaseDateTimeIn[BarIndex];
+                Study(sc);
+            }
+        }
+
+        Result.Subgraphs.resize(m_CaptureSubgraphs);
+        for (int SubgraphIndex = 0; SubgraphIndex < m_CaptureSubgraphs; SubgraphIndex++)
+        {
+            const SCFloatArray& Data = sc.Subgraph[SubgraphIndex].Data;
+            Result.Subgraphs[SubgraphIndex].assign(Count, 0.0f);
+            for (int BarIndex = 0; BarIndex < Count; BarIndex++)
+                Result.Subgraphs[SubgraphIndex][BarIndex] = Data[BarIndex];
+        }
+
+        sc.IsFullRecalculation = 0;
+        sc.LastCallToFunction = 1;
+        Study(sc);
+
+        Result.Stats = sc.Account.Stats;
+        Result.OpenDirection = sc.Account.Position.Direction;
+        Result.OpenEntryPrice = sc.Account.Position.EntryPrice;
+
+        delete p_sc;
+    }
+
+private:
+    c_HeadlessChart(const c_HeadlessChart&);
+    c_HeadlessChart& operator=(const c_HeadlessChart&);
+
+    // The studies only read sc.BaseDataIn, so the shared read-only columns are attached as they are.
+    void AttachBars(s_sc& sc)
+    {
+        const int Count = m_Bars.Count();
+
+        if (m_BuildAllColumns)
+            m_Bars.BuildAll();
+
+        bool Needed[SC_BASE_DATA_ARRAYS] = { false };
+        Needed[SC_HIGH] = true;
+        Needed[SC_LOW] = true;
+        Needed[SC_LAST] = true;
+
+        for (int InputIndex = 0; InputIndex < SC_INPUTS_AVAILABLE; InputIndex++)
+        {
+            const int Field = sc.Input[InputIndex].GetInputDataIndex();
+            if (sc.Input[InputIndex].IsInputData && Field >= 0 && Field < SC_BASE_DATA_ARRAYS)
+                Needed[Field] = true;
+        }
+
+        for (int Field = 0; Field < SC_BASE_DATA_ARRAYS; Field++)
+        {
+            const float* Column = Needed[Field] ? m_Bars.Column(Field) : m_Bars.BuiltColumn(Field);
+            sc.BaseDataIn[Field].Attach(const_cast<float*>(Column), Count);
+        }
+
+        sc.BaseDateTimeIn.Attach(const_cast<SCDateTime*>(m_Bars.DateTime()), Count);
+    }
+
+    c_BarStore& m_Bars;
+    std::string m_Symbol;
+    float m_TickSize;
+    int m_ExtraArrays;
+    bool m_LogMessages;
+    bool m_BuildAllColumns;
+    int m_CaptureSubgraphs;
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "../Latency_Trace.h"
+
+/*
+Prints the latency distributions of a trace file written by the strategies' Latency Trace File input (Latency_Trace.h).
+
+latency_report FILE
+
+For every signal with its order records, four intervals are measured:
+market to signal - from the time of the triggering trade (sc.LatestDateTimeForLastBar) to the study seeing the cross, on the system clock. It includes the feed and the chart update, and is only as good as the clock sync between the exchange and this machine; SCDateTime values have millisecond resolution.
+signal to order call - from the cross to the sc.BuyEntry / sc.SellEntry call, on the steady clock. It includes the position lookup and flattening an opposite position.
+order call - the entry call itself, on the steady clock.
+market to order return - the whole path, from the triggering trade to the entry call returning.
+*/
+
+// SCDateTime counts days from 1899-12-30; the Unix epoch is day 25569.
+static long long Latency_MarketTimeToUnixNanoseconds(double MarketTime)
+{
+    return static_cast<long long>((MarketTime - 25569.0) * 86400.0 * 1e9);
+}
+
+static void Latency_PrintDistribution(const char* Name, std::vector<double>& Microseconds)
+{
+    if (Microseconds.empty())
+    {
+        std::printf("%-24s no samples\n", Name);
+        return;
+    }
+
+    std::sort(Microseconds.begin(), Microseconds.end());
+
+    const size_t Count = Microseconds.size();
+    std::printf("%-24s %8d samples  p50 %12.3f us  p90 %12.3f us  p99 %12.3f us  max %12.3f us\n",
+        Name, static_cast<int>(Count),
+        Microseconds[(Count - 1) / 2], Microseconds[(Count - 1) * 9 / 10], Microseconds[(Count - 1) * 99 / 100], Microseconds[Count - 1]);
+}
+
+struct s_LatencySignal
+{
+    s_LatencyRecord Signal;
+    s_LatencyRecord OrderBegin;
+    s_LatencyRecord OrderEnd;
+    bool HasSignal;
+    bool HasOrderBegin;
+    bool HasOrderEnd;
+
+    s_LatencySignal()
+        : HasSignal(false)
+        , HasOrderBegin(false)
+        , HasOrderEnd(false)
+    {
+    }
+};
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "usage: latency_report FILE\n");
+        return 2;
+    }
+
+    std::FILE* File = std::fopen(argv[1], "rb");
+    if (File == NULL)
+    {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    s_LatencyFileHeader Header;
+    if (std::fread(&Header, sizeof(Header), 1, File) != 1 || std::memcmp(Header.Magic, LATENCY_FILE_MAGIC, sizeof(Header.Magic)) != 0
+        || Header.Version != LATENCY_FILE_VERSION || Header.RecordSize != sizeof(s_LatencyRecord))
+    {
+        std::fprintf(stderr, "%s is not a version %u latency trace\n", argv[1], LATENCY_FILE_VERSION);
+        std::fclose(File);
+        return 1;
+    }
+
+    // Records are matched on the tracer and sequence numbers. A file appended to over several sessions repeats them; a new signal record starts a new entry.
+    std::vector<s_LatencySignal> Signals;
+    std::map<std::pair<unsigned int, unsigned int>, size_t> Open;
+    s_LatencyRecord Record;
+    int Records = 0;
+
+    while (std::fread(&Record, sizeof(Header), 1, File) == 1)
+    {
+        // Two instances that found the same empty file each wrote a header; the second is skipped.
+        if (std::memcmp(&Record, &Header, sizeof(Header)) == 0)
+            continue;
+
+        if (std::fread(reinterpret_cast<char*>(&Record) + sizeof(Header), sizeof(Record) - sizeof(Header), 1, File) != 1)
+            break;
+
+        Records++;
+
+        if (Record.Kind == LATENCY_SIGNAL)
+        {
+            Open[std::make_pair(Record.Tracer, Record.Sequence)] = Signals.size();
+            Signals.push_back(s_LatencySignal());
+            Signals.back().Signal = Record;
+            Signals.back().HasSignal = true;
+            continue;
+        }
+
+        std::map<std::pair<unsigned int, unsigned int>, size_t>::iterator Found = Open.find(std::make_pair(Record.Tracer, Record.Sequence));
+        if (Found == Open.end())
+            continue;
+
+        s_LatencySignal& Signal = Signals[Found->second];
+        if (Record.Kind == LATENCY_ORDER_BEGIN)
+        {
+            Signal.OrderBegin = Record;
+            Signal.HasOrderBegin = true;
+        }
+        else if (Record.Kind == LATENCY_ORDER_END)
+        {
+            Signal.OrderEnd = Record;
+            Signal.HasOrderEnd = true;
+        }
+    }
+
+    std::fclose(File);
+
+    std::vector<double> Market_To_Signal, Signal_To_Order, Order_Call, Market_To_Return;
+
+    for (size_t SignalIndex = 0; SignalIndex < Signals.size(); SignalIndex++)
+    {
+        const s_LatencySignal& Signal = Signals[SignalIndex];
+        const bool HasMarketTime = Signal.Signal.MarketTime > 0.0;
+        const long long MarketNanoseconds = Latency_MarketTimeToUnixNanoseconds(Signal.Signal.MarketTime);
+
+        if (HasMarketTime)
+            Market_To_Signal.push_back((Signal.Signal.SystemTime - MarketNanoseconds) / 1e3);
+
+        if (Signal.HasOrderBegin)
+            Signal_To_Order.push_back((Signal.OrderBegin.SteadyTime - Signal.Signal.SteadyTime) / 1e3);
+
+        if (Signal.HasOrderBegin && Signal.HasOrderEnd)
+            Order_Call.push_back((Signal.OrderEnd.SteadyTime - Signal.OrderBegin.SteadyTime) / 1e3);
+
+        if (Signal.HasOrderEnd && HasMarketTime)
+            Market_To_Return.push_back((Signal.OrderEnd.SystemTime - MarketNanoseconds) / 1e3);
+    }
+
+    std::printf("%s: %d records, %d signals\n", argv[1], Records, static_cast<int>(Signals.size()));
+    Latency_PrintDistribution("market to signal", Market_To_Signal);
+    Latency_PrintDistribution("signal to order call", Signal_To_Order);
+    Latency_PrintDistribution("order call", Order_Call);
+    Latency_PrintDistribution("market to order return", Market_To_Return);
+
+    return 0;
+}
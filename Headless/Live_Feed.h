@@ -0,0 +1,232 @@
+#ifndef LIVE_FEED_H
+#define LIVE_FEED_H
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/*
+Wire formats and sockets of the live signal server (Live_Signal_Server.cpp).
+
+The feed is UDP, unicast or multicast: each datagram carries one or more s_LiveTradeMessage records back to back, little endian, with no other framing.
+Sequence numbers one trade of the feed and goes up by one per trade; a jump is a gap (lost datagrams), a repeat or a step back is a duplicate and is dropped.
+Time is the trade's exchange time in nanoseconds since 1970. Flags say which side the trade hit, for sc.BaseDataIn[SC_BIDVOL] and [SC_ASKVOL].
+Each entry the study makes is sent out as one s_LiveSignalMessage datagram, with the sequence and time of the last trade applied before the call, so a consumer can measure the trade to signal time itself.
+The sockets are non-blocking; the server polls them from one thread and never waits in a system call.
+These are POSIX sockets, for the Linux hosts the server is meant for.
+*/
+
+enum e_LiveTradeFlags
+{
+    LIVE_TRADE_AT_BID = 1,
+    LIVE_TRADE_AT_ASK = 2
+};
+
+#pragma pack(push, 1)
+
+struct s_LiveTradeMessage
+{
+    unsigned long long Sequence;
+    long long Time;
+    double Price;
+    float Volume;
+    unsigned int Flags;
+};
+
+struct s_LiveSignalMessage
+{
+    unsigned long long Sequence;
+    unsigned long long TradeSequence;
+    long long TradeTime;
+    long long SignalTime;
+    double Price;
+    int BarIndex;
+    int Direction;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(s_LiveTradeMessage) == 32, "s_LiveTradeMessage must match the wire format");
+static_assert(sizeof(s_LiveSignalMessage) == 48, "s_LiveSignalMessage must match the wire format");
+
+// The most trades in one datagram that fits a 1500 byte Ethernet frame.
+const int LIVE_TRADES_PER_DATAGRAM = 44;
+
+// Parses ADDRESS:PORT with a dotted IPv4 address.
+inline bool LiveFeed_ParseAddress(const char* Text, sockaddr_in& Address)
+{
+    const char* Colon = std::strrchr(Text, ':');
+    if (Colon == NULL || Colon == Text)
+        return false;
+
+    const std::string Host(Text, Colon - Text);
+    const int Port = std::atoi(Colon + 1);
+    if (Port <= 0 || Port > 65535)
+        return false;
+
+    std::memset(&Address, 0, sizeof(Address));
+    Address.sin_family = AF_INET;
+    Address.sin_port = htons(static_cast<unsigned short>(Port));
+    return inet_pton(AF_INET, Host.c_str(), &Address.sin_addr) == 1;
+}
+
+inline bool LiveFeed_IsMulticast(const sockaddr_in& Address)
+{
+    return IN_MULTICAST(ntohl(Address.sin_addr.s_addr));
+}
+
+// Pins the calling thread to one CPU, so the polling loop is not moved between cores. Returns false when the CPU cannot be used.
+inline bool LiveFeed_PinThread(int Cpu)
+{
+    cpu_set_t Set;
+    CPU_ZERO(&Set);
+    CPU_SET(Cpu, &Set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(Set), &Set) == 0;
+}
+
+// Spin-wait hint between empty reads, so the polling loop gives way to the other hardware thread of its core.
+inline void LiveFeed_CpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+class c_LiveSocket
+{
+public:
+    c_LiveSocket()
+        : m_Socket(-1)
+    {
+        std::memset(&m_Address, 0, sizeof(m_Address));
+    }
+
+    ~c_LiveSocket()
+    {
+        Close();
+    }
+
+    // Binds to the port of Address and, when it is a multicast group, joins it on Interface (NULL = the default interface).
+    bool OpenReceiver(const sockaddr_in& Address, const char* Interface, std::string& Error)
+    {
+        if (!Create(Error))
+            return false;
+
+        const int Reuse = 1;
+        setsockopt(m_Socket, SOL_SOCKET, SO_REUSEADDR, &Reuse, sizeof(Reuse));
+
+        // A large receive buffer rides out the time the study call holds the thread.
+        const int Buffer_Bytes = 8 << 20;
+        setsockopt(m_Socket, SOL_SOCKET, SO_RCVBUF, &Buffer_Bytes, sizeof(Buffer_Bytes));
+
+        if (bind(m_Socket, reinterpret_cast<const sockaddr*>(&Address), sizeof(Address)) != 0)
+            return Fail("bind", Error);
+
+        if (LiveFeed_IsMulticast(Address))
+        {
+            ip_mreq Membership;
+            Membership.imr_multiaddr = Address.sin_addr;
+            Membership.imr_interface.s_addr = htonl(INADDR_ANY);
+
+            if (Interface != NULL && inet_pton(AF_INET, Interface, &Membership.imr_interface) != 1)
+            {
+                Error = std::string("bad interface address ") + Interface;
+                Close();
+                return false;
+            }
+
+            if (setsockopt(m_Socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &Membership, sizeof(Membership)) != 0)
+                return Fail("IP_ADD_MEMBERSHIP", Error);
+        }
+
+        return true;
+    }
+
+    // Sends to Address. Multicast goes out with the given TTL and is looped back to this host.
+    bool OpenSender(const sockaddr_in& Address, int Ttl, std::string& Error)
+    {
+        if (!Create(Error))
+            return false;
+
+        if (LiveFeed_IsMulticast(Address))
+        {
+            const unsigned char Multicast_Ttl = static_cast<unsigned char>(Ttl);
+            const unsigned char Loop = 1;
+            setsockopt(m_Socket, IPPROTO_IP, IP_MULTICAST_TTL, &Multicast_Ttl, sizeof(Multicast_Ttl));
+            setsockopt(m_Socket, IPPROTO_IP, IP_MULTICAST_LOOP, &Loop, sizeof(Loop));
+        }
+
+        // Not connected: a connected UDP socket fails the next send after an ICMP port unreachable, when nothing listens yet.
+        m_Address = Address;
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_Socket >= 0)
+            close(m_Socket);
+
+        m_Socket = -1;
+    }
+
+    bool IsOpen() const
+    {
+        return m_Socket >= 0;
+    }
+
+    // Receiver only. Bytes of the next datagram, 0 when none is waiting, -1 on an error.
+    int Receive(void* Buffer, int Bytes)
+    {
+        const ssize_t Received = recv(m_Socket, Buffer, Bytes, 0);
+        if (Received >= 0)
+            return static_cast<int>(Received);
+
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+    }
+
+    // Sender only. A full send buffer drops the datagram rather than waiting, like the network would.
+    bool Send(const void* Buffer, int Bytes)
+    {
+        return sendto(m_Socket, Buffer, Bytes, 0, reinterpret_cast<const sockaddr*>(&m_Address), sizeof(m_Address)) == Bytes;
+    }
+
+private:
+    c_LiveSocket(const c_LiveSocket&);
+    c_LiveSocket& operator=(const c_LiveSocket&);
+
+    bool Create(std::string& Error)
+    {
+        Close();
+
+        m_Socket = socket(AF_INET, SOCK_DGRAM, 0);
+        if (m_Socket < 0)
+            return Fail("socket", Error);
+
+        if (fcntl(m_Socket, F_SETFL, fcntl(m_Socket, F_GETFL, 0) | O_NONBLOCK) != 0)
+            return Fail("O_NONBLOCK", Error);
+
+        return true;
+    }
+
+    bool Fail(const char* Call, std::string& Error)
+    {
+        Error = std::string(Call) + ": " + std::strerror(errno);
+        Close();
+        return false;
+    }
+
+    int m_Socket;
+    sockaddr_in m_Address;
+};
+
+#endif
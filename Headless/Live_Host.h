@@ -0,0 +1,253 @@
+#ifndef LIVE_HOST_H
+#define LIVE_HOST_H
+
+#include <string>
+#include <vector>
+
+#include "sierrachart.h"
+#include "Headless_Host.h"
+#include "Live_Feed.h"
+
+/*
+Runs a study function on bars built from a live trade stream, the way a chart with a live feed calls it.
+
+Apply adds one trade: it starts a new bar when the trade's time is past the bar the last trade went into, and otherwise updates the last bar's High, Low, Last, Volume, trade count and bid / ask volume.
+Bars start on multiples of BarSeconds from midnight 1970-01-01 of the trade times. A trade older than the last bar (out of order by more than a bar) goes into the last bar and is counted as late.
+Update then calls the study once for everything applied since the last call, with sc.UpdateStartIndex = the first bar that changed. The first call is the full recalculation; later ones are the per-tick and new-bar calls of a chart.
+The last bar reports BHCS_BAR_HAS_NOT_CLOSED until the next bar starts, so the strategies see each bar closed once, when the following one opens, and can act on the live bar with their intrabar inputs.
+CloseLastBar marks the last bar closed without waiting for the next trade, for a host that closes bars on a clock (Live_Signal_Server.cpp does, once the feed's time is past the bar's end).
+Each trade also steps the attached target and stop of an open position at its price, before the study sees it.
+The columns and subgraphs are allocated for Capacity bars up front, so neither the bar building nor the study calls after the first reach the heap; Apply returns false when a new bar would not fit.
+One thread only: the chart is built and called from the thread that polls the feed, and nothing in it is shared or locked.
+*/
+
+// SCDateTime days of a time in nanoseconds since 1970.
+inline double Live_SCDateTime(long long Nanoseconds)
+{
+    return Nanoseconds / 1e9 / 86400.0 + 25569.0;
+}
+
+class c_LiveChart
+{
+public:
+    c_LiveChart(const char* Symbol, float TickSize, int BarSeconds, int Capacity)
+        : p_sc(NULL)
+        , m_Study(NULL)
+        , m_Symbol(Symbol)
+        , m_TickSize(TickSize)
+        , m_BarNanoseconds((BarSeconds > 0 ? BarSeconds : 1) * 1000000000LL)
+        , m_Capacity(Capacity > 0 ? Capacity : 1)
+        , m_Count(0)
+        , m_DirtyIndex(-1)
+        , m_LastBarStart(0)
+        , m_Calls(0)
+        , m_LateTrades(0)
+    {
+        for (int Field = 0; Field < SC_BASE_DATA_ARRAYS; Field++)
+            m_Columns[Field].assign(m_Capacity, 0.0f);
+
+        m_DateTime.assign(m_Capacity, SCDateTime());
+    }
+
+    ~c_LiveChart()
+    {
+        delete p_sc;
+    }
+
+    // Creates the study instance: the SetDefaults call, the inputs, and the arrays for Capacity bars. The study is first called by Update.
+    void Start(SCStudyFunction Study, const std::vector<s_HeadlessInput>& Inputs, bool LogMessages)
+    {
+        delete p_sc;
+        p_sc = new s_sc;
+        s_sc& sc = *p_sc;
+
+        m_Study = Study;
+        m_Count = 0;
+        m_DirtyIndex = -1;
+        m_Calls = 0;
+
+        sc.Symbol = m_Symbol.c_str();
+        sc.TickSize = m_TickSize;
+        sc.LogMessages = LogMessages;
+
+        sc.SetDefaults = 1;
+        Study(sc);
+        sc.SetDefaults = 0;
+
+        Headless_ApplyInputs(sc, Inputs);
+
+        for (int Field = 0; Field < SC_BASE_DATA_ARRAYS; Field++)
+            sc.BaseDataIn[Field].Attach(&m_Columns[Field][0], m_Capacity);
+
+        sc.BaseDateTimeIn.Attach(&m_DateTime[0], m_Capacity);
+        Headless_AllocateSubgraphs(sc, m_Capacity, 1);
+        sc.LastBarHasClosed = 0;
+    }
+
+    // Forwards each filled entry to Callback.
+    void SetEntryCallback(HeadlessEntryCallback Callback, void* p_Context)
+    {
+        p_sc->p_EntryCallback = Callback;
+        p_sc->p_EntryContext = p_Context;
+    }
+
+    // Adds a trade to the bars. Returns false when it starts a bar past the capacity.
+    bool Apply(const s_LiveTradeMessage& Trade)
+    {
+        s_sc& sc = *p_sc;
+        const long long Bar_Start = Trade.Time - Trade.Time % m_BarNanoseconds;
+        const float Price = static_cast<float>(Trade.Price);
+        int BarIndex = m_Count - 1;
+
+        if (m_Count == 0 || Bar_Start > m_LastBarStart)
+        {
+            if (m_Count == m_Capacity)
+                return false;
+
+            BarIndex = m_Count++;
+            m_LastBarStart = Bar_Start;
+            m_DateTime[BarIndex] = SCDateTime(Live_SCDateTime(Bar_Start));
+
+            m_Columns[SC_OPEN][BarIndex] = Price;
+            m_Columns[SC_HIGH][BarIndex] = Price;
+            m_Columns[SC_LOW][BarIndex] = Price;
+            m_Columns[SC_VOLUME][BarIndex] = 0.0f;
+            m_Columns[SC_NUM_TRADES][BarIndex] = 0.0f;
+            m_Columns[SC_BIDVOL][BarIndex] = 0.0f;
+            m_Columns[SC_ASKVOL][BarIndex] = 0.0f;
+            sc.LastBarHasClosed = 0;
+        }
+        else
+        {
+            if (Bar_Start < m_LastBarStart)
+                m_LateTrades++;
+
+            if (Price > m_Columns[SC_HIGH][BarIndex])
+                m_Columns[SC_HIGH][BarIndex] = Price;
+            if (Price < m_Columns[SC_LOW][BarIndex])
+                m_Columns[SC_LOW][BarIndex] = Price;
+        }
+
+        const float Open = m_Columns[SC_OPEN][BarIndex];
+        const float High = m_Columns[SC_HIGH][BarIndex];
+        const float Low = m_Columns[SC_LOW][BarIndex];
+
+        m_Columns[SC_LAST][BarIndex] = Price;
+        m_Columns[SC_VOLUME][BarIndex] += Trade.Volume;
+        m_Columns[SC_NUM_TRADES][BarIndex] += 1.0f;
+        if (Trade.Flags & LIVE_TRADE_AT_BID)
+            m_Columns[SC_BIDVOL][BarIndex] += Trade.Volume;
+        if (Trade.Flags & LIVE_TRADE_AT_ASK)
+            m_Columns[SC_ASKVOL][BarIndex] += Trade.Volume;
+
+        m_Columns[SC_OHLC_AVG][BarIndex] = (Open + High + Low + Price) / 4.0f;
+        m_Columns[SC_HLC_AVG][BarIndex] = (High + Low + Price) / 3.0f;
+        m_Columns[SC_HL_AVG][BarIndex] = (High + Low) / 2.0f;
+
+        if (m_DirtyIndex < 0 || BarIndex < m_DirtyIndex)
+            m_DirtyIndex = BarIndex;
+
+        sc.LatestDateTimeForLastBar = SCDateTime(Live_SCDateTime(Trade.Time));
+        sc.Account.StepBar(BarIndex, Price, Price);
+        return true;
+    }
+
+    // Calls the study when trades were applied since the last call. Returns false when there was nothing to do.
+    bool Update()
+    {
+        if (m_DirtyIndex < 0)
+            return false;
+
+        s_sc& sc = *p_sc;
+
+        sc.ArraySize = m_Count;
+        sc.IsFullRecalculation = m_Calls == 0;
+        sc.UpdateStartIndex = m_Calls == 0 ? 0 : m_DirtyIndex;
+        sc.Index = m_Count - 1;
+        m_Study(sc);
+
+        m_DirtyIndex = -1;
+        m_Calls++;
+        return true;
+    }
+
+    // Marks the last bar closed and calls the study with it. Returns false when there is no open bar.
+    bool CloseLastBar()
+    {
+        if (m_Count == 0 || p_sc->LastBarHasClosed)
+            return false;
+
+        p_sc->LastBarHasClosed = 1;
+        if (m_DirtyIndex < 0 || m_Count - 1 < m_DirtyIndex)
+            m_DirtyIndex = m_Count - 1;
+
+        return Update();
+    }
+
+    // The sc.LastCallToFunction call, after the last trade.
+    void Finish(s_HeadlessResult& Result)
+    {
+        s_sc& sc = *p_sc;
+
+        if (m_Calls > 0)
+        {
+            sc.IsFullRecalculation = 0;
+            sc.LastCallToFunction = 1;
+            m_Study(sc);
+        }
+
+        Result.Stats = sc.Account.Stats;
+        Result.OpenDirection = sc.Account.Position.Direction;
+        Result.OpenEntryPrice = sc.Account.Position.EntryPrice;
+
+        delete p_sc;
+        p_sc = NULL;
+    }
+
+    bool LastBarOpen() const
+    {
+        return m_Count > 0 && !p_sc->LastBarHasClosed;
+    }
+
+    // End of the last bar, in nanoseconds since 1970.
+    long long LastBarEnd() const
+    {
+        return m_LastBarStart + m_BarNanoseconds;
+    }
+
+    int BarCount() const
+    {
+        return m_Count;
+    }
+
+    unsigned long long Calls() const
+    {
+        return m_Calls;
+    }
+
+    unsigned long long LateTrades() const
+    {
+        return m_LateTrades;
+    }
+
+private:
+    c_LiveChart(const c_LiveChart&);
+    c_LiveChart& operator=(const c_LiveChart&);
+
+    s_sc* p_sc;
+    SCStudyFunction m_Study;
+    std::string m_Symbol;
+    float m_TickSize;
+    long long m_BarNanoseconds;
+    int m_Capacity;
+    int m_Count;
+    int m_DirtyIndex;
+    long long m_LastBarStart;
+    unsigned long long m_Calls;
+    unsigned long long m_LateTrades;
+
+    std::vector<float> m_Columns[SC_BASE_DATA_ARRAYS];
+    std::vector<SCDateTime> m_DateTime;
+};
+
+#endif
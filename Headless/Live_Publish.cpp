@@ -0,0 +1,177 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Bar_File.h"
+#include "Live_Feed.h"
+
+/*
+Replays a bar file as a UDP trade feed in the format of Live_Feed.h, for trying out and measuring the live signal server (Live_Signal_Server.cpp).
+
+live_publish --bars FILE --to ADDRESS:PORT [options]
+--bars FILE        a bar text export (see Bar_File.h)
+--to ADDRESS:PORT  the feed address; a multicast group (224.0.0.0/4) is sent to with --ttl
+--rate N           trades per second (default 0, as fast as the socket takes them)
+--batch N          trades per datagram, up to 44 (default 1)
+--ttl N            multicast TTL (default 1, this subnet)
+--now              stamps each trade with the time it is sent instead of its bar's time
+
+Each bar becomes four trades: the Open, whichever of the High and Low is nearer the Open, the other one, and the Close, 1 ms apart from the bar's start, with a quarter of the bar's volume each.
+At the bar times, a server with the bar file's bar size rebuilds the same bars. With --now the bars are whatever the send rate makes them, and the market to signal times of a latency trace are real.
+*/
+
+static long long PublishSystemNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void PrintUsage()
+{
+    std::fprintf(stderr, "usage: live_publish --bars FILE --to ADDRESS:PORT [--rate N] [--batch N] [--ttl N] [--now]\n");
+}
+
+int main(int argc, char** argv)
+{
+    const char* Bars_Path = NULL;
+    const char* To_Text = NULL;
+    double Rate = 0.0;
+    int Batch = 1;
+    int Ttl = 1;
+    bool Now = false;
+
+    for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++)
+    {
+        const char* Argument = argv[ArgumentIndex];
+        const char* Value = ArgumentIndex + 1 < argc ? argv[ArgumentIndex + 1] : NULL;
+
+        if (std::strcmp(Argument, "--now") == 0)
+        {
+            Now = true;
+            continue;
+        }
+
+        if (Value == NULL)
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        ArgumentIndex++;
+
+        if (std::strcmp(Argument, "--bars") == 0)
+            Bars_Path = Value;
+        else if (std::strcmp(Argument, "--to") == 0)
+            To_Text = Value;
+        else if (std::strcmp(Argument, "--rate") == 0)
+            Rate = std::atof(Value);
+        else if (std::strcmp(Argument, "--batch") == 0)
+            Batch = std::atoi(Value);
+        else if (std::strcmp(Argument, "--ttl") == 0)
+            Ttl = std::atoi(Value);
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (Bars_Path == NULL || To_Text == NULL || Batch < 1 || Batch > LIVE_TRADES_PER_DATAGRAM)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    sockaddr_in To_Address;
+    if (!LiveFeed_ParseAddress(To_Text, To_Address))
+    {
+        std::fprintf(stderr, "bad address %s, expected ADDRESS:PORT\n", To_Text);
+        return 2;
+    }
+
+    s_BarData Bars;
+    std::string Error;
+    if (!Bar_LoadTextFile(Bars_Path, Bars, Error))
+    {
+        std::fprintf(stderr, "%s\n", Error.c_str());
+        return 1;
+    }
+
+    c_LiveSocket Socket;
+    if (!Socket.OpenSender(To_Address, Ttl, Error))
+    {
+        std::fprintf(stderr, "%s: %s\n", To_Text, Error.c_str());
+        return 1;
+    }
+
+    // The trades of every bar, in feed order.
+    std::vector<s_LiveTradeMessage> Trades;
+    Trades.reserve(static_cast<size_t>(Bars.Count()) * 4);
+
+    for (int BarIndex = 0; BarIndex < Bars.Count(); BarIndex++)
+    {
+        const float Open = Bars.Open[BarIndex];
+        const float Close = Bars.Close[BarIndex];
+        const bool High_First = std::fabs(Bars.High[BarIndex] - Open) < std::fabs(Bars.Low[BarIndex] - Open);
+        const float Prices[4] = { Open, High_First ? Bars.High[BarIndex] : Bars.Low[BarIndex], High_First ? Bars.Low[BarIndex] : Bars.High[BarIndex], Close };
+        const long long Bar_Time = std::llround((Bars.DateTime[BarIndex] - 25569.0) * 86400.0 * 1e3) * 1000000LL;
+
+        for (int PriceIndex = 0; PriceIndex < 4; PriceIndex++)
+        {
+            s_LiveTradeMessage Trade;
+            Trade.Sequence = Trades.size() + 1;
+            Trade.Time = Bar_Time + PriceIndex * 1000000LL;
+            Trade.Price = Prices[PriceIndex];
+            Trade.Volume = Bars.Volume[BarIndex] / 4.0f;
+            Trade.Flags = PriceIndex > 0 && Prices[PriceIndex] >= Prices[PriceIndex - 1] ? LIVE_TRADE_AT_ASK : LIVE_TRADE_AT_BID;
+            Trades.push_back(Trade);
+        }
+    }
+
+    const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+    unsigned long long Datagrams = 0;
+    unsigned long long Failures = 0;
+
+    for (size_t First = 0; First < Trades.size(); First += Batch)
+    {
+        const size_t Count = First + Batch <= Trades.size() ? Batch : Trades.size() - First;
+
+        if (Rate > 0.0)
+        {
+            const std::chrono::steady_clock::time_point Due = Start + std::chrono::nanoseconds(static_cast<long long>(First / Rate * 1e9));
+            while (std::chrono::steady_clock::now() < Due)
+                LiveFeed_CpuRelax();
+        }
+
+        if (Now)
+        {
+            const long long Time = PublishSystemNanoseconds();
+            for (size_t TradeIndex = First; TradeIndex < First + Count; TradeIndex++)
+                Trades[TradeIndex].Time = Time;
+        }
+
+        // A full send buffer is waited out here, unlike in the server, so a run without --rate still sends every trade.
+        while (!Socket.Send(&Trades[First], static_cast<int>(Count * sizeof(s_LiveTradeMessage))))
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ENOBUFS)
+            {
+                Failures++;
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+
+        Datagrams++;
+    }
+
+    const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+    std::fprintf(stderr, "sent %d trades of %d bars in %llu datagrams in %.3f s, %llu failed\n",
+        static_cast<int>(Trades.size()), Bars.Count(), Datagrams, Seconds, Failures);
+
+    return Failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,406 @@
+// With STUDY_ALLOCATION_COUNTER, this program defines the counting operator new (Study_Arena.h).
+#define STUDY_ALLOCATION_COUNTER_OPERATORS 1
+
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sierrachart.h"
+#include "Live_Host.h"
+#include "../Study_Arena.h"
+#include "../Study_Timing.h"
+
+/*
+Live signal server: runs a crossover strategy on a UDP trade feed, outside Sierra Chart.
+
+The study files in the repository root are compiled unchanged against the headless sierrachart.h, as for the backtester, and linked into this program (see README.md here for the build command).
+One thread does everything: it polls the non-blocking feed socket, applies each datagram's trades to the bars (c_LiveChart, Live_Host.h), calls the study once per datagram, and sends each entry as an s_LiveSignalMessage (Live_Feed.h).
+There are no locks and, after the first call, no heap allocations on that path. With --cpu the thread is pinned to one core, which should be kept free of other work (isolcpus or a cpuset), since the loop never sleeps.
+A bar closes when the first trade of the next bar arrives, or when the feed's clock passes the bar's end plus --close-delay-ms, whichever is first, so a quiet market does not hold back the signal of the bar that just ended.
+The feed's clock is the time of the last trade plus the steady clock time since it arrived, so it follows the feed's timestamps rather than this machine's clock.
+Entries fill on the simulated account of the headless trading functions; the server is a signal source, and the consumer of the signals places the orders.
+The study's own inputs still work: the Latency Trace File input measures trade to order call on this path, and the Trade Log File input logs every signal and fill.
+On exit (SIGINT, SIGTERM, --duration, or --idle-seconds after the first trade) the counters and the datagram to study return latency are written to standard error.
+
+crossover_live --study sma|ema|ema9_21|zlema|hull|hull16_64|kama|alma|t3|vwma --feed ADDRESS:PORT [options]
+--feed ADDRESS:PORT     the feed to bind; a multicast group (224.0.0.0/4) is joined
+--interface ADDRESS     the local interface for the multicast group (default any)
+--signals ADDRESS:PORT  where the signal datagrams are sent (default none)
+--bar-seconds N         bar size (default 60)
+--close-delay-ms N      time after a bar's end before it is closed without a next trade (default 5)
+--max-bars N            bars allocated up front (default 262144); the server stops when they are used up
+--cpu N                 pins the polling thread to CPU N
+--duration SECONDS      stops after this long (default 0, until interrupted)
+--idle-seconds SECONDS  stops this long after the last trade (default 0, never)
+--symbol NAME           sc.Symbol (default HEADLESS)
+--tick-size VALUE       sc.TickSize (default 0.25)
+--input N=VALUE         sets study input N, as in the Study Settings window (repeatable)
+--quiet                 drops the study's message log output
+*/
+
+SCSFExport scsf_SMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_EMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_EMA_9_21_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_ZLEMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Hull_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Hull_16_64_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_KAMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_ALMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_T3_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_VWMA_Crossover_Trading(SCStudyInterfaceRef sc);
+
+struct s_StudyEntry
+{
+    const char* Name;
+    SCStudyFunction Function;
+};
+
+static const s_StudyEntry s_Studies[] =
+{
+    { "sma", scsf_SMA_Crossover_Trading },
+    { "ema", scsf_EMA_Crossover_Trading },
+    { "ema9_21", scsf_EMA_9_21_Crossover_Trading },
+    { "zlema", scsf_ZLEMA_Crossover_Trading },
+    { "hull", scsf_Hull_Crossover_Trading },
+    { "hull16_64", scsf_Hull_16_64_Crossover_Trading },
+    { "kama", scsf_KAMA_Crossover_Trading },
+    { "alma", scsf_ALMA_Crossover_Trading },
+    { "t3", scsf_T3_Crossover_Trading },
+    { "vwma", scsf_VWMA_Crossover_Trading },
+};
+
+// Set by SIGINT and SIGTERM.
+static volatile std::sig_atomic_t s_StopRequested = 0;
+
+static void OnStopSignal(int)
+{
+    s_StopRequested = 1;
+}
+
+static long long SteadyNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static long long SystemNanoseconds()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// What the entry callback needs to send a signal. Polling thread only.
+struct s_SignalOutput
+{
+    c_LiveSocket* p_Socket;
+    unsigned long long Sequence;
+    unsigned long long TradeSequence;
+    long long TradeTime;
+    unsigned long long SendFailures;
+
+    s_SignalOutput()
+        : p_Socket(NULL)
+        , Sequence(0)
+        , TradeSequence(0)
+        , TradeTime(0)
+        , SendFailures(0)
+    {
+    }
+};
+
+static void SendSignal(void* p_Context, int Direction, int BarIndex, double Price)
+{
+    s_SignalOutput& Output = *static_cast<s_SignalOutput*>(p_Context);
+
+    s_LiveSignalMessage Message;
+    Message.Sequence = ++Output.Sequence;
+    Message.TradeSequence = Output.TradeSequence;
+    Message.TradeTime = Output.TradeTime;
+    Message.SignalTime = SystemNanoseconds();
+    Message.Price = Price;
+    Message.BarIndex = BarIndex;
+    Message.Direction = Direction;
+
+    if (Output.p_Socket != NULL && !Output.p_Socket->Send(&Message, sizeof(Message)))
+        Output.SendFailures++;
+}
+
+static void PrintUsage()
+{
+    std::fprintf(stderr,
+        "usage: crossover_live --study sma|ema|ema9_21|zlema|hull|hull16_64|kama|alma|t3|vwma --feed ADDRESS:PORT\n"
+        "    [--interface ADDRESS] [--signals ADDRESS:PORT] [--bar-seconds N] [--close-delay-ms N] [--max-bars N]\n"
+        "    [--cpu N] [--duration SECONDS] [--idle-seconds SECONDS] [--symbol NAME] [--tick-size VALUE]\n"
+        "    [--input N=VALUE]... [--quiet]\n");
+}
+
+static bool ParseInput(const char* Text, s_HeadlessInput& Input)
+{
+    const char* Equals = std::strchr(Text, '=');
+    if (Equals == NULL || Equals == Text)
+        return false;
+
+    Input.Index = std::atoi(Text);
+    Input.Text = Equals + 1;
+    return Input.Index >= 0 && Input.Index < SC_INPUTS_AVAILABLE;
+}
+
+int main(int argc, char** argv)
+{
+    const s_StudyEntry* Study = NULL;
+    const char* Feed_Text = NULL;
+    const char* Interface = NULL;
+    const char* Signals_Text = NULL;
+    const char* Symbol = "HEADLESS";
+    float Tick_Size = 0.25f;
+    int Bar_Seconds = 60;
+    int Close_Delay_Milliseconds = 5;
+    int Max_Bars = 262144;
+    int Cpu = -1;
+    double Duration_Seconds = 0.0;
+    double Idle_Seconds = 0.0;
+    bool Quiet = false;
+    std::vector<s_HeadlessInput> Inputs;
+
+    for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++)
+    {
+        const char* Argument = argv[ArgumentIndex];
+        const char* Value = ArgumentIndex + 1 < argc ? argv[ArgumentIndex + 1] : NULL;
+
+        if (std::strcmp(Argument, "--quiet") == 0)
+        {
+            Quiet = true;
+            continue;
+        }
+
+        if (Value == NULL)
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        ArgumentIndex++;
+
+        if (std::strcmp(Argument, "--study") == 0)
+        {
+            for (size_t StudyIndex = 0; StudyIndex < sizeof(s_Studies) / sizeof(s_Studies[0]); StudyIndex++)
+            {
+                if (std::strcmp(Value, s_Studies[StudyIndex].Name) == 0)
+                    Study = &s_Studies[StudyIndex];
+            }
+
+            if (Study == NULL)
+            {
+                std::fprintf(stderr, "unknown study %s\n", Value);
+                return 2;
+            }
+        }
+        else if (std::strcmp(Argument, "--feed") == 0)
+            Feed_Text = Value;
+        else if (std::strcmp(Argument, "--interface") == 0)
+            Interface = Value;
+        else if (std::strcmp(Argument, "--signals") == 0)
+            Signals_Text = Value;
+        else if (std::strcmp(Argument, "--bar-seconds") == 0)
+            Bar_Seconds = std::atoi(Value);
+        else if (std::strcmp(Argument, "--close-delay-ms") == 0)
+            Close_Delay_Milliseconds = std::atoi(Value);
+        else if (std::strcmp(Argument, "--max-bars") == 0)
+            Max_Bars = std::atoi(Value);
+        else if (std::strcmp(Argument, "--cpu") == 0)
+            Cpu = std::atoi(Value);
+        else if (std::strcmp(Argument, "--duration") == 0)
+            Duration_Seconds = std::atof(Value);
+        else if (std::strcmp(Argument, "--idle-seconds") == 0)
+            Idle_Seconds = std::atof(Value);
+        else if (std::strcmp(Argument, "--symbol") == 0)
+            Symbol = Value;
+        else if (std::strcmp(Argument, "--tick-size") == 0)
+            Tick_Size = static_cast<float>(std::atof(Value));
+        else if (std::strcmp(Argument, "--input") == 0)
+        {
+            s_HeadlessInput Input;
+            if (!ParseInput(Value, Input))
+            {
+                std::fprintf(stderr, "bad input %s, expected N=VALUE\n", Value);
+                return 2;
+            }
+
+            Inputs.push_back(Input);
+        }
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (Study == NULL || Feed_Text == NULL || Bar_Seconds <= 0 || Max_Bars <= 0)
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    sockaddr_in Feed_Address;
+    sockaddr_in Signals_Address;
+    std::string Error;
+
+    if (!LiveFeed_ParseAddress(Feed_Text, Feed_Address))
+    {
+        std::fprintf(stderr, "bad feed address %s, expected ADDRESS:PORT\n", Feed_Text);
+        return 2;
+    }
+
+    if (Signals_Text != NULL && !LiveFeed_ParseAddress(Signals_Text, Signals_Address))
+    {
+        std::fprintf(stderr, "bad signals address %s, expected ADDRESS:PORT\n", Signals_Text);
+        return 2;
+    }
+
+    c_LiveSocket Feed;
+    if (!Feed.OpenReceiver(Feed_Address, Interface, Error))
+    {
+        std::fprintf(stderr, "%s: %s\n", Feed_Text, Error.c_str());
+        return 1;
+    }
+
+    c_LiveSocket Signals;
+    if (Signals_Text != NULL && !Signals.OpenSender(Signals_Address, 1, Error))
+    {
+        std::fprintf(stderr, "%s: %s\n", Signals_Text, Error.c_str());
+        return 1;
+    }
+
+    if (Cpu >= 0 && !LiveFeed_PinThread(Cpu))
+        std::fprintf(stderr, "could not pin the polling thread to CPU %d, running unpinned\n", Cpu);
+
+    std::signal(SIGINT, OnStopSignal);
+    std::signal(SIGTERM, OnStopSignal);
+
+    c_LiveChart Chart(Symbol, Tick_Size, Bar_Seconds, Max_Bars);
+    Chart.Start(Study->Function, Inputs, !Quiet);
+
+    s_SignalOutput Output;
+    Output.p_Socket = Signals.IsOpen() ? &Signals : NULL;
+    Chart.SetEntryCallback(SendSignal, &Output);
+
+    // Every counter and buffer is set up before the loop; nothing below allocates.
+    s_LiveTradeMessage Datagram[LIVE_TRADES_PER_DATAGRAM * 2];
+    s_TimingHistogram Datagram_Latency;
+    unsigned long long Datagrams = 0;
+    unsigned long long Trades = 0;
+    unsigned long long Missing = 0;
+    unsigned long long Duplicates = 0;
+    unsigned long long Malformed = 0;
+    unsigned long long Clock_Closes = 0;
+    unsigned long long Expected_Sequence = 0;
+    unsigned int Idle_Polls = 0;
+    bool Full = false;
+    bool Receive_Failed = false;
+
+    const long long Close_Delay = Close_Delay_Milliseconds * 1000000LL;
+    const long long Start_Time = SteadyNanoseconds();
+    long long Last_Trade_Time = 0;
+    long long Last_Trade_Arrival = 0;
+
+    while (!s_StopRequested && !Full)
+    {
+        const int Received = Feed.Receive(Datagram, sizeof(Datagram));
+
+        if (Received > 0)
+        {
+            const long long Arrival = SteadyNanoseconds();
+            const int Count = Received / static_cast<int>(sizeof(s_LiveTradeMessage));
+
+            Datagrams++;
+            if (Received % sizeof(s_LiveTradeMessage) != 0)
+                Malformed++;
+
+            for (int TradeIndex = 0; TradeIndex < Count; TradeIndex++)
+            {
+                const s_LiveTradeMessage& Trade = Datagram[TradeIndex];
+
+                if (Expected_Sequence != 0 && Trade.Sequence < Expected_Sequence)
+                {
+                    Duplicates++;
+                    continue;
+                }
+
+                if (Expected_Sequence != 0 && Trade.Sequence > Expected_Sequence)
+                    Missing += Trade.Sequence - Expected_Sequence;
+
+                Expected_Sequence = Trade.Sequence + 1;
+
+                if (!Chart.Apply(Trade))
+                {
+                    std::fprintf(stderr, "all %d bars are used, stopping (see --max-bars)\n", Max_Bars);
+                    Full = true;
+                    break;
+                }
+
+                Trades++;
+                Output.TradeSequence = Trade.Sequence;
+                Output.TradeTime = Trade.Time;
+                Last_Trade_Time = Trade.Time;
+                Last_Trade_Arrival = Arrival;
+            }
+
+            if (Chart.Update())
+                Datagram_Latency.Add(static_cast<unsigned long long>(SteadyNanoseconds() - Arrival));
+
+            Idle_Polls = 0;
+            continue;
+        }
+
+        if (Received < 0)
+        {
+            std::fprintf(stderr, "%s: receive failed: %s\n", Feed_Text, std::strerror(errno));
+            Receive_Failed = true;
+            break;
+        }
+
+        // The clock is read every 64 empty polls, about every few microseconds.
+        if ((++Idle_Polls & 63) == 0)
+        {
+            const long long Now = SteadyNanoseconds();
+
+            if (Chart.LastBarOpen() && Last_Trade_Time + (Now - Last_Trade_Arrival) >= Chart.LastBarEnd() + Close_Delay)
+            {
+                if (Chart.CloseLastBar())
+                    Clock_Closes++;
+            }
+
+            if (Duration_Seconds > 0.0 && Now - Start_Time >= static_cast<long long>(Duration_Seconds * 1e9))
+                break;
+
+            if (Idle_Seconds > 0.0 && Trades > 0 && Now - Last_Trade_Arrival >= static_cast<long long>(Idle_Seconds * 1e9))
+                break;
+        }
+
+        LiveFeed_CpuRelax();
+    }
+
+    s_HeadlessResult Result;
+    const int Bars = Chart.BarCount();
+    const unsigned long long Calls = Chart.Calls();
+    const unsigned long long Late = Chart.LateTrades();
+    Chart.Finish(Result);
+
+    std::fprintf(stderr, "trades %llu, datagrams %llu, missing %llu, duplicates %llu, late %llu, malformed %llu\n",
+        Trades, Datagrams, Missing, Duplicates, Late, Malformed);
+    std::fprintf(stderr, "bars %d, study calls %llu, closed on the clock %llu, signals %llu, signal send failures %llu\n",
+        Bars, Calls, Clock_Closes, Output.Sequence, Output.SendFailures);
+    std::fprintf(stderr, "simulated account: trades %d, net profit %.6f\n", Result.Stats.Trades, Result.Stats.NetProfit);
+
+    // The histogram holds steady clock nanoseconds here, not TSC counts.
+    if (Datagram_Latency.Count > 0)
+    {
+        std::fprintf(stderr, "datagram to study return: %llu samples, p50 %.3f us, p99 %.3f us, max %.3f us\n",
+            Datagram_Latency.Count, Datagram_Latency.Percentile(0.50) / 1e3, Datagram_Latency.Percentile(0.99) / 1e3,
+            Datagram_Latency.Maximum / 1e3);
+    }
+
+    return Receive_Failed ? 1 : 0;
+}
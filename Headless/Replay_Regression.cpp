@@ -0,0 +1,1110 @@
+// With STUDY_ALLOCATION_COUNTER, this program defines the counting operator new (Study_Arena.h).
+#define STUDY_ALLOCATION_COUNTER_OPERATORS 1
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "sierrachart.h"
+#include "Headless_Host.h"
+#include "Scid_File.h"
+#include "Signal_Backtest.h"
+#include "../Crossover_Index.h"
+#include "../Crossover_Sweep.h"
+#include "../MA_Adaptive_Kernels.h"
+#include "../MA_Batch_Kernels.h"
+#include "../MA_Fixed_Kernels.h"
+#include "../MA_Kernels.h"
+
+/*
+Replay regression suite for the moving average kernels: every kernel against the direct definition of its average, bar for bar, with the crosses and trades that follow from them.
+
+The reference of each average is its textbook definition computed directly in double, each bar from its whole window: the window mean of the SMA, the EMA and ZLEMA recurrences from In[0], the Hull average over float rounded WMAs, and the KAMA, ALMA, T3 and VWMA of MA_Adaptive_Kernels.h.
+These are this tool's own definitions, not outputs of sc.SimpleMovAvg, sc.ExponentialMovAvg, sc.HullMovingAverage or the other Sierra Chart functions, which the headless sierrachart.h does not have. They check the kernels against the definitions of the averages; they do not show that the kernels give Sierra Chart's values.
+Every fast/slow pair of --pairs is then computed in each mode of the average:
+batch - the full recalculation kernels (MA_Batch_Kernels.h, AVX2 when the CPU has it, and MA_Adaptive_Kernels.h).
+batch_scalar - the same kernels forced to the scalar path (SMA, EMA, ZLEMA, HMA).
+bar - the incremental kernels (MA_Kernels.h, MA_Adaptive_Kernels.h), one Update per new bar.
+tick - the same kernels with --ticks updates per bar: the live bar moves around its close (and its volume grows) before the last update with its final values, as on a chart with a live feed.
+bar_pair, tick_pair - the fused Hull kernel of both averages (s_HMAPairKernel).
+bar_fixed, tick_fixed - the compile-time kernels of the fixed-period studies (MA_Fixed_Kernels.h), for the pairs 9/21 (EMA) and 16/64 (HMA).
+study - the crossover study replayed bar by bar through c_HeadlessChart. Its averages are the values of its Faster and Slower subgraphs after the last bar, checked like the other modes, and its trades are the replay's.
+sweep - the parameter sweep's averages of the pair (c_SweepAverages, Crossover_Sweep.h), for the SMA, EMA, ZLEMA and HMA. The sweep's SMA and HMA are meant to be the studies' values, so there StudyDiffs counts the values that are not bit for bit the study's subgraphs, and any fails the mode.
+A mode that checked no values fails, so a mode cannot pass without testing anything.
+A mode passes when every value of both averages is within --tolerance of the reference, relative to the reference value (or absolute below 1), and its crosses (Crossover_BuildIndex, the rule of sc.CrossOver) and trades (c_SignalBacktest::RunAverages with the study's default bracket) are the reference's.
+A cross may only move where the reference averages are within the tolerance of each other, since the order of two values that equal up to rounding is not defined by either computation. Those crosses are counted as ties, and the mode's trades may differ from the reference's there; any other difference fails.
+BatchDiffs counts the values that are not bit for bit those of the batch mode. It is 0 where a study's full recalculation and its live updates agree exactly; the AVX2 EMA recurrences (ZLEMA) round a few values differently from the scalar ones.
+The time of each mode is one run over the whole dataset, both averages of the pair: NsPerBar, and NsPerUpdate per update of the tick modes.
+
+One CSV line per dataset, average, pair and mode is written to standard output, and a summary to standard error. The exit code is 1 when a check failed.
+
+crossover_regression [--bars FILE]... [options]
+--bars FILE          a bar text export or a .scid file (repeatable); without one, a synthetic random walk is used
+--bar-seconds N      for a .scid file, builds N second bars from the records (default 0, one bar per record)
+--synthetic-bars N   bars of the synthetic dataset (default 200000)
+--pairs F/S,...      the fast/slow pairs (default 9/21,16/64,50/200)
+--ticks N            updates per bar of the tick modes (default 4)
+--tolerance VALUE    relative tolerance of the values (default 1e-6)
+--tick-size VALUE    sc.TickSize, and the step of the tick modes' live prices (default 0.25)
+--filter TEXT        only the checks whose MA/mode name contains TEXT
+*/
+
+SCSFExport scsf_SMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_EMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_ZLEMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_Hull_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_KAMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_ALMA_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_T3_Crossover_Trading(SCStudyInterfaceRef sc);
+SCSFExport scsf_VWMA_Crossover_Trading(SCStudyInterfaceRef sc);
+
+enum e_RegressionMA
+{
+    REGRESSION_MA_SMA = 0,
+    REGRESSION_MA_EMA = 1,
+    REGRESSION_MA_ZLEMA = 2,
+    REGRESSION_MA_HMA = 3,
+    REGRESSION_MA_KAMA = 4,
+    REGRESSION_MA_ALMA = 5,
+    REGRESSION_MA_T3 = 6,
+    REGRESSION_MA_VWMA = 7,
+    REGRESSION_MA_COUNT = 8
+};
+
+enum e_RegressionMode
+{
+    REGRESSION_MODE_BATCH = 0,
+    REGRESSION_MODE_BATCH_SCALAR = 1,
+    REGRESSION_MODE_BAR = 2,
+    REGRESSION_MODE_TICK = 3,
+    REGRESSION_MODE_BAR_PAIR = 4,
+    REGRESSION_MODE_TICK_PAIR = 5,
+    REGRESSION_MODE_BAR_FIXED = 6,
+    REGRESSION_MODE_TICK_FIXED = 7,
+    REGRESSION_MODE_STUDY = 8,
+    REGRESSION_MODE_SWEEP = 9,
+    REGRESSION_MODE_COUNT = 10
+};
+
+static const char* const s_ModeLabels[REGRESSION_MODE_COUNT] =
+{
+    "batch", "batch_scalar", "bar", "tick", "bar_pair", "tick_pair", "bar_fixed", "tick_fixed", "study", "sweep"
+};
+
+struct s_RegressionMA
+{
+    const char* Label;
+    SCStudyFunction Study;
+    bool Scalar;
+    // The average's e_SweepMAType, or -1 when the sweep does not have it.
+    int SweepType;
+};
+
+static const s_RegressionMA s_MAs[REGRESSION_MA_COUNT] =
+{
+    { "SMA", scsf_SMA_Crossover_Trading, true, SWEEP_MA_SMA },
+    { "EMA", scsf_EMA_Crossover_Trading, true, SWEEP_MA_EMA },
+    { "ZLEMA", scsf_ZLEMA_Crossover_Trading, true, SWEEP_MA_ZLEMA },
+    { "HMA", scsf_Hull_Crossover_Trading, true, SWEEP_MA_HULL },
+    { "KAMA", scsf_KAMA_Crossover_Trading, false, -1 },
+    { "ALMA", scsf_ALMA_Crossover_Trading, false, -1 },
+    { "T3", scsf_T3_Crossover_Trading, false, -1 },
+    { "VWMA", scsf_VWMA_Crossover_Trading, false, -1 },
+};
+
+struct s_RegressionOptions
+{
+    std::vector<std::string> BarPaths;
+    int BarSeconds;
+    int SyntheticBars;
+    int Ticks;
+    double Tolerance;
+    float TickSize;
+    std::vector<s_SweepPair> Pairs;
+    std::string Filter;
+
+    s_RegressionOptions()
+        : BarSeconds(0)
+        , SyntheticBars(200000)
+        , Ticks(4)
+        , Tolerance(1e-6)
+        , TickSize(0.25f)
+    {
+    }
+};
+
+// The inputs of one dataset. The tick modes move the live bar in copies of them.
+struct s_RegressionData
+{
+    const float* FastIn;
+    const float* SlowIn;
+    const float* Volume;
+    int Count;
+};
+
+struct s_RegressionCheck
+{
+    long long Values;
+    long long Mismatches;
+    long long BatchDiffs;
+    long long StudyDiffs;
+    double MaxAbsDiff;
+    double MaxRelDiff;
+    int Crosses;
+    int CrossMismatches;
+    int CrossTies;
+    int Trades;
+    int ReferenceTrades;
+    double NanosecondsPerBar;
+    double NanosecondsPerUpdate;
+
+    s_RegressionCheck()
+        : Values(0)
+        , Mismatches(0)
+        , BatchDiffs(0)
+        , StudyDiffs(0)
+        , MaxAbsDiff(0.0)
+        , MaxRelDiff(0.0)
+        , Crosses(0)
+        , CrossMismatches(0)
+        , CrossTies(0)
+        , Trades(0)
+        , ReferenceTrades(0)
+        , NanosecondsPerBar(0.0)
+        , NanosecondsPerUpdate(0.0)
+    {
+    }
+};
+
+//================================================================================================//
+// Reference definitions, in double over the whole window of every bar. Bars before the average has its window are 0, as in the kernels.
+
+static void Reference_SMA(const float* In, float* Out, int Count, int Length)
+{
+    for (int Index = 0; Index < Count; Index++)
+    {
+        if (Index < Length - 1)
+        {
+            Out[Index] = 0.0f;
+            continue;
+        }
+
+        double Sum = 0.0;
+        for (int Offset = Index - Length + 1; Offset <= Index; Offset++)
+            Sum += In[Offset];
+
+        Out[Index] = static_cast<float>(Sum / Length);
+    }
+}
+
+static void Reference_EMA(const float* In, float* Out, int Count, int Length, bool ZeroLag)
+{
+    const double Alpha = 2.0 / (Length + 1);
+    const int Lag = ZeroLag ? (Length - 1) / 2 : 0;
+    double Value = 0.0;
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        const double Term = Lag > 0 && Index >= Lag ? 2.0 * In[Index] - In[Index - Lag] : In[Index];
+        Value = Index == 0 ? In[0] : Alpha * Term + (1.0 - Alpha) * Value;
+        Out[Index] = static_cast<float>(Value);
+    }
+}
+
+static void Reference_WMA(const float* In, float* Out, int Count, int Length)
+{
+    const double Norm = 0.5 * Length * (Length + 1);
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        if (Index < Length - 1)
+        {
+            Out[Index] = 0.0f;
+            continue;
+        }
+
+        double Sum = 0.0;
+        for (int Weight = 1; Weight <= Length; Weight++)
+            Sum += static_cast<double>(Weight) * In[Index - Length + Weight];
+
+        Out[Index] = static_cast<float>(Sum / Norm);
+    }
+}
+
+// WMA(2 * WMA(Length / 2) - WMA(Length), sqrt(Length)), each WMA kept as a float array.
+static void Reference_HMA(const float* In, float* Out, int Count, int Length)
+{
+    std::vector<float> Half(Count), Full(Count), Diff(Count, 0.0f);
+    Reference_WMA(In, &Half[0], Count, MA_HullHalfLength(Length));
+    Reference_WMA(In, &Full[0], Count, Length);
+
+    const int First = Length - 1 < Count ? Length - 1 : Count;
+    for (int Index = First; Index < Count; Index++)
+        Diff[Index] = 2.0f * Half[Index] - Full[Index];
+
+    for (int Index = 0; Index < First; Index++)
+        Out[Index] = 0.0f;
+
+    Reference_WMA(&Diff[First], Out + First, Count - First, MA_HullRootLength(Length));
+}
+
+static void Reference_KAMA(const float* In, float* Out, int Count, int Length)
+{
+    double Value = 0.0;
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        if (Index < Length - 1)
+        {
+            Out[Index] = 0.0f;
+            continue;
+        }
+
+        if (Index == Length - 1)
+        {
+            Value = In[Index];
+            Out[Index] = In[Index];
+            continue;
+        }
+
+        double Volatility = 0.0;
+        for (int Offset = Index - Length + 1; Offset <= Index; Offset++)
+            Volatility += std::fabs(static_cast<double>(In[Offset]) - In[Offset - 1]);
+
+        const double Change = std::fabs(static_cast<double>(In[Index]) - In[Index - Length]);
+        const double Efficiency = Volatility > 0.0 ? Change / Volatility : 0.0;
+        const double Smoothing = Efficiency * (MA_KAMA_FAST_ALPHA - MA_KAMA_SLOW_ALPHA) + MA_KAMA_SLOW_ALPHA;
+
+        Value += Smoothing * Smoothing * (In[Index] - Value);
+        Out[Index] = static_cast<float>(Value);
+    }
+}
+
+static void Reference_ALMA(const float* In, float* Out, int Count, int Length)
+{
+    const double Peak = MA_ALMA_OFFSET * (Length - 1);
+    const double Width = Length / MA_ALMA_SIGMA;
+
+    std::vector<double> Weights(Length);
+    double Norm = 0.0;
+    for (int Offset = 0; Offset < Length; Offset++)
+    {
+        Weights[Offset] = std::exp(-(Offset - Peak) * (Offset - Peak) / (2.0 * Width * Width));
+        Norm += Weights[Offset];
+    }
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        if (Index < Length - 1)
+        {
+            Out[Index] = 0.0f;
+            continue;
+        }
+
+        double Sum = 0.0;
+        for (int Offset = 0; Offset < Length; Offset++)
+            Sum += Weights[Offset] * In[Index - Length + 1 + Offset];
+
+        Out[Index] = static_cast<float>(Sum / Norm);
+    }
+}
+
+static void Reference_T3(const float* In, float* Out, int Count, int Length)
+{
+    const double Alpha = 2.0 / (Length + 1);
+    const double V = MA_T3_VOLUME_FACTOR;
+    const double C1 = -V * V * V;
+    const double C2 = 3.0 * V * V + 3.0 * V * V * V;
+    const double C3 = -6.0 * V * V - 3.0 * V - 3.0 * V * V * V;
+    const double C4 = 1.0 + 3.0 * V + 3.0 * V * V + V * V * V;
+    double Stages[6];
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        double Stage_In = In[Index];
+        for (int Stage = 0; Stage < 6; Stage++)
+        {
+            Stages[Stage] = Index == 0 ? Stage_In : Alpha * Stage_In + (1.0 - Alpha) * Stages[Stage];
+            Stage_In = Stages[Stage];
+        }
+
+        Out[Index] = static_cast<float>(C1 * Stages[5] + C2 * Stages[4] + C3 * Stages[3] + C4 * Stages[2]);
+    }
+}
+
+static void Reference_VWMA(const float* In, const float* Volume, float* Out, int Count, int Length)
+{
+    for (int Index = 0; Index < Count; Index++)
+    {
+        if (Index < Length - 1)
+        {
+            Out[Index] = 0.0f;
+            continue;
+        }
+
+        double PriceVolume = 0.0;
+        double Total_Volume = 0.0;
+        double Price = 0.0;
+        for (int Offset = Index - Length + 1; Offset <= Index; Offset++)
+        {
+            PriceVolume += static_cast<double>(In[Offset]) * Volume[Offset];
+            Total_Volume += Volume[Offset];
+            Price += In[Offset];
+        }
+
+        Out[Index] = static_cast<float>(Total_Volume > 0.0 ? PriceVolume / Total_Volume : Price / Length);
+    }
+}
+
+static void Regression_Reference(int MA, const float* In, const float* Volume, float* Out, int Count, int Length)
+{
+    switch (MA)
+    {
+        case REGRESSION_MA_SMA: Reference_SMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_EMA: Reference_EMA(In, Out, Count, Length, false); break;
+        case REGRESSION_MA_ZLEMA: Reference_EMA(In, Out, Count, Length, true); break;
+        case REGRESSION_MA_HMA: Reference_HMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_KAMA: Reference_KAMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_ALMA: Reference_ALMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_T3: Reference_T3(In, Out, Count, Length); break;
+        case REGRESSION_MA_VWMA: Reference_VWMA(In, Volume, Out, Count, Length); break;
+    }
+}
+
+// The crosses of the reference averages, bar by bar by the rule of sc.CrossOver.
+static void Reference_Crosses(const float* Fast, const float* Slow, int Count, std::vector<s_CrossoverEvent>& Crosses)
+{
+    Crosses.clear();
+    int Previous_Sign = 0;
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        const float Difference = Fast[Index] - Slow[Index];
+        const int Sign = Difference > 0.0f ? 1 : (Difference < 0.0f ? -1 : 0);
+        if (Sign == 0)
+            continue;
+
+        if (Previous_Sign != 0 && Sign != Previous_Sign)
+        {
+            s_CrossoverEvent Cross;
+            Cross.BarIndex = Index;
+            Cross.Direction = Sign;
+            Crosses.push_back(Cross);
+        }
+
+        Previous_Sign = Sign;
+    }
+}
+
+//================================================================================================//
+// The modes
+
+static void Regression_Batch(int MA, const float* In, const float* Volume, float* Out, float* Scratch, int Count, int Length, bool Scalar)
+{
+    switch (MA)
+    {
+        case REGRESSION_MA_SMA: Scalar ? MA_Batch_SMA_Scalar(In, Out, Count, Length) : MA_Batch_SMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_EMA: Scalar ? MA_Batch_EMA_Scalar(In, Out, Count, Length) : MA_Batch_EMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_ZLEMA: Scalar ? MA_Batch_ZLEMA_Scalar(In, Out, Count, Length) : MA_Batch_ZLEMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_HMA: Scalar ? MA_Batch_HMA_Scalar(In, Out, Scratch, Count, Length) : MA_Batch_HMA(In, Out, Scratch, Count, Length); break;
+        case REGRESSION_MA_KAMA: MA_Batch_KAMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_ALMA: MA_Batch_ALMA(In, Out, Count, Length); break;
+        case REGRESSION_MA_T3: MA_Batch_T3(In, Out, Count, Length); break;
+        case REGRESSION_MA_VWMA: MA_Batch_VWMA(In, Volume, Out, Count, Length); break;
+    }
+}
+
+static float Regression_Update(s_SMAKernel& Kernel, const float* In, const float*, const float*, int Index, int Length)
+{
+    return Kernel.Update(In, Index, Length);
+}
+
+static float Regression_Update(s_EMAKernel& Kernel, const float* In, const float*, const float* Out, int Index, int Length)
+{
+    return Kernel.Update(In, Out, Index, Length);
+}
+
+static float Regression_Update(s_HMAKernel& Kernel, const float* In, const float*, const float*, int Index, int Length)
+{
+    return Kernel.Update(In, Index, Length);
+}
+
+static float Regression_Update(s_KAMAKernel& Kernel, const float* In, const float*, const float* Out, int Index, int Length)
+{
+    return Kernel.Update(In, Out, Index, Length);
+}
+
+static float Regression_Update(s_ALMAKernel& Kernel, const float* In, const float*, const float*, int Index, int Length)
+{
+    return Kernel.Update(In, Index, Length);
+}
+
+static float Regression_Update(s_T3Kernel& Kernel, const float* In, const float*, const float*, int Index, int Length)
+{
+    return Kernel.Update(In, Index, Length);
+}
+
+static float Regression_Update(s_VWMAKernel& Kernel, const float* In, const float* Volume, const float*, int Index, int Length)
+{
+    return Kernel.Update(In, Volume, Index, Length);
+}
+
+// The incremental kernels of both averages, each on its own (the default s_CrossoverKernels of the engine).
+template <typename KernelType>
+struct s_RegressionKernels
+{
+    KernelType Fast;
+    KernelType Slow;
+
+    void Update(const float* FastIn, const float* SlowIn, const float* Volume, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        FastOut[Index] = Regression_Update(Fast, FastIn, Volume, FastOut, Index, FastLength);
+        SlowOut[Index] = Regression_Update(Slow, SlowIn, Volume, SlowOut, Index, SlowLength);
+    }
+};
+
+struct s_RegressionHMAPair
+{
+    s_HMAPairKernel Kernel;
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int FastLength, int SlowLength)
+    {
+        Kernel.Update(FastIn, SlowIn, Index, FastLength, SlowLength, FastOut[Index], SlowOut[Index]);
+    }
+};
+
+template <int FastLength, int SlowLength>
+struct s_RegressionEMAFixed
+{
+    s_EMAFixedKernel<FastLength> Fast;
+    s_EMAFixedKernel<SlowLength> Slow;
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int, int)
+    {
+        FastOut[Index] = Fast.Update(FastIn, FastOut, Index);
+        SlowOut[Index] = Slow.Update(SlowIn, SlowOut, Index);
+    }
+};
+
+template <int FastLength, int SlowLength>
+struct s_RegressionHMAFixed
+{
+    s_HMAPairFixedKernel<FastLength, SlowLength> Kernel;
+
+    void Update(const float* FastIn, const float* SlowIn, const float*, float* FastOut, float* SlowOut, int Index, int, int)
+    {
+        Kernel.Update(FastIn, SlowIn, Index, FastOut[Index], SlowOut[Index]);
+    }
+};
+
+// One pass over the bars with Ticks updates of each: Ticks - 1 with the live price moved around the final one and part of the bar's volume, then the final values.
+// The inputs are copies, so the closed bars the kernels resync from always hold their final values.
+template <typename PairType>
+static void Regression_Steps(PairType& Pair, const s_RegressionData& Data, float* FastLive, float* SlowLive, float* VolumeLive, float* FastOut, float* SlowOut,
+    int FastLength, int SlowLength, int Ticks, float TickSize)
+{
+    for (int Index = 0; Index < Data.Count; Index++)
+    {
+        for (int Tick = 0; Tick + 1 < Ticks; Tick++)
+        {
+            const float Offset = static_cast<float>(Tick % 5 - 2) * TickSize;
+            FastLive[Index] = Data.FastIn[Index] + Offset;
+            SlowLive[Index] = Data.SlowIn[Index] + Offset;
+            VolumeLive[Index] = Data.Volume[Index] * static_cast<float>(Tick + 1) / Ticks;
+            Pair.Update(FastLive, SlowLive, VolumeLive, FastOut, SlowOut, Index, FastLength, SlowLength);
+        }
+
+        FastLive[Index] = Data.FastIn[Index];
+        SlowLive[Index] = Data.SlowIn[Index];
+        VolumeLive[Index] = Data.Volume[Index];
+        Pair.Update(FastLive, SlowLive, VolumeLive, FastOut, SlowOut, Index, FastLength, SlowLength);
+    }
+}
+
+template <typename PairType>
+static void Regression_Pair(const s_RegressionData& Data, float* FastLive, float* SlowLive, float* VolumeLive, float* FastOut, float* SlowOut,
+    int FastLength, int SlowLength, int Ticks, float TickSize)
+{
+    PairType Pair;
+    Regression_Steps(Pair, Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize);
+}
+
+// Whether the mode exists for this average and pair.
+static bool Regression_HasMode(int MA, int Mode, int FastLength, int SlowLength)
+{
+    switch (Mode)
+    {
+        case REGRESSION_MODE_BATCH_SCALAR:
+            return s_MAs[MA].Scalar;
+
+        case REGRESSION_MODE_BAR_PAIR:
+        case REGRESSION_MODE_TICK_PAIR:
+            return MA == REGRESSION_MA_HMA;
+
+        case REGRESSION_MODE_BAR_FIXED:
+        case REGRESSION_MODE_TICK_FIXED:
+            return (MA == REGRESSION_MA_EMA && FastLength == 9 && SlowLength == 21)
+                || (MA == REGRESSION_MA_HMA && FastLength == 16 && SlowLength == 64);
+
+        case REGRESSION_MODE_SWEEP:
+            return s_MAs[MA].SweepType >= 0;
+    }
+
+    return true;
+}
+
+// The incremental modes. Ticks is 1 for the bar modes.
+static void Regression_Incremental(int MA, int Mode, const s_RegressionData& Data, float* FastLive, float* SlowLive, float* VolumeLive, float* FastOut, float* SlowOut,
+    int FastLength, int SlowLength, int Ticks, float TickSize)
+{
+    if (Mode == REGRESSION_MODE_BAR_PAIR || Mode == REGRESSION_MODE_TICK_PAIR)
+    {
+        Regression_Pair<s_RegressionHMAPair>(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize);
+        return;
+    }
+
+    if (Mode == REGRESSION_MODE_BAR_FIXED || Mode == REGRESSION_MODE_TICK_FIXED)
+    {
+        if (MA == REGRESSION_MA_EMA)
+            Regression_Pair<s_RegressionEMAFixed<9, 21> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize);
+        else
+            Regression_Pair<s_RegressionHMAFixed<16, 64> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize);
+
+        return;
+    }
+
+    switch (MA)
+    {
+        case REGRESSION_MA_SMA: Regression_Pair<s_RegressionKernels<s_SMAKernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+        case REGRESSION_MA_EMA: Regression_Pair<s_RegressionKernels<s_EMAKernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+        case REGRESSION_MA_ZLEMA: Regression_Pair<s_RegressionKernels<s_ZLEMAKernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+        case REGRESSION_MA_HMA: Regression_Pair<s_RegressionKernels<s_HMAKernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+        case REGRESSION_MA_KAMA: Regression_Pair<s_RegressionKernels<s_KAMAKernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+        case REGRESSION_MA_ALMA: Regression_Pair<s_RegressionKernels<s_ALMAKernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+        case REGRESSION_MA_T3: Regression_Pair<s_RegressionKernels<s_T3Kernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+        case REGRESSION_MA_VWMA: Regression_Pair<s_RegressionKernels<s_VWMAKernel> >(Data, FastLive, SlowLive, VolumeLive, FastOut, SlowOut, FastLength, SlowLength, Ticks, TickSize); break;
+    }
+}
+
+// The sweep's average of one period, 0 before it has its window as in the kernels.
+static void Regression_Sweep(int Type, const float* In, float* Out, int Count, int Length)
+{
+    c_SweepAverages Averages;
+    Averages.Init(Type, std::vector<int>(1, Length));
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        Averages.Step(In, Index);
+        Out[Index] = Averages.IsReady(0) ? Averages.Value(0) : 0.0f;
+    }
+}
+
+//================================================================================================//
+// Comparisons
+
+static void Regression_CompareValues(const float* Values, const float* Reference, const float* Batch, int Count, double Tolerance, s_RegressionCheck& Check)
+{
+    for (int Index = 0; Index < Count; Index++)
+    {
+        const double Difference = std::fabs(static_cast<double>(Values[Index]) - Reference[Index]);
+        const double Scale = std::max(std::fabs(static_cast<double>(Reference[Index])), 1.0);
+
+        Check.Values++;
+        if (!(Difference <= Tolerance * Scale))
+            Check.Mismatches++;
+        if (Values[Index] != Batch[Index])
+            Check.BatchDiffs++;
+
+        Check.MaxAbsDiff = std::max(Check.MaxAbsDiff, Difference);
+        Check.MaxRelDiff = std::max(Check.MaxRelDiff, Difference / Scale);
+    }
+}
+
+// The bars where the reference averages are within the tolerance of each other, where either could be above once rounded.
+static void Regression_TieBars(const float* Fast, const float* Slow, int Count, double Tolerance, std::vector<char>& Ties)
+{
+    Ties.assign(Count, 0);
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        const double Band = 2.0 * Tolerance * (std::max(std::fabs(static_cast<double>(Fast[Index])), 1.0) + std::max(std::fabs(static_cast<double>(Slow[Index])), 1.0));
+        Ties[Index] = std::fabs(static_cast<double>(Fast[Index]) - Slow[Index]) <= Band;
+    }
+}
+
+// A cross that is in one list and not the other is a tie when its bar or the bar before it is a tie bar:
+// with both signs outside the band, the sign before the bar and at the bar are the reference's, and so is the cross.
+static void Regression_CompareCrosses(const std::vector<s_CrossoverEvent>& Crosses, const std::vector<s_CrossoverEvent>& Reference, const std::vector<char>& Ties, s_RegressionCheck& Check)
+{
+    size_t Position = 0;
+    size_t Reference_Position = 0;
+    Check.Crosses = static_cast<int>(Crosses.size());
+
+    while (Position < Crosses.size() || Reference_Position < Reference.size())
+    {
+        int BarIndex;
+
+        if (Reference_Position >= Reference.size() || (Position < Crosses.size() && Crosses[Position].BarIndex < Reference[Reference_Position].BarIndex))
+            BarIndex = Crosses[Position++].BarIndex;
+        else if (Position >= Crosses.size() || Reference[Reference_Position].BarIndex < Crosses[Position].BarIndex)
+            BarIndex = Reference[Reference_Position++].BarIndex;
+        else
+        {
+            const bool Same = Crosses[Position].Direction == Reference[Reference_Position].Direction;
+            BarIndex = Crosses[Position].BarIndex;
+            Position++;
+            Reference_Position++;
+
+            if (Same)
+                continue;
+        }
+
+        Check.CrossMismatches++;
+        if (Ties[BarIndex] || (BarIndex > 0 && Ties[BarIndex - 1]))
+            Check.CrossTies++;
+    }
+}
+
+// Values that are not bit for bit those of the study.
+static void Regression_CompareStudy(const float* Values, const float* Study, int Count, s_RegressionCheck& Check)
+{
+    for (int Index = 0; Index < Count; Index++)
+        Check.StudyDiffs += Values[Index] != Study[Index];
+}
+
+static bool Regression_SameTrades(const s_HeadlessResult& Result, const s_HeadlessResult& Reference)
+{
+    return Result.Stats.Trades == Reference.Stats.Trades
+        && Result.Stats.Wins == Reference.Stats.Wins
+        && Result.Stats.NetProfit == Reference.Stats.NetProfit
+        && Result.OpenDirection == Reference.OpenDirection;
+}
+
+// "ok", "tie" when crosses moved only at ties (the trades may then differ), or "FAIL".
+static const char* Regression_Status(const s_RegressionCheck& Check, bool SameTrades, bool PairHasTies)
+{
+    if (Check.Values == 0 || Check.Mismatches > 0 || Check.StudyDiffs > 0 || Check.CrossMismatches > Check.CrossTies)
+        return "FAIL";
+
+    if (!SameTrades && Check.CrossTies == 0 && !PairHasTies)
+        return "FAIL";
+
+    return Check.CrossTies > 0 || !SameTrades ? "tie" : "ok";
+}
+
+static bool Regression_Selected(const s_RegressionOptions& Options, int MA, int Mode)
+{
+    if (Options.Filter.empty())
+        return true;
+
+    const std::string Name = std::string(s_MAs[MA].Label) + "/" + s_ModeLabels[Mode];
+    return Name.find(Options.Filter) != std::string::npos;
+}
+
+//================================================================================================//
+// Datasets
+
+// A random walk on the tick grid with a volume that varies from bar to bar.
+static void Regression_Synthetic(s_BarData& Bars, int Count, float TickSize)
+{
+    Bars = s_BarData();
+    Bars.Reserve(Count);
+
+    unsigned int State = 12345u;
+    double Price = 4000.0;
+
+    for (int Index = 0; Index < Count; Index++)
+    {
+        State = State * 1664525u + 1013904223u;
+        const double Open = Price;
+        Price += (static_cast<int>(State >> 24) % 9 - 4) * TickSize;
+        if (Price < 100.0)
+            Price = 100.0;
+
+        Bars.DateTime.push_back(45000.0 + Index / 1440.0);
+        Bars.Open.push_back(static_cast<float>(Open));
+        Bars.High.push_back(static_cast<float>(std::max(Open, Price) + ((State >> 8) & 3) * TickSize));
+        Bars.Low.push_back(static_cast<float>(std::min(Open, Price) - ((State >> 12) & 3) * TickSize));
+        Bars.Close.push_back(static_cast<float>(Price));
+        Bars.Volume.push_back(static_cast<float>(1 + (State >> 16) % 500));
+        Bars.NumTrades.push_back(1.0f);
+        Bars.BidVolume.push_back(0.0f);
+        Bars.AskVolume.push_back(0.0f);
+    }
+}
+
+// Loads Path into Store as the backtester does.
+static bool Regression_Load(const char* Path, int BarSeconds, s_BarData& Bars, c_ScidFile& File, c_BarStore& Store)
+{
+    std::string Error;
+
+    const size_t Path_Length = std::strlen(Path);
+    if (Path_Length > 5 && std::strcmp(Path + Path_Length - 5, ".scid") == 0)
+    {
+        if (!File.Open(Path, Error))
+        {
+            std::fprintf(stderr, "%s\n", Error.c_str());
+            return false;
+        }
+
+        if (BarSeconds > 0)
+        {
+            Scid_ReadBars(File, 0, -1, BarSeconds, Bars);
+            Store.SetSource(Bars);
+        }
+        else
+            Store.SetSource(File);
+    }
+    else if (Bar_LoadTextFile(Path, Bars, Error))
+    {
+        Store.SetSource(Bars);
+    }
+    else
+    {
+        std::fprintf(stderr, "%s\n", Error.c_str());
+        return false;
+    }
+
+    if (Store.Count() < 2)
+    {
+        std::fprintf(stderr, "too few bars in %s\n", Path);
+        return false;
+    }
+
+    return true;
+}
+
+static double Regression_Elapsed(const std::chrono::steady_clock::time_point& Start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+}
+
+// The checks of every average, pair and mode on one dataset at a time. The buffers are kept from one pair to the next.
+class c_Regression
+{
+public:
+    c_Regression(const s_RegressionOptions& Options)
+        : m_Options(Options)
+        , m_Checks(0)
+        , m_Failed(0)
+        , m_Tied(0)
+    {
+        m_Inputs.resize(2);
+        m_Inputs[0].Index = 0;
+        m_Inputs[1].Index = 1;
+    }
+
+    void RunDataset(const std::string& Name, c_BarStore& Store)
+    {
+        const int Count = Store.Count();
+
+        m_ReferenceFast.assign(Count, 0.0f);
+        m_ReferenceSlow.assign(Count, 0.0f);
+        m_BatchFast.assign(Count, 0.0f);
+        m_BatchSlow.assign(Count, 0.0f);
+        m_Fast.assign(Count, 0.0f);
+        m_Slow.assign(Count, 0.0f);
+        m_StudyFast.assign(Count, 0.0f);
+        m_StudySlow.assign(Count, 0.0f);
+        m_Scratch.assign(Count, 0.0f);
+        m_FastLive.assign(Count, 0.0f);
+        m_SlowLive.assign(Count, 0.0f);
+        m_VolumeLive.assign(Count, 0.0f);
+
+        c_HeadlessChart Chart(Store, "REGRESSION", m_Options.TickSize);
+        Chart.SetLogMessages(false);
+        Chart.SetCaptureSubgraphs(2);
+
+        for (int MA = 0; MA < REGRESSION_MA_COUNT; MA++)
+        {
+            for (size_t PairIndex = 0; PairIndex < m_Options.Pairs.size(); PairIndex++)
+                RunPair(Name, Store, Chart, MA, m_Options.Pairs[PairIndex].FastPeriod, m_Options.Pairs[PairIndex].SlowPeriod);
+        }
+    }
+
+    int Checks() const
+    {
+        return m_Checks;
+    }
+
+    int Failed() const
+    {
+        return m_Failed;
+    }
+
+    int Tied() const
+    {
+        return m_Tied;
+    }
+
+private:
+    void RunPair(const std::string& Name, c_BarStore& Store, c_HeadlessChart& Chart, int MA, int FastLength, int SlowLength)
+    {
+        bool Any = false;
+        for (int Mode = 0; Mode < REGRESSION_MODE_COUNT; Mode++)
+            Any = Any || (Regression_HasMode(MA, Mode, FastLength, SlowLength) && Regression_Selected(m_Options, MA, Mode));
+        if (!Any)
+            return;
+
+        // Section 1 - The study's inputs and bracket at this pair, and the reference on the fields it reads
+        const int Count = Store.Count();
+
+        m_Inputs[0].Text = std::to_string(FastLength);
+        m_Inputs[1].Text = std::to_string(SlowLength);
+
+        const s_SignalBacktestSettings Settings = Signal_StudySettings(s_MAs[MA].Study, -1, m_Inputs, m_Options.TickSize);
+
+        s_RegressionData Data;
+        Data.FastIn = Store.Column(Settings.FastDataIndex);
+        Data.SlowIn = Store.Column(Settings.SlowDataIndex);
+        Data.Volume = Store.Column(SC_VOLUME);
+        Data.Count = Count;
+
+        std::copy(Data.FastIn, Data.FastIn + Count, m_FastLive.begin());
+        std::copy(Data.SlowIn, Data.SlowIn + Count, m_SlowLive.begin());
+        std::copy(Data.Volume, Data.Volume + Count, m_VolumeLive.begin());
+        float* SlowLive = Data.SlowIn == Data.FastIn ? &m_FastLive[0] : &m_SlowLive[0];
+
+        Regression_Reference(MA, Data.FastIn, Data.Volume, &m_ReferenceFast[0], Count, FastLength);
+        Regression_Reference(MA, Data.SlowIn, Data.Volume, &m_ReferenceSlow[0], Count, SlowLength);
+        Reference_Crosses(&m_ReferenceFast[0], &m_ReferenceSlow[0], Count, m_ReferenceCrosses);
+        Regression_TieBars(&m_ReferenceFast[0], &m_ReferenceSlow[0], Count, m_Options.Tolerance, m_Ties);
+        const bool PairHasTies = std::find(m_Ties.begin(), m_Ties.end(), 1) != m_Ties.end();
+
+        s_HeadlessResult ReferenceResult;
+        m_Signals.RunAverages(Store, &m_ReferenceFast[0], &m_ReferenceSlow[0], Settings, ReferenceResult);
+
+        Regression_Batch(MA, Data.FastIn, Data.Volume, &m_BatchFast[0], &m_Scratch[0], Count, FastLength, false);
+        Regression_Batch(MA, Data.SlowIn, Data.Volume, &m_BatchSlow[0], &m_Scratch[0], Count, SlowLength, false);
+
+        // The study's subgraphs, kept by the study mode for the sweep's SMA and HMA.
+        bool Has_Study = false;
+
+        // Section 2 - Each mode, timed, then compared with the reference
+        for (int Mode = 0; Mode < REGRESSION_MODE_COUNT; Mode++)
+        {
+            if (!Regression_HasMode(MA, Mode, FastLength, SlowLength) || !Regression_Selected(m_Options, MA, Mode))
+                continue;
+
+            s_RegressionCheck Check;
+            s_HeadlessResult Result;
+            int Updates = 1;
+            double Nanoseconds = 0.0;
+
+            if (Mode == REGRESSION_MODE_STUDY)
+            {
+                Chart.SetBuildAllColumns(MA == REGRESSION_MA_VWMA);
+
+                const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+                Chart.Run(s_MAs[MA].Study, m_Inputs, HEADLESS_MODE_REPLAY, 1, Result);
+                Nanoseconds = Regression_Elapsed(Start);
+
+                // The Faster and Slower subgraphs, the averages the study drew and traded on.
+                std::copy(Result.Subgraphs[0].begin(), Result.Subgraphs[0].end(), m_Fast.begin());
+                std::copy(Result.Subgraphs[1].begin(), Result.Subgraphs[1].end(), m_Slow.begin());
+                m_StudyFast = m_Fast;
+                m_StudySlow = m_Slow;
+                Has_Study = true;
+            }
+            else if (Mode == REGRESSION_MODE_SWEEP)
+            {
+                const bool Exact = s_MAs[MA].SweepType == SWEEP_MA_SMA || s_MAs[MA].SweepType == SWEEP_MA_HULL;
+
+                // Without the study mode (--filter), the study runs here, untimed.
+                if (Exact && !Has_Study)
+                {
+                    s_HeadlessResult StudyResult;
+                    Chart.SetBuildAllColumns(false);
+                    Chart.Run(s_MAs[MA].Study, m_Inputs, HEADLESS_MODE_REPLAY, 1, StudyResult);
+                    std::copy(StudyResult.Subgraphs[0].begin(), StudyResult.Subgraphs[0].end(), m_StudyFast.begin());
+                    std::copy(StudyResult.Subgraphs[1].begin(), StudyResult.Subgraphs[1].end(), m_StudySlow.begin());
+                    Has_Study = true;
+                }
+
+                const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+                Regression_Sweep(s_MAs[MA].SweepType, Data.FastIn, &m_Fast[0], Count, FastLength);
+                Regression_Sweep(s_MAs[MA].SweepType, Data.SlowIn, &m_Slow[0], Count, SlowLength);
+                Nanoseconds = Regression_Elapsed(Start);
+
+                if (Exact)
+                {
+                    Regression_CompareStudy(&m_Fast[0], &m_StudyFast[0], Count, Check);
+                    Regression_CompareStudy(&m_Slow[0], &m_StudySlow[0], Count, Check);
+                }
+            }
+            else
+            {
+                const std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+                if (Mode == REGRESSION_MODE_BATCH || Mode == REGRESSION_MODE_BATCH_SCALAR)
+                {
+                    Regression_Batch(MA, Data.FastIn, Data.Volume, &m_Fast[0], &m_Scratch[0], Count, FastLength, Mode == REGRESSION_MODE_BATCH_SCALAR);
+                    Regression_Batch(MA, Data.SlowIn, Data.Volume, &m_Slow[0], &m_Scratch[0], Count, SlowLength, Mode == REGRESSION_MODE_BATCH_SCALAR);
+                }
+                else
+                {
+                    const bool Ticking = Mode == REGRESSION_MODE_TICK || Mode == REGRESSION_MODE_TICK_PAIR || Mode == REGRESSION_MODE_TICK_FIXED;
+                    Updates = Ticking ? m_Options.Ticks : 1;
+                    Regression_Incremental(MA, Mode, Data, &m_FastLive[0], SlowLive, &m_VolumeLive[0], &m_Fast[0], &m_Slow[0], FastLength, SlowLength, Updates, m_Options.TickSize);
+                }
+
+                Nanoseconds = Regression_Elapsed(Start);
+            }
+
+            Regression_CompareValues(&m_Fast[0], &m_ReferenceFast[0], &m_BatchFast[0], Count, m_Options.Tolerance, Check);
+            Regression_CompareValues(&m_Slow[0], &m_ReferenceSlow[0], &m_BatchSlow[0], Count, m_Options.Tolerance, Check);
+
+            Crossover_BuildIndex(&m_Fast[0], &m_Slow[0], Count, m_Crosses);
+            Regression_CompareCrosses(m_Crosses, m_ReferenceCrosses, m_Ties, Check);
+
+            if (Mode != REGRESSION_MODE_STUDY)
+                m_Signals.RunAverages(Store, &m_Fast[0], &m_Slow[0], Settings, Result);
+
+            Check.Trades = Result.Stats.Trades;
+            Check.ReferenceTrades = ReferenceResult.Stats.Trades;
+            Check.NanosecondsPerBar = Nanoseconds / Count;
+            Check.NanosecondsPerUpdate = Nanoseconds / (static_cast<double>(Count) * Updates);
+
+            // Section 3 - Status and output
+            const char* Status = Regression_Status(Check, Regression_SameTrades(Result, ReferenceResult), PairHasTies);
+            m_Checks++;
+            m_Failed += std::strcmp(Status, "FAIL") == 0;
+            m_Tied += std::strcmp(Status, "tie") == 0;
+
+            std::printf("%s,%s,%d,%d,%s,%lld,%lld,%lld,%lld,%.9g,%.9g,%d,%d,%d,%d,%d,%.3f,%.3f,%s\n",
+                Name.c_str(), s_MAs[MA].Label, FastLength, SlowLength, s_ModeLabels[Mode],
+                Check.Values, Check.Mismatches, Check.BatchDiffs, Check.StudyDiffs, Check.MaxAbsDiff, Check.MaxRelDiff,
+                Check.Crosses, Check.CrossMismatches, Check.CrossTies, Check.Trades, Check.ReferenceTrades,
+                Check.NanosecondsPerBar, Check.NanosecondsPerUpdate, Status);
+            std::fflush(stdout);
+        }
+    }
+
+    const s_RegressionOptions& m_Options;
+    std::vector<s_HeadlessInput> m_Inputs;
+    std::vector<float> m_ReferenceFast;
+    std::vector<float> m_ReferenceSlow;
+    std::vector<float> m_BatchFast;
+    std::vector<float> m_BatchSlow;
+    std::vector<float> m_Fast;
+    std::vector<float> m_Slow;
+    std::vector<float> m_StudyFast;
+    std::vector<float> m_StudySlow;
+    std::vector<float> m_Scratch;
+    std::vector<float> m_FastLive;
+    std::vector<float> m_SlowLive;
+    std::vector<float> m_VolumeLive;
+    std::vector<s_CrossoverEvent> m_ReferenceCrosses;
+    std::vector<s_CrossoverEvent> m_Crosses;
+    std::vector<char> m_Ties;
+    c_SignalBacktest m_Signals;
+    int m_Checks;
+    int m_Failed;
+    int m_Tied;
+};
+
+static void PrintUsage()
+{
+    std::fprintf(stderr,
+        "usage: crossover_regression [--bars FILE]... [--bar-seconds N] [--synthetic-bars N] [--pairs F/S,F/S,...]\n"
+        "    [--ticks N] [--tolerance VALUE] [--tick-size VALUE] [--filter TEXT]\n");
+}
+
+int main(int argc, char** argv)
+{
+    s_RegressionOptions Options;
+
+    for (int ArgumentIndex = 1; ArgumentIndex < argc; ArgumentIndex++)
+    {
+        const char* Argument = argv[ArgumentIndex];
+        const char* Value = ArgumentIndex + 1 < argc ? argv[ArgumentIndex + 1] : NULL;
+
+        if (Value == NULL)
+        {
+            PrintUsage();
+            return 2;
+        }
+
+        ArgumentIndex++;
+
+        if (std::strcmp(Argument, "--bars") == 0)
+            Options.BarPaths.push_back(Value);
+        else if (std::strcmp(Argument, "--bar-seconds") == 0)
+            Options.BarSeconds = std::atoi(Value);
+        else if (std::strcmp(Argument, "--synthetic-bars") == 0)
+            Options.SyntheticBars = std::atoi(Value);
+        else if (std::strcmp(Argument, "--pairs") == 0)
+        {
+            Options.Pairs.clear();
+            if (!Sweep_ParsePairs(Value, Options.Pairs))
+            {
+                PrintUsage();
+                return 2;
+            }
+        }
+        else if (std::strcmp(Argument, "--ticks") == 0)
+            Options.Ticks = std::atoi(Value);
+        else if (std::strcmp(Argument, "--tolerance") == 0)
+            Options.Tolerance = std::atof(Value);
+        else if (std::strcmp(Argument, "--tick-size") == 0)
+            Options.TickSize = static_cast<float>(std::atof(Value));
+        else if (std::strcmp(Argument, "--filter") == 0)
+            Options.Filter = Value;
+        else
+        {
+            PrintUsage();
+            return 2;
+        }
+    }
+
+    if (Options.Pairs.empty())
+        Sweep_ParsePairs("9/21,16/64,50/200", Options.Pairs);
+
+    if (Options.Ticks < 1 || Options.Tolerance < 0.0 || Options.TickSize <= 0.0f || (Options.BarPaths.empty() && Options.SyntheticBars < 2))
+    {
+        PrintUsage();
+        return 2;
+    }
+
+    const std::chrono::steady_clock::time_point Run_Start = std::chrono::steady_clock::now();
+    const int Datasets = Options.BarPaths.empty() ? 1 : static_cast<int>(Options.BarPaths.size());
+    c_Regression Regression(Options);
+
+    std::printf("Dataset,MA,Fast,Slow,Mode,Values,Mismatches,BatchDiffs,StudyDiffs,MaxAbsDiff,MaxRelDiff,Crosses,CrossMismatches,CrossTies,Trades,ReferenceTrades,NsPerBar,NsPerUpdate,Status\n");
+
+    for (int Dataset = 0; Dataset < Datasets; Dataset++)
+    {
+        s_BarData Bars;
+        c_ScidFile File;
+        c_BarStore Store;
+        std::string Name = "synthetic";
+
+        if (Options.BarPaths.empty())
+        {
+            Regression_Synthetic(Bars, Options.SyntheticBars, Options.TickSize);
+            Store.SetSource(Bars);
+        }
+        else
+        {
+            Name = Options.BarPaths[Dataset];
+            const size_t Slash = Name.find_last_of("/\\");
+            if (Slash != std::string::npos)
+                Name = Name.substr(Slash + 1);
+
+            if (!Regression_Load(Options.BarPaths[Dataset].c_str(), Options.BarSeconds, Bars, File, Store))
+                return 1;
+        }
+
+        Regression.RunDataset(Name, Store);
+    }
+
+    std::fprintf(stderr, "%d checks over %d datasets in %.1f s: %d failed, %d with crosses moved at ties\n",
+        Regression.Checks(), Datasets, Regression_Elapsed(Run_Start) / 1e9, Regression.Failed(), Regression.Tied());
+
+    return Regression.Failed() > 0 ? 1 : 0;
+}
@@ -0,0 +1,340 @@
+#ifndef SCID_FILE_H
+#define SCID_FILE_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Bar_File.h"
+
+/*
+Memory-mapped reader for Sierra Chart intraday data files (.scid).
+
+The file is a 56 byte s_IntradayFileHeader followed by 40 byte records:
+DateTime - int64, microseconds since 1899-12-30 (SCDateTimeMS)
+Open, High, Low, Close - float
+NumTrades, TotalVolume, BidVolume, AskVolume - uint32
+A tick file stores one trade per record: Open is 0 (or the single trade marker), Close the trade price, High the ask and Low the bid.
+The file is mapped read-only and never copied. Columns are exposed as strided views (s_ScidColumn) over the mapped records, so reading a field touches the records but allocates nothing.
+The MA kernels need contiguous floats, so bars are produced from the views by Scid_ReadBars, which streams over the mapping window by window, either copying the records one to one or building time bars from the ticks.
+Windows already read are dropped from the page cache mapping (MADV_DONTNEED) and the next one is requested ahead (MADV_WILLNEED), so a file larger than memory can be processed with a resident set of about two windows plus the bars.
+POSIX only (mmap); the headless harness targets Linux servers.
+*/
+
+#pragma pack(push, 1)
+struct s_ScidHeader
+{
+    char FileTypeUniqueHeaderID[4];
+    unsigned int HeaderSize;
+    unsigned int RecordSize;
+    unsigned short Version;
+    unsigned short Unused1;
+    unsigned int UTCStartIndex;
+    char Reserve[36];
+};
+
+struct s_ScidRecord
+{
+    long long DateTime;
+    float Open;
+    float High;
+    float Low;
+    float Close;
+    unsigned int NumTrades;
+    unsigned int TotalVolume;
+    unsigned int BidVolume;
+    unsigned int AskVolume;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(s_ScidHeader) == 56, "s_ScidHeader must match the .scid layout");
+static_assert(sizeof(s_ScidRecord) == 40, "s_ScidRecord must match the .scid layout");
+
+const double SCID_MICROSECONDS_PER_DAY = 86400.0 * 1000000.0;
+const float SCID_SINGLE_TRADE_WITH_BID_ASK = -1.99900095e+37f;
+
+// Read-only strided view of one field of the mapped records.
+template <typename T>
+struct s_ScidColumn
+{
+    const unsigned char* Base;
+    int Count;
+
+    s_ScidColumn()
+        : Base(NULL)
+        , Count(0)
+    {
+    }
+
+    s_ScidColumn(const unsigned char* InBase, int InCount)
+        : Base(InBase)
+        , Count(InCount)
+    {
+    }
+
+    T operator[](int Index) const
+    {
+        T Value;
+        std::memcpy(&Value, Base + static_cast<size_t>(Index) * sizeof(s_ScidRecord), sizeof(T));
+        return Value;
+    }
+};
+
+class c_ScidFile
+{
+public:
+    c_ScidFile()
+        : m_Descriptor(-1)
+        , m_Mapping(NULL)
+        , m_MappingSize(0)
+        , m_Records(NULL)
+        , m_RecordCount(0)
+    {
+    }
+
+    ~c_ScidFile()
+    {
+        Close();
+    }
+
+    bool Open(const char* Path, std::string& Error)
+    {
+        Close();
+
+        m_Descriptor = ::open(Path, O_RDONLY);
+        if (m_Descriptor < 0)
+        {
+            Error = std::string("cannot open ") + Path;
+            return false;
+        }
+
+        struct stat Status;
+        if (::fstat(m_Descriptor, &Status) != 0 || Status.st_size < static_cast<off_t>(sizeof(s_ScidHeader)))
+        {
+            Error = std::string("not an intraday data file: ") + Path;
+            Close();
+            return false;
+        }
+
+        m_MappingSize = static_cast<size_t>(Status.st_size);
+        void* Mapping = ::mmap(NULL, m_MappingSize, PROT_READ, MAP_SHARED, m_Descriptor, 0);
+        if (Mapping == MAP_FAILED)
+        {
+            Error = std::string("cannot map ") + Path;
+            m_MappingSize = 0;
+            Close();
+            return false;
+        }
+
+        m_Mapping = static_cast<const unsigned char*>(Mapping);
+
+        s_ScidHeader Header;
+        std::memcpy(&Header, m_Mapping, sizeof(Header));
+
+        if (std::memcmp(Header.FileTypeUniqueHeaderID, "SCID", 4) != 0 || Header.RecordSize != sizeof(s_ScidRecord)
+            || Header.HeaderSize < sizeof(s_ScidHeader) || Header.HeaderSize > m_MappingSize)
+        {
+            Error = std::string("not an intraday data file: ") + Path;
+            Close();
+            return false;
+        }
+
+        m_Records = m_Mapping + Header.HeaderSize;
+        m_RecordCount = static_cast<int>((m_MappingSize - Header.HeaderSize) / sizeof(s_ScidRecord));
+        return true;
+    }
+
+    void Close()
+    {
+        if (m_Mapping != NULL)
+            ::munmap(const_cast<unsigned char*>(m_Mapping), m_MappingSize);
+
+        if (m_Descriptor >= 0)
+            ::close(m_Descriptor);
+
+        m_Descriptor = -1;
+        m_Mapping = NULL;
+        m_MappingSize = 0;
+        m_Records = NULL;
+        m_RecordCount = 0;
+    }
+
+    int RecordCount() const
+    {
+        return m_RecordCount;
+    }
+
+    s_ScidRecord Record(int Index) const
+    {
+        s_ScidRecord Value;
+        std::memcpy(&Value, m_Records + static_cast<size_t>(Index) * sizeof(s_ScidRecord), sizeof(Value));
+        return Value;
+    }
+
+    // Sierra Chart date-time double (days since 1899-12-30).
+    double DateTime(int Index) const
+    {
+        return DateTimeColumn()[Index] / SCID_MICROSECONDS_PER_DAY;
+    }
+
+    s_ScidColumn<long long> DateTimeColumn() const { return Column<long long>(offsetof(s_ScidRecord, DateTime)); }
+    s_ScidColumn<float> OpenColumn() const { return Column<float>(offsetof(s_ScidRecord, Open)); }
+    s_ScidColumn<float> HighColumn() const { return Column<float>(offsetof(s_ScidRecord, High)); }
+    s_ScidColumn<float> LowColumn() const { return Column<float>(offsetof(s_ScidRecord, Low)); }
+    s_ScidColumn<float> CloseColumn() const { return Column<float>(offsetof(s_ScidRecord, Close)); }
+    s_ScidColumn<unsigned int> NumTradesColumn() const { return Column<unsigned int>(offsetof(s_ScidRecord, NumTrades)); }
+    s_ScidColumn<unsigned int> VolumeColumn() const { return Column<unsigned int>(offsetof(s_ScidRecord, TotalVolume)); }
+    s_ScidColumn<unsigned int> BidVolumeColumn() const { return Column<unsigned int>(offsetof(s_ScidRecord, BidVolume)); }
+    s_ScidColumn<unsigned int> AskVolumeColumn() const { return Column<unsigned int>(offsetof(s_ScidRecord, AskVolume)); }
+
+    // Paging hints for the records [First, First + Count).
+    void WillNeed(int First, int Count) const
+    {
+        Advise(First, Count, MADV_WILLNEED);
+    }
+
+    void DontNeed(int First, int Count) const
+    {
+        Advise(First, Count, MADV_DONTNEED);
+    }
+
+    void Sequential() const
+    {
+        if (m_Mapping != NULL)
+            ::madvise(const_cast<unsigned char*>(m_Mapping), m_MappingSize, MADV_SEQUENTIAL);
+    }
+
+private:
+    c_ScidFile(const c_ScidFile&);
+    c_ScidFile& operator=(const c_ScidFile&);
+
+    template <typename T>
+    s_ScidColumn<T> Column(size_t Offset) const
+    {
+        return s_ScidColumn<T>(m_Records != NULL ? m_Records + Offset : NULL, m_RecordCount);
+    }
+
+    void Advise(int First, int Count, int Advice) const
+    {
+        if (m_Mapping == NULL || Count <= 0)
+            return;
+
+        const size_t PageSize = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        const size_t Begin = static_cast<size_t>(m_Records - m_Mapping) + static_cast<size_t>(First) * sizeof(s_ScidRecord);
+        size_t End = Begin + static_cast<size_t>(Count) * sizeof(s_ScidRecord);
+        if (End > m_MappingSize)
+            End = m_MappingSize;
+
+        // madvise needs a page aligned start. Only whole pages inside the range are dropped, so a neighbouring window is never evicted.
+        size_t AlignedBegin = Begin / PageSize * PageSize;
+        if (Advice == MADV_DONTNEED && AlignedBegin < Begin)
+            AlignedBegin += PageSize;
+
+        if (AlignedBegin < End)
+            ::madvise(const_cast<unsigned char*>(m_Mapping) + AlignedBegin, End - AlignedBegin, Advice);
+    }
+
+    int m_Descriptor;
+    const unsigned char* m_Mapping;
+    size_t m_MappingSize;
+    const unsigned char* m_Records;
+    int m_RecordCount;
+};
+
+//================================================================================================//
+
+const int SCID_READ_WINDOW_RECORDS = 1 << 20;
+
+inline bool Scid_IsSingleTrade(float Open)
+{
+    return Open == 0.0f || Open == SCID_SINGLE_TRADE_WITH_BID_ASK;
+}
+
+// Appends the records [First, First + Count) of File to Bars.
+// With BarSeconds = 0 every record becomes a bar. Otherwise records are combined into time bars of BarSeconds starting at whole multiples of BarSeconds;
+// for single trade records the trade price (Close) is used for the open, high, low and close, not the bid and ask.
+inline void Scid_ReadBars(const c_ScidFile& File, int First, int Count, int BarSeconds, s_BarData& Bars)
+{
+    if (First < 0)
+        First = 0;
+    if (Count < 0 || First + Count > File.RecordCount())
+        Count = File.RecordCount() - First;
+    if (Count <= 0)
+        return;
+
+    const s_ScidColumn<long long> DateTime = File.DateTimeColumn();
+    const s_ScidColumn<float> Open = File.OpenColumn();
+    const s_ScidColumn<float> High = File.HighColumn();
+    const s_ScidColumn<float> Low = File.LowColumn();
+    const s_ScidColumn<float> Close = File.CloseColumn();
+    const s_ScidColumn<unsigned int> NumTrades = File.NumTradesColumn();
+    const s_ScidColumn<unsigned int> Volume = File.VolumeColumn();
+    const s_ScidColumn<unsigned int> BidVolume = File.BidVolumeColumn();
+    const s_ScidColumn<unsigned int> AskVolume = File.AskVolumeColumn();
+
+    const long long BarMicroseconds = static_cast<long long>(BarSeconds) * 1000000;
+    long long CurrentBarStart = -1;
+
+    if (BarSeconds <= 0)
+        Bars.Reserve(Bars.DateTime.size() + Count);
+
+    File.Sequential();
+    File.WillNeed(First, SCID_READ_WINDOW_RECORDS);
+
+    const int End = First + Count;
+    for (int WindowStart = First; WindowStart < End; WindowStart += SCID_READ_WINDOW_RECORDS)
+    {
+        const int WindowEnd = WindowStart + SCID_READ_WINDOW_RECORDS < End ? WindowStart + SCID_READ_WINDOW_RECORDS : End;
+        File.WillNeed(WindowEnd, SCID_READ_WINDOW_RECORDS);
+
+        for (int Index = WindowStart; Index < WindowEnd; Index++)
+        {
+            const float RecordOpen = Open[Index];
+            const float RecordClose = Close[Index];
+            const bool SingleTrade = Scid_IsSingleTrade(RecordOpen);
+
+            const float BarOpen = SingleTrade ? RecordClose : RecordOpen;
+            const float BarHigh = SingleTrade ? RecordClose : High[Index];
+            const float BarLow = SingleTrade ? RecordClose : Low[Index];
+
+            const long long RecordTime = DateTime[Index];
+
+            if (BarSeconds <= 0 || RecordTime - CurrentBarStart >= BarMicroseconds || RecordTime < CurrentBarStart)
+            {
+                CurrentBarStart = BarSeconds > 0 ? RecordTime - RecordTime % BarMicroseconds : RecordTime;
+
+                Bars.DateTime.push_back(CurrentBarStart / SCID_MICROSECONDS_PER_DAY);
+                Bars.Open.push_back(BarOpen);
+                Bars.High.push_back(BarHigh);
+                Bars.Low.push_back(BarLow);
+                Bars.Close.push_back(RecordClose);
+                Bars.Volume.push_back(static_cast<float>(Volume[Index]));
+                Bars.NumTrades.push_back(static_cast<float>(NumTrades[Index]));
+                Bars.BidVolume.push_back(static_cast<float>(BidVolume[Index]));
+                Bars.AskVolume.push_back(static_cast<float>(AskVolume[Index]));
+                continue;
+            }
+
+            const size_t Last = Bars.Close.size() - 1;
+            if (BarHigh > Bars.High[Last])
+                Bars.High[Last] = BarHigh;
+            if (BarLow < Bars.Low[Last])
+                Bars.Low[Last] = BarLow;
+
+            Bars.Close[Last] = RecordClose;
+            Bars.Volume[Last] += static_cast<float>(Volume[Index]);
+            Bars.NumTrades[Last] += static_cast<float>(NumTrades[Index]);
+            Bars.BidVolume[Last] += static_cast<float>(BidVolume[Index]);
+            Bars.AskVolume[Last] += static_cast<float>(AskVolume[Index]);
+        }
+
+        File.DontNeed(WindowStart, WindowEnd - WindowStart);
+    }
+}
+
+#endif
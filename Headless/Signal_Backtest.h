@@ -0,0 +1,165 @@
+#ifndef SIGNAL_BACKTEST_H
+#define SIGNAL_BACKTEST_H
+
+#include <vector>
+
+#include "Bar_Store.h"
+#include "Headless_Host.h"
+#include "../Bracket_Search.h"
+#include "../Crossover_Engine.h"
+#include "../Crossover_Index.h"
+#include "../Crossover_Sweep.h"
+#include "../MA_Batch_Kernels.h"
+#include "../Trade_Sim.h"
+
+/*
+Signal mode of the backtester: a crossover strategy backtested from its cross index instead of bar by bar through the study.
+
+The averages are computed over the whole history with the batch kernels (MA_Batch_Kernels.h), the kernels a study uses on its full recalculation, and Crossover_BuildIndex (Crossover_Index.h) lists the bars where they cross.
+The run then goes from one cross to the next. Each cross enters at the close of its bar; the open position of the other side is closed there first. That is what Crossover_Enter does on a closed bar.
+Between two crosses the exit of the open position's bracket (Trade_Sim.h) is searched for in the bar extremes (Bracket_Search.h) rather than stepped bar by bar, and bars with no open position are not visited at all.
+As in c_HeadlessChart's replay, bar 0 never trades and the bracket is checked on the signal bar before the reversal at its close, so the trades and statistics are those of the replay.
+For the SMA and Hull averages, the batch and incremental kernels keep the same compensated sums (s_MASum in MA_Kernels.h), so the averages, and with them the crosses, are the replay's. The EMA and ZLEMA batch kernels scan the recurrence with AVX2 and can round a value one float step away from the replay's, so a cross on a near-tie can move by a bar.
+RunAverages backtests averages computed elsewhere the same way, for any average type: the regression tool (Replay_Regression.cpp) runs it on its reference averages.
+*/
+
+struct s_SignalBacktestSettings
+{
+    int Type;
+    int FastLength;
+    int SlowLength;
+    int FastDataIndex;
+    int SlowDataIndex;
+    double TargetOffset;
+    double StopOffset;
+
+    s_SignalBacktestSettings()
+        : Type(SWEEP_MA_SMA)
+        , FastLength(0)
+        , SlowLength(0)
+        , FastDataIndex(SC_LAST)
+        , SlowDataIndex(SC_LAST)
+        , TargetOffset(0.0)
+        , StopOffset(0.0)
+    {
+    }
+};
+
+// The averages and bracket of a crossover study with Inputs set, read by the study's own s_CrossoverSettings. Type is the SWEEP_MA_* average of Run.
+inline s_SignalBacktestSettings Signal_StudySettings(SCStudyFunction Study, int Type, const std::vector<s_HeadlessInput>& Inputs, float TickSize)
+{
+    s_sc* p_sc = new s_sc;
+    s_sc& sc = *p_sc;
+
+    sc.TickSize = TickSize;
+    sc.SetDefaults = 1;
+    Study(sc);
+    sc.SetDefaults = 0;
+    Headless_ApplyInputs(sc, Inputs);
+
+    s_CrossoverSettings Crossover;
+    Crossover.Read(sc);
+    delete p_sc;
+
+    s_SignalBacktestSettings Settings;
+    Settings.Type = Type;
+    Settings.FastLength = Crossover.FastLength;
+    Settings.SlowLength = Crossover.SlowLength;
+    Settings.FastDataIndex = Crossover.FastDataIndex;
+    Settings.SlowDataIndex = Crossover.SlowDataIndex;
+    Settings.TargetOffset = Crossover.Order.AttachedOrderTarget1Type >= 0 ? Crossover.Order.Target1Offset : 0.0;
+    Settings.StopOffset = Crossover.Order.AttachedOrderStop1Type >= 0 ? Crossover.Order.Stop1Offset : 0.0;
+    return Settings;
+}
+
+// Searches bars First to Last for the exit of an open Position. Returns true when it exited (the trade is added to Stats).
+inline bool Signal_CheckBracket(s_BracketPosition& Position, const c_BarExtremes& Extremes, int First, int Last, s_TradeStats& Stats)
+{
+    double ExitPrice = 0.0;
+    if (Bracket_FindExit(Position, Extremes, First, Last, ExitPrice) < 0)
+        return false;
+
+    Stats.Add(Position.Close(ExitPrice));
+    return true;
+}
+
+class c_SignalBacktest
+{
+public:
+    // One run of one instance. Several instances can run on several threads at once over the same store.
+    void Run(c_BarStore& Bars, const s_SignalBacktestSettings& Settings, s_HeadlessResult& Result)
+    {
+        const int Count = Bars.Count();
+
+        m_Fast.assign(Count, 0.0f);
+        m_Slow.assign(Count, 0.0f);
+        ComputeAverage(Settings.Type, Bars.Column(Settings.FastDataIndex), &m_Fast[0], Count, Settings.FastLength);
+        ComputeAverage(Settings.Type, Bars.Column(Settings.SlowDataIndex), &m_Slow[0], Count, Settings.SlowLength);
+
+        RunAverages(Bars, &m_Fast[0], &m_Slow[0], Settings, Result);
+    }
+
+    // The same run on Fast and Slow, Bars.Count() values each, instead of the averages of Settings.Type. Only the bracket offsets of Settings are used.
+    void RunAverages(c_BarStore& Bars, const float* Fast, const float* Slow, const s_SignalBacktestSettings& Settings, s_HeadlessResult& Result)
+    {
+        const int Count = Bars.Count();
+
+        Crossover_BuildIndex(Fast, Slow, Count, m_Crosses);
+
+        m_Extremes.Build(Bars.Column(SC_HIGH), Bars.Column(SC_LOW), Count);
+
+        const float* Close = Bars.Column(SC_LAST);
+
+        s_BracketPosition Position;
+        s_TradeStats Stats;
+
+        for (size_t CrossIndex = 0; CrossIndex < m_Crosses.size(); CrossIndex++)
+        {
+            const s_CrossoverEvent& Cross = m_Crosses[CrossIndex];
+
+            if (Position.IsOpen())
+                Signal_CheckBracket(Position, m_Extremes, Position.EntryIndex + 1, Cross.BarIndex, Stats);
+
+            if (Position.IsOpen())
+                Stats.Add(Position.Close(Close[Cross.BarIndex]));
+
+            Position.Open(Cross.Direction, Cross.BarIndex, Close[Cross.BarIndex], Settings.TargetOffset, Settings.StopOffset);
+        }
+
+        if (Position.IsOpen())
+            Signal_CheckBracket(Position, m_Extremes, Position.EntryIndex + 1, Count - 1, Stats);
+
+        Result.Stats = Stats;
+        Result.OpenDirection = Position.Direction;
+        Result.OpenEntryPrice = Position.EntryPrice;
+    }
+
+    // Crosses found by the last run.
+    int CrossCount() const
+    {
+        return static_cast<int>(m_Crosses.size());
+    }
+
+private:
+    void ComputeAverage(int Type, const float* In, float* Out, int Count, int Length)
+    {
+        switch (Type)
+        {
+            case SWEEP_MA_SMA: MA_Batch_SMA(In, Out, Count, Length); break;
+            case SWEEP_MA_EMA: MA_Batch_EMA(In, Out, Count, Length); break;
+            case SWEEP_MA_ZLEMA: MA_Batch_ZLEMA(In, Out, Count, Length); break;
+            case SWEEP_MA_HULL:
+                m_Scratch.assign(Count, 0.0f);
+                MA_Batch_HMA(In, Out, &m_Scratch[0], Count, Length);
+                break;
+        }
+    }
+
+    std::vector<float> m_Fast;
+    std::vector<float> m_Slow;
+    std::vector<float> m_Scratch;
+    std::vector<s_CrossoverEvent> m_Crosses;
+    c_BarExtremes m_Extremes;
+};
+
+#endif
@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "../Trade_Log.h"
+
+/*
+Converts a trade log written by the strategies' Trade Log File input (Trade_Log.h) to CSV on stdout, one line per record.
+
+trade_log_dump FILE
+
+The columns are those of s_TradeLogRecord, with Kind written as SIGNAL, ENTRY or POSITION. DateTime stays an SCDateTime value in days.
+*/
+
+static const char* TradeLog_KindName(int Kind)
+{
+    switch (Kind)
+    {
+        case TRADE_LOG_SIGNAL: return "SIGNAL";
+        case TRADE_LOG_ENTRY: return "ENTRY";
+        case TRADE_LOG_POSITION: return "POSITION";
+    }
+
+    return "UNKNOWN";
+}
+
+// Reads the next column of a block into each row's Field.
+template <typename T>
+static const char* TradeLog_ReadColumn(const char* In, std::vector<s_TradeLogRecord>& Records, T s_TradeLogRecord::* Field)
+{
+    for (size_t Row = 0; Row < Records.size(); Row++)
+    {
+        std::memcpy(&(Records[Row].*Field), In, sizeof(T));
+        In += sizeof(T);
+    }
+
+    return In;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "usage: trade_log_dump FILE\n");
+        return 2;
+    }
+
+    std::FILE* File = std::fopen(argv[1], "rb");
+    if (File == NULL)
+    {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+    }
+
+    s_TradeLogFileHeader Header;
+    if (std::fread(&Header, sizeof(Header), 1, File) != 1 || std::memcmp(Header.Magic, TRADE_LOG_FILE_MAGIC, sizeof(Header.Magic)) != 0
+        || Header.Version != TRADE_LOG_FILE_VERSION || Header.ColumnCount != TRADE_LOG_COLUMNS)
+    {
+        std::fprintf(stderr, "%s is not a version %u trade log\n", argv[1], TRADE_LOG_FILE_VERSION);
+        std::fclose(File);
+        return 1;
+    }
+
+    std::printf("Kind,ChartNumber,StudyID,BarIndex,DateTime,Direction,Flags,Price,Value1,Value2,Value3,Quantity,Trades,Wins\n");
+
+    std::vector<char> Buffer;
+    std::vector<s_TradeLogRecord> Records;
+    s_TradeLogBlockHeader Block;
+    int Result = 0;
+
+    while (std::fread(&Block, sizeof(Block), 1, File) == 1)
+    {
+        // Two instances that found the same empty file each wrote a header; the second is skipped.
+        if (std::memcmp(&Block, Header.Magic, sizeof(Block)) == 0)
+        {
+            s_TradeLogFileHeader Repeated;
+            std::memcpy(&Repeated, &Block, sizeof(Block));
+            if (std::fread(reinterpret_cast<char*>(&Repeated) + sizeof(Block), sizeof(Repeated) - sizeof(Block), 1, File) == 1
+                && std::memcmp(&Repeated, &Header, sizeof(Header)) == 0)
+                continue;
+
+            std::fprintf(stderr, "%s: a header in the middle of the file does not match the first\n", argv[1]);
+            Result = 1;
+            break;
+        }
+
+        if (Block.Bytes != Block.RowCount * TRADE_LOG_ROW_BYTES)
+        {
+            std::fprintf(stderr, "%s: a block of %u rows has %u bytes\n", argv[1], Block.RowCount, Block.Bytes);
+            Result = 1;
+            break;
+        }
+
+        Buffer.resize(Block.Bytes);
+        if (Block.Bytes > 0 && std::fread(&Buffer[0], 1, Block.Bytes, File) != Block.Bytes)
+        {
+            std::fprintf(stderr, "%s: the last block is cut short\n", argv[1]);
+            Result = 1;
+            break;
+        }
+
+        Records.assign(Block.RowCount, s_TradeLogRecord());
+        if (Records.empty())
+            continue;
+
+        const char* In = &Buffer[0];
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::DateTime);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Price);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Value1);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Value2);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Value3);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::BarIndex);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Quantity);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Trades);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Wins);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::ChartNumber);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::StudyID);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Kind);
+        In = TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Direction);
+        TradeLog_ReadColumn(In, Records, &s_TradeLogRecord::Flags);
+
+        for (size_t Row = 0; Row < Records.size(); Row++)
+        {
+            const s_TradeLogRecord& Record = Records[Row];
+            std::printf("%s,%d,%d,%d,%.8f,%d,%d,%.6f,%.6f,%.6f,%.6f,%d,%d,%d\n",
+                TradeLog_KindName(Record.Kind), Record.ChartNumber, Record.StudyID, Record.BarIndex, Record.DateTime, Record.Direction, Record.Flags,
+                Record.Price, Record.Value1, Record.Value2, Record.Value3, Record.Quantity, Record.Trades, Record.Wins);
+        }
+    }
+
+    std::fclose(File);
+    return Result;
+}
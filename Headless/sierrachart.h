@@ -0,0 +1,720 @@
+#ifndef HEADLESS_SIERRACHART_H
+#define HEADLESS_SIERRACHART_H
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../Trade_Sim.h"
+
+/*
+Headless stand-in for sierrachart.h.
+
+It declares the part of the ACSIL interface the studies in this repository use, so the unchanged study files can be compiled into a native command-line program (Headless_Backtest.cpp) instead of a Sierra Chart DLL:
+s_sc - the study interface: the chart settings, sc.Input, sc.Subgraph, sc.BaseDataIn and sc.BaseDateTimeIn, persistent variables, sc.CrossOver, the bar closed status, the message log, and the trading functions.
+SCFloatArray - a float array that either owns its storage or views memory owned by the host (Attach), so one copy of the bar data can feed many runs.
+SCString, SCDateTime, s_SCInput, s_SCSubgraph, s_SCNewOrder, s_SCPositionData - the matching value types.
+The trading functions fill on a simulated account (s_HeadlessAccount) with the fill model of Trade_Sim.h: entries at the close of the bar index passed to BuyEntry / SellEntry, the attached target and trailing stop checked against the High / Low of the following bars (Headless_Host.h steps them, Live_Host.h at each trade), FlattenPosition at the close of the last bar. p_EntryCallback, when set, is called after each entry fills.
+The order flags of the studies are honoured: one position of one contract (MaximumPositionAllowed, AllowMultipleEntriesInSameDirection), no reversals unless SupportReversals, and one entry per bar with AllowOnlyOneTradePerBar.
+Anything that only matters for drawing (colours, draw styles, regions) is stored and ignored.
+The constants keep the values of the real header, so the sc.BaseDataIn indexes of the inputs are the same.
+*/
+
+#define SCDLLName(Name)
+#define SCSFExport extern "C" void
+
+#define RGB(Red, Green, Blue) ((unsigned int)((Red) | ((Green) << 8) | ((Blue) << 16)))
+
+#define MAX_STUDY_LENGTH 250000
+#define SC_SUBGRAPHS_AVAILABLE 60
+#define SC_SUBGRAPH_EXTRA_ARRAYS 12
+#define SC_INPUTS_AVAILABLE 128
+#define SC_PERSISTENT_VARIABLES 100
+
+enum
+{
+    SC_OPEN = 0,
+    SC_HIGH = 1,
+    SC_LOW = 2,
+    SC_LAST = 3,
+    SC_VOLUME = 4,
+    SC_NUM_TRADES = 5,
+    SC_OHLC_AVG = 6,
+    SC_HLC_AVG = 7,
+    SC_HL_AVG = 8,
+    SC_BIDVOL = 9,
+    SC_ASKVOL = 10,
+    SC_BASE_DATA_ARRAYS = 11
+};
+
+enum
+{
+    NO_CROSS = 0,
+    CROSS_FROM_TOP = 1,
+    CROSS_FROM_BOTTOM = 2
+};
+
+enum
+{
+    BHCS_BAR_HAS_CLOSED = 0,
+    BHCS_BAR_HAS_NOT_CLOSED = 1,
+    BHCS_SET_DEFAULTS = 2
+};
+
+enum
+{
+    DRAWSTYLE_LINE = 0,
+    DRAWSTYLE_BAR = 1,
+    DRAWSTYLE_IGNORE = 6,
+    DRAWSTYLE_HIDDEN = 7
+};
+
+enum
+{
+    SCT_ORDERTYPE_MARKET = 0,
+    SCT_ORDERTYPE_LIMIT = 1,
+    SCT_ORDERTYPE_STOP = 2,
+    SCT_ORDERTYPE_TRAILING_STOP = 6
+};
+
+enum
+{
+    SCT_TIF_DAY = 0,
+    SCT_TIF_GOOD_TILL_CANCELED = 1
+};
+
+// Returned by the trading functions when an order is rejected by the order flags.
+enum
+{
+    SCTRADING_ORDER_ERROR = -1
+};
+
+//================================================================================================//
+
+class SCString
+{
+public:
+    SCString()
+    {
+    }
+
+    SCString(const char* Text)
+        : m_Text(Text != NULL ? Text : "")
+    {
+    }
+
+    SCString& operator=(const char* Text)
+    {
+        m_Text = Text != NULL ? Text : "";
+        return *this;
+    }
+
+    SCString& Format(const char* FormatText, ...)
+    {
+        char Buffer[1024];
+
+        va_list Arguments;
+        va_start(Arguments, FormatText);
+        std::vsnprintf(Buffer, sizeof(Buffer), FormatText, Arguments);
+        va_end(Arguments);
+
+        m_Text = Buffer;
+        return *this;
+    }
+
+    SCString& Append(const char* Text)
+    {
+        m_Text += Text;
+        return *this;
+    }
+
+    const char* GetChars() const
+    {
+        return m_Text.c_str();
+    }
+
+    int GetLength() const
+    {
+        return static_cast<int>(m_Text.size());
+    }
+
+    bool operator==(const SCString& Other) const
+    {
+        return m_Text == Other.m_Text;
+    }
+
+    bool operator<(const SCString& Other) const
+    {
+        return m_Text < Other.m_Text;
+    }
+
+private:
+    std::string m_Text;
+};
+
+// Days since 1899-12-30, as the Sierra Chart date-time double.
+class SCDateTime
+{
+public:
+    SCDateTime(double Value = 0.0)
+        : m_Value(Value)
+    {
+    }
+
+    double GetAsDouble() const
+    {
+        return m_Value;
+    }
+
+private:
+    double m_Value;
+};
+
+// Like Sierra Chart's arrays, an out of range index reads and writes a dummy element instead of faulting.
+template <typename T>
+class c_SCArray
+{
+public:
+    c_SCArray()
+        : m_Data(NULL)
+        , m_Size(0)
+        , m_Dummy()
+    {
+    }
+
+    c_SCArray(const c_SCArray& Other)
+        : m_Data(NULL)
+        , m_Size(0)
+        , m_Dummy()
+    {
+        *this = Other;
+    }
+
+    c_SCArray& operator=(const c_SCArray& Other)
+    {
+        if (this == &Other)
+            return *this;
+
+        if (Other.m_Data == (Other.m_Storage.empty() ? NULL : &Other.m_Storage[0]))
+        {
+            m_Storage = Other.m_Storage;
+            m_Data = m_Storage.empty() ? NULL : &m_Storage[0];
+        }
+        else
+        {
+            m_Storage.clear();
+            m_Data = Other.m_Data;
+        }
+
+        m_Size = Other.m_Size;
+        return *this;
+    }
+
+    // Owns Size elements, zeroed.
+    void Resize(int Size)
+    {
+        m_Storage.assign(Size > 0 ? Size : 0, T());
+        m_Data = m_Storage.empty() ? NULL : &m_Storage[0];
+        m_Size = static_cast<int>(m_Storage.size());
+    }
+
+    // Views Size elements owned by the caller. They must outlive the array.
+    void Attach(T* Data, int Size)
+    {
+        m_Storage.clear();
+        m_Data = Data;
+        m_Size = Data != NULL && Size > 0 ? Size : 0;
+    }
+
+    T& operator[](int Index)
+    {
+        if (Index < 0 || Index >= m_Size)
+        {
+            m_Dummy = T();
+            return m_Dummy;
+        }
+
+        return m_Data[Index];
+    }
+
+    const T& operator[](int Index) const
+    {
+        if (Index < 0 || Index >= m_Size)
+            return m_Dummy;
+
+        return m_Data[Index];
+    }
+
+    int GetArraySize() const
+    {
+        return m_Size;
+    }
+
+private:
+    T* m_Data;
+    int m_Size;
+    std::vector<T> m_Storage;
+    T m_Dummy;
+};
+
+typedef c_SCArray<float> SCFloatArray;
+typedef SCFloatArray& SCFloatArrayRef;
+typedef c_SCArray<SCDateTime> SCDateTimeArray;
+typedef SCDateTimeArray& SCDateTimeArrayRef;
+
+struct s_SCSubgraph
+{
+    SCString Name;
+    int DrawStyle;
+    unsigned int PrimaryColor;
+    int LineWidth;
+    int DrawZeros;
+    SCFloatArray Data;
+    SCFloatArray Arrays[SC_SUBGRAPH_EXTRA_ARRAYS];
+
+    s_SCSubgraph()
+        : DrawStyle(DRAWSTYLE_IGNORE)
+        , PrimaryColor(0)
+        , LineWidth(1)
+        , DrawZeros(0)
+    {
+    }
+
+    float& operator[](int Index)
+    {
+        return Data[Index];
+    }
+
+    operator SCFloatArray&()
+    {
+        return Data;
+    }
+};
+
+typedef s_SCSubgraph& SCSubgraphRef;
+
+// One value slot shared by the integer style setters, as in Sierra Chart, plus the float and string values.
+struct s_SCInput
+{
+    SCString Name;
+    int IntValue;
+    float FloatValue;
+    std::string StringValue;
+    std::string CustomStrings;
+    int IntMin;
+    int IntMax;
+    bool IsInputData;
+
+    s_SCInput()
+        : IntValue(0)
+        , FloatValue(0.0f)
+        , IntMin(-2147483647 - 1)
+        , IntMax(2147483647)
+        , IsInputData(false)
+    {
+    }
+
+    void SetInt(int Value) { IntValue = Value; }
+    int GetInt() const { return IntValue; }
+    void SetIntLimits(int Min, int Max) { IntMin = Min; IntMax = Max; }
+    void SetYesNo(int Value) { IntValue = Value != 0; }
+    int GetYesNo() const { return IntValue != 0; }
+    void SetInputDataIndex(int Value) { IntValue = Value; IsInputData = true; }
+    int GetInputDataIndex() const { return IntValue; }
+    void SetCustomInputStrings(const char* Strings) { CustomStrings = Strings; }
+    void SetCustomInputIndex(int Value) { IntValue = Value; }
+    int GetIndex() const { return IntValue; }
+    void SetFloat(float Value) { FloatValue = Value; }
+    float GetFloat() const { return FloatValue; }
+    void SetString(const char* Value) { StringValue = Value != NULL ? Value : ""; }
+    const char* GetString() const { return StringValue.c_str(); }
+    void SetDescription(const char*) {}
+
+    // Sets the input from command line text, the way the Study Settings window would: a number sets the integer (clamped to the limits) and float values, and any text sets the string value.
+    // For an input with custom strings, the text can also be one of the strings.
+    void SetFromText(const char* Text)
+    {
+        StringValue = Text;
+
+        char* End = NULL;
+        const double Number = std::strtod(Text, &End);
+
+        if (End != Text)
+        {
+            const long Integer = static_cast<long>(Number);
+            IntValue = static_cast<int>(Integer < IntMin ? IntMin : (Integer > IntMax ? IntMax : Integer));
+            FloatValue = static_cast<float>(Number);
+            return;
+        }
+
+        if (std::strcmp(Text, "Yes") == 0 || std::strcmp(Text, "yes") == 0)
+            IntValue = 1;
+        else if (std::strcmp(Text, "No") == 0 || std::strcmp(Text, "no") == 0)
+            IntValue = 0;
+
+        int Index = 0;
+        size_t Start = 0;
+        while (Start <= CustomStrings.size() && !CustomStrings.empty())
+        {
+            size_t Stop = CustomStrings.find(';', Start);
+            if (Stop == std::string::npos)
+                Stop = CustomStrings.size();
+
+            if (CustomStrings.compare(Start, Stop - Start, Text) == 0)
+            {
+                IntValue = Index;
+                return;
+            }
+
+            Start = Stop + 1;
+            Index++;
+        }
+    }
+};
+
+typedef s_SCInput& SCInputRef;
+
+struct s_SCNewOrder
+{
+    int OrderQuantity;
+    int OrderType;
+    int TimeInForce;
+    int AttachedOrderTarget1Type;
+    int AttachedOrderStop1Type;
+    double Target1Offset;
+    double Stop1Offset;
+    double Price1;
+    SCString TextTag;
+
+    s_SCNewOrder()
+        : OrderQuantity(0)
+        , OrderType(SCT_ORDERTYPE_MARKET)
+        , TimeInForce(SCT_TIF_DAY)
+        , AttachedOrderTarget1Type(-1)
+        , AttachedOrderStop1Type(-1)
+        , Target1Offset(0.0)
+        , Stop1Offset(0.0)
+        , Price1(0.0)
+    {
+    }
+};
+
+struct s_SCPositionData
+{
+    double PositionQuantity;
+    double AveragePrice;
+    double OpenProfitLoss;
+    double CumulativeProfitLoss;
+    double LastTradeProfitLoss;
+    int TotalTrades;
+    int WinTrades;
+
+    s_SCPositionData()
+        : PositionQuantity(0.0)
+        , AveragePrice(0.0)
+        , OpenProfitLoss(0.0)
+        , CumulativeProfitLoss(0.0)
+        , LastTradeProfitLoss(0.0)
+        , TotalTrades(0)
+        , WinTrades(0)
+    {
+    }
+};
+
+// Simulated account behind the trading functions. Profits are in price units for one contract.
+struct s_HeadlessAccount
+{
+    s_BracketPosition Position;
+    s_TradeStats Stats;
+    double LastTradeProfit;
+    int LastEntryIndex;
+
+    s_HeadlessAccount()
+        : LastTradeProfit(0.0)
+        , LastEntryIndex(-1)
+    {
+    }
+
+    void Close(double Price)
+    {
+        LastTradeProfit = Position.Close(Price);
+        Stats.Add(LastTradeProfit);
+    }
+
+    // Checks the attached orders of an open position against bar Index (called by the host before the study sees the bar).
+    void StepBar(int Index, float High, float Low)
+    {
+        double ExitPrice = 0.0;
+        if (Position.IsOpen() && Index > Position.EntryIndex && Position.Step(High, Low, ExitPrice))
+            Close(ExitPrice);
+    }
+};
+
+//================================================================================================//
+
+// Called by the trading functions after an entry fills, for a host that forwards the orders (Live_Host.h).
+typedef void (*HeadlessEntryCallback)(void* p_Context, int Direction, int BarIndex, double Price);
+
+struct s_sc
+{
+    int SetDefaults;
+    int AutoLoop;
+    int GraphRegion;
+    int Index;
+    int ArraySize;
+    int UpdateStartIndex;
+    int IsFullRecalculation;
+    int LastCallToFunction;
+    int UpdateAlways;
+    int ChartNumber;
+    int StudyGraphInstanceID;
+    int FreeDLL;
+    int DownloadingHistoricalData;
+
+    SCString GraphName;
+    SCString Symbol;
+    float TickSize;
+
+    int AllowMultipleEntriesInSameDirection;
+    int MaximumPositionAllowed;
+    int SupportReversals;
+    int SendOrdersToTradeService;
+    int AllowOppositeEntryWithOpposingPositionOrOrders;
+    int SupportAttachedOrdersForTrading;
+    int CancelAllOrdersOnEntriesAndReversals;
+    int AllowEntryWithWorkingOrders;
+    int CancelAllWorkingOrdersOnExit;
+    int AllowOnlyOneTradePerBar;
+    int MaintainTradeStatisticsAndTradesData;
+
+    s_SCSubgraph Subgraph[SC_SUBGRAPHS_AVAILABLE];
+    s_SCInput Input[SC_INPUTS_AVAILABLE];
+    SCFloatArray BaseDataIn[SC_BASE_DATA_ARRAYS];
+    SCDateTimeArray BaseDateTimeIn;
+    SCDateTime LatestDateTimeForLastBar;
+
+    // Host side, not part of the ACSIL interface.
+    s_HeadlessAccount Account;
+    int LastBarHasClosed;
+    int LogMessages;
+    HeadlessEntryCallback p_EntryCallback;
+    void* p_EntryContext;
+
+    s_sc()
+        : SetDefaults(0)
+        , AutoLoop(1)
+        , GraphRegion(0)
+        , Index(0)
+        , ArraySize(0)
+        , UpdateStartIndex(0)
+        , IsFullRecalculation(0)
+        , LastCallToFunction(0)
+        , UpdateAlways(0)
+        , ChartNumber(1)
+        , StudyGraphInstanceID(1)
+        , FreeDLL(0)
+        , DownloadingHistoricalData(0)
+        , TickSize(0.25f)
+        , AllowMultipleEntriesInSameDirection(0)
+        , MaximumPositionAllowed(1)
+        , SupportReversals(0)
+        , SendOrdersToTradeService(0)
+        , AllowOppositeEntryWithOpposingPositionOrOrders(0)
+        , SupportAttachedOrdersForTrading(0)
+        , CancelAllOrdersOnEntriesAndReversals(0)
+        , AllowEntryWithWorkingOrders(0)
+        , CancelAllWorkingOrdersOnExit(0)
+        , AllowOnlyOneTradePerBar(1)
+        , MaintainTradeStatisticsAndTradesData(0)
+        , LastBarHasClosed(1)
+        , LogMessages(1)
+        , p_EntryCallback(NULL)
+        , p_EntryContext(NULL)
+    {
+        std::memset(m_PersistentPointers, 0, sizeof(m_PersistentPointers));
+        std::memset(m_PersistentInts, 0, sizeof(m_PersistentInts));
+        std::memset(m_PersistentDoubles, 0, sizeof(m_PersistentDoubles));
+    }
+
+    // Persistent variables
+    void* GetPersistentPointer(int Key) { return Key >= 0 && Key < SC_PERSISTENT_VARIABLES ? m_PersistentPointers[Key] : NULL; }
+    void SetPersistentPointer(int Key, void* Pointer) { if (Key >= 0 && Key < SC_PERSISTENT_VARIABLES) m_PersistentPointers[Key] = Pointer; }
+    int& GetPersistentInt(int Key) { return m_PersistentInts[Key >= 0 && Key < SC_PERSISTENT_VARIABLES ? Key : 0]; }
+    double& GetPersistentDouble(int Key) { return m_PersistentDoubles[Key >= 0 && Key < SC_PERSISTENT_VARIABLES ? Key : 0]; }
+
+    // Every bar before the last has closed. The last one has closed when the host replays complete bars.
+    int GetBarHasClosedStatus(int BarIndex)
+    {
+        if (BarIndex < ArraySize - 1 || (BarIndex == ArraySize - 1 && LastBarHasClosed))
+            return BHCS_BAR_HAS_CLOSED;
+
+        return BHCS_BAR_HAS_NOT_CLOSED;
+    }
+
+    int GetBarHasClosedStatus()
+    {
+        return GetBarHasClosedStatus(Index);
+    }
+
+    // Same rule as Sierra Chart: the sign of First - Second at BarIndex against the last bar before it where the two were not equal.
+    int CrossOver(SCFloatArrayRef First, SCFloatArrayRef Second, int BarIndex)
+    {
+        const float Current = First[BarIndex] - Second[BarIndex];
+        if (Current == 0.0f)
+            return NO_CROSS;
+
+        for (int Previous = BarIndex - 1; Previous >= 0; Previous--)
+        {
+            const float Difference = First[Previous] - Second[Previous];
+            if (Difference == 0.0f)
+                continue;
+
+            if (Difference < 0.0f && Current > 0.0f)
+                return CROSS_FROM_BOTTOM;
+            if (Difference > 0.0f && Current < 0.0f)
+                return CROSS_FROM_TOP;
+
+            return NO_CROSS;
+        }
+
+        return NO_CROSS;
+    }
+
+    int CrossOver(SCFloatArrayRef First, SCFloatArrayRef Second)
+    {
+        return CrossOver(First, Second, Index);
+    }
+
+    // Trading
+    int GetTradePosition(s_SCPositionData& PositionData)
+    {
+        const s_BracketPosition& Position = Account.Position;
+
+        PositionData.PositionQuantity = Position.Direction;
+        PositionData.AveragePrice = Position.IsOpen() ? Position.EntryPrice : 0.0;
+        PositionData.OpenProfitLoss = Position.IsOpen() ? Position.Direction * (BaseDataIn[SC_LAST][ArraySize - 1] - Position.EntryPrice) : 0.0;
+        PositionData.CumulativeProfitLoss = Account.Stats.NetProfit;
+        PositionData.LastTradeProfitLoss = Account.LastTradeProfit;
+        PositionData.TotalTrades = Account.Stats.Trades;
+        PositionData.WinTrades = Account.Stats.Wins;
+        return 1;
+    }
+
+    double BuyEntry(s_SCNewOrder& NewOrder, int BarIndex)
+    {
+        return Entry(NewOrder, BarIndex, 1);
+    }
+
+    double BuyEntry(s_SCNewOrder& NewOrder)
+    {
+        return Entry(NewOrder, Index, 1);
+    }
+
+    double SellEntry(s_SCNewOrder& NewOrder, int BarIndex)
+    {
+        return Entry(NewOrder, BarIndex, -1);
+    }
+
+    double SellEntry(s_SCNewOrder& NewOrder)
+    {
+        return Entry(NewOrder, Index, -1);
+    }
+
+    // Closes a short position at the close of BarIndex.
+    double BuyExit(s_SCNewOrder&, int BarIndex)
+    {
+        return Exit(BarIndex, -1);
+    }
+
+    // Closes a long position at the close of BarIndex.
+    double SellExit(s_SCNewOrder&, int BarIndex)
+    {
+        return Exit(BarIndex, 1);
+    }
+
+    // There are no working orders apart from the attached ones, which go with the position.
+    int CancelAllOrders()
+    {
+        return 1;
+    }
+
+    double FlattenPosition()
+    {
+        if (!Account.Position.IsOpen())
+            return 0.0;
+
+        Account.Close(BaseDataIn[SC_LAST][ArraySize - 1]);
+        return 1.0;
+    }
+
+    void AddMessageToLog(const SCString& Message, int ShowLog)
+    {
+        AddMessageToLog(Message.GetChars(), ShowLog);
+    }
+
+    void AddMessageToLog(const char* Message, int)
+    {
+        if (LogMessages)
+            std::fprintf(stderr, "%s\n", Message);
+    }
+
+private:
+    s_sc(const s_sc&);
+    s_sc& operator=(const s_sc&);
+
+    double Entry(const s_SCNewOrder& NewOrder, int BarIndex, int Direction)
+    {
+        s_BracketPosition& Position = Account.Position;
+
+        if (BarIndex < 0 || BarIndex >= ArraySize)
+            return SCTRADING_ORDER_ERROR;
+
+        if (AllowOnlyOneTradePerBar && Account.LastEntryIndex == BarIndex)
+            return SCTRADING_ORDER_ERROR;
+
+        if (Position.IsOpen() && Position.Direction == Direction)
+            return SCTRADING_ORDER_ERROR;
+
+        const double Price = BaseDataIn[SC_LAST][BarIndex];
+
+        if (Position.IsOpen())
+        {
+            if (!SupportReversals)
+                return SCTRADING_ORDER_ERROR;
+
+            Account.Close(Price);
+        }
+
+        const double TargetOffset = NewOrder.AttachedOrderTarget1Type >= 0 ? NewOrder.Target1Offset : 0.0;
+        const double StopOffset = NewOrder.AttachedOrderStop1Type >= 0 ? NewOrder.Stop1Offset : 0.0;
+
+        Position.Open(Direction, BarIndex, Price, TargetOffset, StopOffset);
+        Account.LastEntryIndex = BarIndex;
+
+        if (p_EntryCallback != NULL)
+            p_EntryCallback(p_EntryContext, Direction, BarIndex, Price);
+
+        return 1.0;
+    }
+
+    double Exit(int BarIndex, int Direction)
+    {
+        if (BarIndex < 0 || BarIndex >= ArraySize || Account.Position.Direction != Direction)
+            return SCTRADING_ORDER_ERROR;
+
+        Account.Close(BaseDataIn[SC_LAST][BarIndex]);
+        return 1.0;
+    }
+
+    void* m_PersistentPointers[SC_PERSISTENT_VARIABLES];
+    int m_PersistentInts[SC_PERSISTENT_VARIABLES];
+    double m_PersistentDoubles[SC_PERSISTENT_VARIABLES];
+};
+
+typedef s_sc& SCStudyInterfaceRef;
+typedef void (*SCStudyFunction)(SCStudyInterfaceRef);
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "Async_Writer.h"
+
+/*
+Signal to order latency tracing for the strategies.
+
+The study thread pushes a fixed size record for each signal and for each order call into a c_AsyncRecordWriter (Async_Writer.h), whose thread appends them to a binary file every millisecond, so disk writes never run on the study thread.
+Each tracer takes a number of its own in the process (Tracer), and the records of one signal share the tracer's number and the signal's Sequence number:
+LATENCY_SIGNAL - the study has seen the cross. MarketTime is the time of the trade that triggered the call (sc.LatestDateTimeForLastBar), as an SCDateTime value in days.
+LATENCY_ORDER_BEGIN - just before sc.BuyEntry or sc.SellEntry.
+LATENCY_ORDER_END - when the entry call has returned. Result is its return value.
+SystemTime is std::chrono::system_clock in nanoseconds since 1970, so it can be compared with exchange and feed timestamps. SteadyTime is std::chrono::steady_clock in nanoseconds, for the intervals between records.
+The file starts with an s_LatencyFileHeader, followed by the records as they are written (s_LatencyRecord, little endian, 48 bytes). Headless/Latency_Report.cpp prints the latency distributions from it.
+*/
+
+enum e_LatencyRecordKind
+{
+    LATENCY_SIGNAL = 1,
+    LATENCY_ORDER_BEGIN = 2,
+    LATENCY_ORDER_END = 3
+};
+
+#pragma pack(push, 1)
+
+struct s_LatencyFileHeader
+{
+    char Magic[8];
+    unsigned int Version;
+    unsigned int RecordSize;
+};
+
+struct s_LatencyRecord
+{
+    long long SystemTime;
+    long long SteadyTime;
+    double MarketTime;
+    double Result;
+    unsigned int Sequence;
+    int BarIndex;
+    short Kind;
+    short Direction;
+    unsigned int Tracer;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(s_LatencyFileHeader) == 16, "s_LatencyFileHeader must match the file format");
+static_assert(sizeof(s_LatencyRecord) == 48, "s_LatencyRecord must match the file format");
+
+const char LATENCY_FILE_MAGIC[8] = { 'X', 'O', 'V', 'R', 'L', 'A', 'T', '1' };
+const unsigned int LATENCY_FILE_VERSION = 1;
+const unsigned int LATENCY_RING_RECORDS = 1u << 14;
+
+inline unsigned int Latency_NextTracerNumber()
+{
+    static std::atomic<unsigned int> s_Next(0);
+    return ++s_Next;
+}
+
+inline void Latency_WriteHeader(std::FILE* File)
+{
+    s_LatencyFileHeader Header;
+    std::memcpy(Header.Magic, LATENCY_FILE_MAGIC, sizeof(Header.Magic));
+    Header.Version = LATENCY_FILE_VERSION;
+    Header.RecordSize = sizeof(s_LatencyRecord);
+    std::fwrite(&Header, sizeof(Header), 1, File);
+}
+
+// The records are written as they are, so several instances can append to one file. Only the instance that creates the file writes the header; Latency_Report skips a header repeated by instances that found the same empty file.
+inline void Latency_WriteBatch(std::FILE* File, const s_LatencyRecord* Records, unsigned int Count)
+{
+    std::fwrite(Records, sizeof(s_LatencyRecord), Count, File);
+}
+
+class c_LatencyTracer
+{
+public:
+    c_LatencyTracer()
+        : m_Sequence(0)
+        , m_TracerNumber(Latency_NextTracerNumber())
+    {
+    }
+
+    // Starts tracing to Path, appending to the file when it exists. Returns false when the file cannot be opened.
+    bool Open(const char* Path)
+    {
+        return m_Writer.Open(Path, Latency_WriteHeader, Latency_WriteBatch, 1);
+    }
+
+    // Stops the writer after it has drained the ring, and closes the file.
+    void Close()
+    {
+        m_Writer.Close();
+    }
+
+    bool IsOpen() const
+    {
+        return m_Writer.IsOpen();
+    }
+
+    // Records dropped because the ring was full.
+    unsigned long long Dropped() const
+    {
+        return m_Writer.Dropped();
+    }
+
+    // Starts a new signal and returns its sequence number for the order records.
+    unsigned int Signal(int BarIndex, int Direction, double MarketTime)
+    {
+        const unsigned int Sequence = ++m_Sequence;
+        Record(LATENCY_SIGNAL, Sequence, BarIndex, Direction, MarketTime, 0.0);
+        return Sequence;
+    }
+
+    // Study thread only.
+    void Record(int Kind, unsigned int Sequence, int BarIndex, int Direction, double MarketTime, double Result)
+    {
+        if (!m_Writer.IsOpen())
+            return;
+
+        s_LatencyRecord Entry;
+        Entry.SystemTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        Entry.SteadyTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        Entry.MarketTime = MarketTime;
+        Entry.Result = Result;
+        Entry.Sequence = Sequence;
+        Entry.BarIndex = BarIndex;
+        Entry.Kind = static_cast<short>(Kind);
+        Entry.Direction = static_cast<short>(Direction);
+        Entry.Tracer = m_TracerNumber;
+
+        m_Writer.Push(Entry);
+    }
+
+private:
+    c_LatencyTracer(const c_LatencyTracer&);
+    c_LatencyTracer& operator=(const c_LatencyTracer&);
+
+    c_AsyncRecordWriter<s_LatencyRecord, LATENCY_RING_RECORDS> m_Writer;
+    unsigned int m_Sequence;
+    unsigned int m_TracerNumber;
+};
+
+#endif
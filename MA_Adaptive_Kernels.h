@@ -0,0 +1,677 @@
+#ifndef MA_ADAPTIVE_KERNELS_H
+#define MA_ADAPTIVE_KERNELS_H
+
+#include <cmath>
+#include <vector>
+
+#include "MA_Kernels.h"
+
+/*
+Incremental kernels for the adaptive and weighted averages: Kaufman's adaptive average (KAMA), the Arnaud Legoux average (ALMA), Tillson's T3, and the volume weighted average (VWMA).
+
+They follow the rules of the MA_Kernels.h kernels: the same index as the previous call is an intrabar update that only re-reads the live value, the next index commits the closed bar, and any other index resyncs from the input array. Attach(Scratch, Length) takes ScratchFloats(Length) floats from the caller so Update never allocates.
+KAMA steps its previous value by (Efficiency * (Fast - Slow) + Slow)^2 of the distance to the input, Efficiency being the net change over Length bars divided by the sum of the bar to bar changes. That sum is an s_MASum over a ring of the closed changes, so a bar is O(1). The efficiency is not linear in the live value, so a tick computes it from the committed sum, the two inputs it is measured against and the live value: a handful of operations.
+The ALMA weighs its window with a Gaussian that does not move with the window, so no running sum carries over from one bar to the next. The closed part of the window is kept twice over in its ring (s_ALMAKernel), so it is contiguous at every position and a new bar costs one dot product of Length - 1 values; a tick is one multiply-add on the live line, where a rescanning study computes the whole window on every tick.
+T3 is a cascade of six EMAs combined with the volume factor, linear in the input, so a bar commits six EMA steps and a tick is one multiply-add. Its state cannot be recovered from its output, so a resync replays the input from bar 0; MA_Batch_T3 can leave its kernel at the last bar so the calls after a full recalculation go on from there.
+The VWMA keeps s_MASum sums of price times volume and of volume over rings of the closed prices and volumes. A tick divides the committed sums with the live price and volume added, since the live bar's volume grows during the bar.
+The batch functions for full recalculations step the same state over the whole array (the ALMA computes the same dot products directly), so a recalculation and the incremental updates write the same values. Bars before an average has its full window are 0, as in MA_Kernels.h; T3 starts at bar 0 like the EMA.
+Nothing here depends on sierrachart.h.
+*/
+
+// The smoothing constants of KAMA are those of a 2 bar EMA at full efficiency and of a 30 bar EMA at none.
+const double MA_KAMA_FAST_ALPHA = 2.0 / (2 + 1);
+const double MA_KAMA_SLOW_ALPHA = 2.0 / (30 + 1);
+
+// The ALMA's Gaussian peaks at this fraction of the window from the oldest value, with a width of Length / MA_ALMA_SIGMA.
+const double MA_ALMA_OFFSET = 0.85;
+const double MA_ALMA_SIGMA = 6.0;
+
+const double MA_T3_VOLUME_FACTOR = 0.7;
+
+//================================================================================================//
+// Kaufman adaptive moving average over Length bars of efficiency.
+// Out[Length - 1] = In[Length - 1], then Out[i] = Out[i - 1] + Smoothing * (In[i] - Out[i - 1]).
+
+struct s_KAMAKernel
+{
+    int Length;
+    int CurrentIndex;
+    double Committed;
+    s_MASum Volatility;
+    s_ValueRing Changes;
+
+    s_KAMAKernel()
+        : Length(0)
+        , CurrentIndex(-1)
+        , Committed(0.0)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Committed = 0.0;
+        Volatility.Clear();
+        Changes.Clear();
+    }
+
+    // The ring of the Length - 1 closed changes in the window.
+    static int ScratchFloats(int Length)
+    {
+        return Length > 1 ? Length - 1 : 0;
+    }
+
+    void Attach(float* Scratch, int NewLength)
+    {
+        Length = NewLength;
+        Changes.Attach(Scratch, ScratchFloats(Length));
+        Reset();
+    }
+
+    // Out is this average's output history, as for s_EMAKernel. It may be NULL, in which case a resync replays the input from bar 0.
+    float Update(const float* In, const float* Out, int Index, int NewLength)
+    {
+        if (NewLength < 1)
+            return 0.0f;
+
+        if (NewLength != Length)
+        {
+            Length = NewLength;
+            Changes.Resize(Length - 1);
+            Reset();
+        }
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Commit(In, CurrentIndex);
+            else
+                Resync(In, Out, Index);
+        }
+
+        CurrentIndex = Index;
+
+        return static_cast<float>(Value(In, Index, In[Index]));
+    }
+
+private:
+    // The average at Index for the input value Live, with the changes of the bars before Index in the ring and Committed the average at Index - 1.
+    double Value(const float* In, int Index, float Live) const
+    {
+        if (Index < Length - 1)
+            return 0.0;
+
+        if (Index == Length - 1)
+            return Live;
+
+        const double Change = std::fabs(static_cast<double>(Live) - In[Index - Length]);
+        const double Total = Volatility.Value() + std::fabs(static_cast<double>(Live) - In[Index - 1]);
+        const double Efficiency = Total > 0.0 ? Change / Total : 0.0;
+        const double Smoothing = Efficiency * (MA_KAMA_FAST_ALPHA - MA_KAMA_SLOW_ALPHA) + MA_KAMA_SLOW_ALPHA;
+
+        return Committed + Smoothing * Smoothing * (Live - Committed);
+    }
+
+    void Commit(const float* In, int Index)
+    {
+        Committed = Value(In, Index, In[Index]);
+
+        if (Index > 0)
+            PushChange(static_cast<float>(std::fabs(static_cast<double>(In[Index]) - In[Index - 1])));
+    }
+
+    void PushChange(float Change)
+    {
+        if (Changes.Capacity == 0)
+            return;
+
+        if (Changes.IsFull())
+            Volatility.Add(-static_cast<double>(Changes.Oldest()));
+
+        Volatility.Add(Change);
+        Changes.Push(Change);
+
+        if (Volatility.Drifted())
+        {
+            Volatility.Clear();
+            for (int Offset = 0; Offset < Changes.Count; Offset++)
+                Volatility.Add(Changes.At(Offset));
+        }
+    }
+
+    void Resync(const float* In, const float* Out, int Index)
+    {
+        Reset();
+
+        if (Out == NULL)
+        {
+            for (int BarIndex = 0; BarIndex < Index; BarIndex++)
+                Commit(In, BarIndex);
+
+            return;
+        }
+
+        int FirstIndex = Index - (Length - 1);
+        if (FirstIndex < 1)
+            FirstIndex = 1;
+
+        for (int BarIndex = FirstIndex; BarIndex < Index; BarIndex++)
+            PushChange(static_cast<float>(std::fabs(static_cast<double>(In[BarIndex]) - In[BarIndex - 1])));
+
+        if (Index > Length - 1)
+            Committed = Out[Index - 1];
+    }
+};
+
+//================================================================================================//
+// Arnaud Legoux moving average: the Length values ending at the live bar weighted by a Gaussian, oldest first.
+
+// The Gaussian weights of a Length bar ALMA, oldest first, not normalized. The kernel and the batch function divide by their sum.
+inline void MA_ALMAWeights(float* Weights, int Length)
+{
+    const double Peak = MA_ALMA_OFFSET * (Length - 1);
+    const double Width = Length / MA_ALMA_SIGMA;
+
+    for (int Offset = 0; Offset < Length; Offset++)
+    {
+        const double Distance = Offset - Peak;
+        Weights[Offset] = static_cast<float>(std::exp(-(Distance * Distance) / (2.0 * Width * Width)));
+    }
+}
+
+inline double MA_ALMANorm(const float* Weights, int Length)
+{
+    double Norm = 0.0;
+    for (int Offset = 0; Offset < Length; Offset++)
+        Norm += Weights[Offset];
+
+    return Norm;
+}
+
+// The live line of the bar after the Length - 1 closed values at Window, oldest first.
+// Four partial sums keep the additions from waiting on each other; the kernel and the batch function both come here, so they add in the same order.
+inline s_LiveLine MA_ALMALine(const float* Weights, const float* Window, int Length, double Norm)
+{
+    const int Closed = Length - 1;
+    double Dot[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+    int Offset = 0;
+    for (; Offset + 4 <= Closed; Offset += 4)
+    {
+        Dot[0] += static_cast<double>(Weights[Offset]) * Window[Offset];
+        Dot[1] += static_cast<double>(Weights[Offset + 1]) * Window[Offset + 1];
+        Dot[2] += static_cast<double>(Weights[Offset + 2]) * Window[Offset + 2];
+        Dot[3] += static_cast<double>(Weights[Offset + 3]) * Window[Offset + 3];
+    }
+
+    for (; Offset < Closed; Offset++)
+        Dot[0] += static_cast<double>(Weights[Offset]) * Window[Offset];
+
+    s_LiveLine Line;
+    Line.Set(((Dot[0] + Dot[1]) + (Dot[2] + Dot[3])) / Norm, Weights[Length - 1] / Norm);
+    return Line;
+}
+
+struct s_ALMAKernel
+{
+    int Length;
+    int CurrentIndex;
+    double Norm;
+    float* Weights;
+    float* Window;
+    int Count;
+    int Head;
+    s_LiveLine Live;
+    std::vector<float> Storage;
+
+    s_ALMAKernel()
+        : Length(0)
+        , CurrentIndex(-1)
+        , Norm(1.0)
+        , Weights(NULL)
+        , Window(NULL)
+        , Count(0)
+        , Head(0)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Count = 0;
+        Head = 0;
+    }
+
+    // The weights, then the Length - 1 closed values twice over.
+    static int ScratchFloats(int Length)
+    {
+        return Length > 0 ? Length + 2 * (Length - 1) : 0;
+    }
+
+    void Attach(float* Scratch, int NewLength)
+    {
+        if (Scratch == NULL)
+        {
+            Resize(NewLength);
+            return;
+        }
+
+        Storage.clear();
+        Bind(Scratch, NewLength);
+    }
+
+    float Update(const float* In, int Index, int NewLength)
+    {
+        if (NewLength < 1)
+            return 0.0f;
+
+        if (NewLength != Length)
+            Resize(NewLength);
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Commit(In[CurrentIndex]);
+            else
+                Resync(In, Index);
+
+            if (Count == Length - 1)
+                Live = MA_ALMALine(Weights, Window + Head, Length, Norm);
+            else
+                Live.Set(0.0, 0.0);
+        }
+
+        CurrentIndex = Index;
+
+        return Live.At(In[Index]);
+    }
+
+private:
+    void Resize(int NewLength)
+    {
+        Storage.assign(ScratchFloats(NewLength), 0.0f);
+        Bind(Storage.empty() ? NULL : &Storage[0], NewLength);
+    }
+
+    void Bind(float* Scratch, int NewLength)
+    {
+        Length = NewLength;
+        Weights = Scratch;
+        Window = Scratch != NULL ? Scratch + Length : NULL;
+
+        if (Weights != NULL)
+        {
+            MA_ALMAWeights(Weights, Length);
+            Norm = MA_ALMANorm(Weights, Length);
+        }
+
+        Reset();
+    }
+
+    // Each value goes in at its slot and at its slot plus the capacity, so Window + Head holds the window oldest first.
+    void Commit(float Value)
+    {
+        const int Capacity = Length - 1;
+        if (Capacity == 0)
+            return;
+
+        if (Count < Capacity)
+        {
+            Window[Count] = Value;
+            Window[Count + Capacity] = Value;
+            Count++;
+            return;
+        }
+
+        Window[Head] = Value;
+        Window[Head + Capacity] = Value;
+
+        if (++Head == Capacity)
+            Head = 0;
+    }
+
+    void Resync(const float* In, int Index)
+    {
+        Reset();
+
+        int FirstIndex = Index - (Length - 1);
+        if (FirstIndex < 0)
+            FirstIndex = 0;
+
+        for (int BarIndex = FirstIndex; BarIndex < Index; BarIndex++)
+            Commit(In[BarIndex]);
+    }
+};
+
+//================================================================================================//
+// Tillson T3: six chained EMAs e1..e6 of Alpha = 2 / (Length + 1), T3 = C1 * e6 + C2 * e5 + C3 * e4 + C4 * e3 with the volume factor V:
+// C1 = -V^3, C2 = 3V^2 + 3V^3, C3 = -6V^2 - 3V - 3V^3, C4 = 1 + 3V + 3V^2 + V^3. Every EMA starts at In[0].
+
+struct s_T3Kernel
+{
+    int Length;
+    int CurrentIndex;
+    double Alpha;
+    bool Started;
+    double Stages[6];
+    s_LiveLine Live;
+
+    s_T3Kernel()
+        : Length(0)
+        , CurrentIndex(-1)
+        , Alpha(1.0)
+        , Started(false)
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Started = false;
+        for (int Stage = 0; Stage < 6; Stage++)
+            Stages[Stage] = 0.0;
+    }
+
+    static int ScratchFloats(int)
+    {
+        return 0;
+    }
+
+    void Attach(float*, int)
+    {
+        Reset();
+    }
+
+    float Update(const float* In, int Index, int NewLength)
+    {
+        if (NewLength < 1)
+            return 0.0f;
+
+        if (NewLength != Length)
+        {
+            Length = NewLength;
+            Alpha = 2.0 / (Length + 1);
+            Reset();
+        }
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+            {
+                Commit(In[CurrentIndex]);
+            }
+            else
+            {
+                Reset();
+                for (int BarIndex = 0; BarIndex < Index; BarIndex++)
+                    Commit(In[BarIndex]);
+            }
+
+            SetLiveLine(Index);
+        }
+
+        CurrentIndex = Index;
+
+        return Live.At(In[Index]);
+    }
+
+private:
+    static double Combine(const double* Values)
+    {
+        const double V = MA_T3_VOLUME_FACTOR;
+        const double C1 = -V * V * V;
+        const double C2 = 3.0 * V * V + 3.0 * V * V * V;
+        const double C3 = -6.0 * V * V - 3.0 * V - 3.0 * V * V * V;
+        const double C4 = 1.0 + 3.0 * V + 3.0 * V * V + V * V * V;
+
+        return C1 * Values[5] + C2 * Values[4] + C3 * Values[3] + C4 * Values[2];
+    }
+
+    // The cascade for a live value of 0 gives the base, and each stage passes on Alpha of its input, so the slope is the combination of Alpha^1..Alpha^6.
+    void SetLiveLine(int Index)
+    {
+        if (Index == 0)
+        {
+            Live.Set(0.0, 1.0);
+            return;
+        }
+
+        double Base[6];
+        double Slope[6];
+        double Base_In = 0.0;
+        double Slope_In = 1.0;
+
+        for (int Stage = 0; Stage < 6; Stage++)
+        {
+            Base[Stage] = Alpha * Base_In + (1.0 - Alpha) * Stages[Stage];
+            Slope[Stage] = Alpha * Slope_In;
+            Base_In = Base[Stage];
+            Slope_In = Slope[Stage];
+        }
+
+        Live.Set(Combine(Base), Combine(Slope));
+    }
+
+    void Commit(float Value)
+    {
+        if (!Started)
+        {
+            for (int Stage = 0; Stage < 6; Stage++)
+                Stages[Stage] = Value;
+
+            Started = true;
+            return;
+        }
+
+        double Stage_In = Value;
+        for (int Stage = 0; Stage < 6; Stage++)
+        {
+            Stages[Stage] = Alpha * Stage_In + (1.0 - Alpha) * Stages[Stage];
+            Stage_In = Stages[Stage];
+        }
+    }
+};
+
+//================================================================================================//
+// Volume weighted moving average: the sum of price times volume over the Length bars ending at the live bar, divided by their volume.
+// A window without volume gives the plain average of its prices.
+
+struct s_VWMAKernel
+{
+    int Length;
+    int CurrentIndex;
+    s_MASum PriceVolume;
+    s_MASum Volume;
+    s_MASum Price;
+    s_ValueRing Prices;
+    s_ValueRing Volumes;
+
+    s_VWMAKernel()
+        : Length(0)
+        , CurrentIndex(-1)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        PriceVolume.Clear();
+        Volume.Clear();
+        Price.Clear();
+        Prices.Clear();
+        Volumes.Clear();
+    }
+
+    // The rings of the Length - 1 closed prices and volumes.
+    static int ScratchFloats(int Length)
+    {
+        return Length > 1 ? 2 * (Length - 1) : 0;
+    }
+
+    void Attach(float* Scratch, int NewLength)
+    {
+        Length = NewLength;
+
+        const int Ring = Length > 1 ? Length - 1 : 0;
+        Prices.Attach(Scratch, Ring);
+        Volumes.Attach(Scratch != NULL ? Scratch + Ring : NULL, Ring);
+        Reset();
+    }
+
+    float Update(const float* In, const float* VolumeIn, int Index, int NewLength)
+    {
+        if (NewLength < 1)
+            return 0.0f;
+
+        if (NewLength != Length)
+        {
+            Length = NewLength;
+            Prices.Resize(Length - 1);
+            Volumes.Resize(Length - 1);
+            Reset();
+        }
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Commit(In[CurrentIndex], VolumeIn[CurrentIndex]);
+            else
+                Resync(In, VolumeIn, Index);
+        }
+
+        CurrentIndex = Index;
+
+        if (!Prices.IsFull())
+            return 0.0f;
+
+        const float Live_Price = In[Index];
+        const float Live_Volume = VolumeIn[Index];
+        const double Total_Volume = Volume.Value() + Live_Volume;
+
+        if (Total_Volume > 0.0)
+            return static_cast<float>((PriceVolume.Value() + static_cast<double>(Live_Price) * Live_Volume) / Total_Volume);
+
+        return static_cast<float>((Price.Value() + Live_Price) / Length);
+    }
+
+private:
+    void Commit(float Value, float BarVolume)
+    {
+        if (Prices.Capacity == 0)
+            return;
+
+        if (Prices.IsFull())
+        {
+            const float Oldest_Price = Prices.Oldest();
+            const float Oldest_Volume = Volumes.Oldest();
+            PriceVolume.Add(-static_cast<double>(Oldest_Price) * Oldest_Volume);
+            Volume.Add(-static_cast<double>(Oldest_Volume));
+            Price.Add(-static_cast<double>(Oldest_Price));
+        }
+
+        PriceVolume.Add(static_cast<double>(Value) * BarVolume);
+        Volume.Add(BarVolume);
+        Price.Add(Value);
+        Prices.Push(Value);
+        Volumes.Push(BarVolume);
+
+        if (PriceVolume.Drifted() || Volume.Drifted() || Price.Drifted())
+            Resum();
+    }
+
+    void Resum()
+    {
+        PriceVolume.Clear();
+        Volume.Clear();
+        Price.Clear();
+
+        for (int Offset = 0; Offset < Prices.Count; Offset++)
+        {
+            const float Value = Prices.At(Offset);
+            const float BarVolume = Volumes.At(Offset);
+            PriceVolume.Add(static_cast<double>(Value) * BarVolume);
+            Volume.Add(BarVolume);
+            Price.Add(Value);
+        }
+    }
+
+    void Resync(const float* In, const float* VolumeIn, int Index)
+    {
+        Reset();
+
+        int FirstIndex = Index - (Length - 1);
+        if (FirstIndex < 0)
+            FirstIndex = 0;
+
+        for (int BarIndex = FirstIndex; BarIndex < Index; BarIndex++)
+            Commit(In[BarIndex], VolumeIn[BarIndex]);
+    }
+};
+
+//================================================================================================//
+// Batch versions for full recalculations
+
+inline void MA_Batch_KAMA(const float* In, float* Out, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    s_KAMAKernel Kernel;
+    for (int Index = 0; Index < Count; Index++)
+        Out[Index] = Kernel.Update(In, NULL, Index, Length);
+}
+
+// The dot product of every window, with the weights and norm of the kernel.
+inline void MA_Batch_ALMA(const float* In, float* Out, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    if (Count < Length)
+    {
+        for (int Index = 0; Index < Count; Index++)
+            Out[Index] = 0.0f;
+
+        return;
+    }
+
+    std::vector<float> Weights(Length);
+    MA_ALMAWeights(&Weights[0], Length);
+    const double Norm = MA_ALMANorm(&Weights[0], Length);
+
+    for (int Index = 0; Index < Length - 1; Index++)
+        Out[Index] = 0.0f;
+
+    for (int Index = Length - 1; Index < Count; Index++)
+        Out[Index] = MA_ALMALine(&Weights[0], In + Index - (Length - 1), Length, Norm).At(In[Index]);
+}
+
+// Kernel runs over the whole array and is left at bar Count - 1, so its next Update goes on from there instead of replaying the history.
+inline void MA_Batch_T3(const float* In, float* Out, int Count, int Length, s_T3Kernel& Kernel)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    Kernel.Reset();
+    for (int Index = 0; Index < Count; Index++)
+        Out[Index] = Kernel.Update(In, Index, Length);
+}
+
+inline void MA_Batch_T3(const float* In, float* Out, int Count, int Length)
+{
+    s_T3Kernel Kernel;
+    MA_Batch_T3(In, Out, Count, Length, Kernel);
+}
+
+inline void MA_Batch_VWMA(const float* In, const float* VolumeIn, float* Out, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    s_VWMAKernel Kernel;
+    for (int Index = 0; Index < Count; Index++)
+        Out[Index] = Kernel.Update(In, VolumeIn, Index, Length);
+}
+
+#endif
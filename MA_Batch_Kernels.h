@@ -0,0 +1,514 @@
+#ifndef MA_BATCH_KERNELS_H
+#define MA_BATCH_KERNELS_H
+
+#include "MA_Kernels.h"
+
+/*
+Batch moving average kernels for full recalculations.
+
+Each kernel computes one average over a whole contiguous float array in a single call and writes the same values as the incremental kernels in MA_Kernels.h (0 for the bars before the average has a full window).
+The running sums and the EMA recurrence are serial, so the AVX2 versions use a blocked prefix scan: four bars are loaded at a time, scanned inside the register, and the last lane is carried into the next block. The WMA (and so the HMA) is written as two chained scans, one for the window sum and one for the weighted sum.
+Accumulation is done in double in both the AVX2 and the scalar versions. The SMA and WMA window sums are compensated (s_MASum in MA_Kernels.h, and the same TwoSum steps inside the AVX2 scans), as in the incremental kernels, so neither drifts over a long history and both divide the same sums the same way.
+MA_Batch_SMA / EMA / ZLEMA / WMA / HMA pick the AVX2 version at run time when the CPU supports AVX2 and FMA. The _Scalar versions are the fallback and can also be called directly.
+*/
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MA_BATCH_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang only emit AVX2 instructions inside functions that enable them. MSVC allows the intrinsics anywhere.
+#if defined(MA_BATCH_X86) && (defined(__GNUC__) || defined(__clang__))
+#define MA_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define MA_TARGET_AVX2
+#endif
+
+inline bool MA_DetectAVX2()
+{
+#if defined(MA_BATCH_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int Info[4];
+    __cpuid(Info, 0);
+    if (Info[0] < 7)
+        return false;
+
+    __cpuid(Info, 1);
+    const bool HasFMA = (Info[2] & (1 << 12)) != 0;
+    const bool HasOSXSAVE = (Info[2] & (1 << 27)) != 0;
+    const bool HasAVX = (Info[2] & (1 << 28)) != 0;
+    if (!HasFMA || !HasOSXSAVE || !HasAVX)
+        return false;
+
+    // The OS has to save the YMM registers on context switches.
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+
+    __cpuidex(Info, 7, 0);
+    return (Info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#else
+    return false;
+#endif
+}
+
+inline bool MA_HasAVX2()
+{
+    static const bool HasAVX2 = MA_DetectAVX2();
+    return HasAVX2;
+}
+
+inline void MA_Batch_Zero(float* Out, int Count)
+{
+    for (int Index = 0; Index < Count; Index++)
+        Out[Index] = 0.0f;
+}
+
+//================================================================================================//
+// Scalar versions
+
+inline void MA_Batch_SMA_Scalar(const float* In, float* Out, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    if (Count < Length)
+    {
+        MA_Batch_Zero(Out, Count);
+        return;
+    }
+
+    MA_Batch_Zero(Out, Length - 1);
+
+    s_MASum Sum;
+    for (int Index = 0; Index < Length; Index++)
+        Sum.Add(In[Index]);
+
+    Out[Length - 1] = static_cast<float>(Sum.Value() / Length);
+
+    for (int Index = Length; Index < Count; Index++)
+    {
+        Sum.Add(-static_cast<double>(In[Index - Length]));
+        Sum.Add(In[Index]);
+        Out[Index] = static_cast<float>(Sum.Value() / Length);
+    }
+}
+
+// EMA of In when Lag is 0, zero lag EMA (EMA of 2 * In[i] - In[i - Lag]) otherwise.
+inline void MA_Batch_EMACore_Scalar(const float* In, float* Out, int Count, int Length, int Lag)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    const double Alpha = 2.0 / (Length + 1);
+    const double Beta = 1.0 - Alpha;
+
+    double Value = In[0];
+    Out[0] = In[0];
+
+    for (int Index = 1; Index < Count; Index++)
+    {
+        double Term = In[Index];
+        if (Lag > 0 && Index >= Lag)
+            Term = 2.0 * In[Index] - In[Index - Lag];
+
+        Value = Alpha * Term + Beta * Value;
+        Out[Index] = static_cast<float>(Value);
+    }
+}
+
+inline void MA_Batch_EMA_Scalar(const float* In, float* Out, int Count, int Length)
+{
+    MA_Batch_EMACore_Scalar(In, Out, Count, Length, 0);
+}
+
+inline void MA_Batch_ZLEMA_Scalar(const float* In, float* Out, int Count, int Length)
+{
+    MA_Batch_EMACore_Scalar(In, Out, Count, Length, (Length - 1) / 2);
+}
+
+inline void MA_Batch_WMA_Scalar(const float* In, float* Out, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    if (Count < Length)
+    {
+        MA_Batch_Zero(Out, Count);
+        return;
+    }
+
+    MA_Batch_Zero(Out, Length - 1);
+
+    const double Norm = 0.5 * Length * (Length + 1);
+
+    s_MASum Sum;
+    s_MASum WeightedSum;
+    for (int Index = 0; Index < Length; Index++)
+    {
+        Sum.Add(In[Index]);
+        WeightedSum.Add(static_cast<double>(Index + 1) * In[Index]);
+    }
+
+    Out[Length - 1] = static_cast<float>(WeightedSum.Value() / Norm);
+
+    for (int Index = Length; Index < Count; Index++)
+    {
+        WeightedSum.Add(static_cast<double>(Length) * In[Index]);
+        WeightedSum.Add(-Sum.Sum);
+        WeightedSum.Add(-Sum.Compensation);
+        Sum.Add(In[Index]);
+        Sum.Add(-static_cast<double>(In[Index - Length]));
+        Out[Index] = static_cast<float>(WeightedSum.Value() / Norm);
+    }
+}
+
+inline void MA_Batch_HMA_Scalar(const float* In, float* Out, float* Diff, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    MA_Batch_WMA_Scalar(In, Diff, Count, MA_HullHalfLength(Length));
+    MA_Batch_WMA_Scalar(In, Out, Count, Length);
+
+    const int FirstDiffIndex = Length - 1 < Count ? Length - 1 : Count;
+    MA_Batch_Zero(Diff, FirstDiffIndex);
+
+    for (int Index = FirstDiffIndex; Index < Count; Index++)
+        Diff[Index] = 2.0f * Diff[Index] - Out[Index];
+
+    MA_Batch_Zero(Out, FirstDiffIndex);
+    MA_Batch_WMA_Scalar(Diff + FirstDiffIndex, Out + FirstDiffIndex, Count - FirstDiffIndex, MA_HullRootLength(Length));
+}
+
+//================================================================================================//
+// AVX2 versions
+
+#if defined(MA_BATCH_X86)
+
+MA_TARGET_AVX2 inline __m256d MA_LoadFloat4(const float* In)
+{
+    return _mm256_cvtps_pd(_mm_loadu_ps(In));
+}
+
+MA_TARGET_AVX2 inline __m256d MA_BroadcastLast(__m256d X)
+{
+    return _mm256_permute4x64_pd(X, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+// Rounding error of Sum = A + B (Knuth's TwoSum), so that Sum + the error is exactly A + B.
+MA_TARGET_AVX2 inline __m256d MA_TwoSumError4(__m256d A, __m256d B, __m256d Sum)
+{
+    const __m256d B_Part = _mm256_sub_pd(Sum, A);
+    return _mm256_add_pd(_mm256_sub_pd(A, _mm256_sub_pd(Sum, B_Part)), _mm256_sub_pd(B, B_Part));
+}
+
+// Inclusive prefix sum of the four lanes of X + Low, with the rounding errors of the scan collected in Low: on return X + Low is the prefix sum.
+MA_TARGET_AVX2 inline __m256d MA_ScanAdd4Compensated(__m256d X, __m256d& Low)
+{
+    const __m256d Zero = _mm256_setzero_pd();
+
+    const __m256d Shift1 = _mm256_blend_pd(_mm256_permute4x64_pd(X, _MM_SHUFFLE(2, 1, 0, 0)), Zero, 0x1);
+    const __m256d Sum1 = _mm256_add_pd(X, Shift1);
+    Low = _mm256_add_pd(_mm256_add_pd(Low, _mm256_blend_pd(_mm256_permute4x64_pd(Low, _MM_SHUFFLE(2, 1, 0, 0)), Zero, 0x1)), MA_TwoSumError4(X, Shift1, Sum1));
+
+    const __m256d Shift2 = _mm256_blend_pd(_mm256_permute4x64_pd(Sum1, _MM_SHUFFLE(1, 0, 0, 0)), Zero, 0x3);
+    const __m256d Sum2 = _mm256_add_pd(Sum1, Shift2);
+    Low = _mm256_add_pd(_mm256_add_pd(Low, _mm256_blend_pd(_mm256_permute4x64_pd(Low, _MM_SHUFFLE(1, 0, 0, 0)), Zero, 0x3)), MA_TwoSumError4(Sum1, Shift2, Sum2));
+
+    return Sum2;
+}
+
+// Adds the carried sum High + Low (all lanes) to the prefix sums X + X_Low.
+MA_TARGET_AVX2 inline __m256d MA_AddCarry4(__m256d X, __m256d& X_Low, __m256d High, __m256d Low)
+{
+    const __m256d Sum = _mm256_add_pd(X, High);
+    X_Low = _mm256_add_pd(_mm256_add_pd(X_Low, Low), MA_TwoSumError4(X, High, Sum));
+    return Sum;
+}
+
+// The last lane of X + X_Low as a normalized carry: High the sum rounded to double, Low what is left of it.
+MA_TARGET_AVX2 inline void MA_NormalizeCarry4(__m256d X, __m256d X_Low, __m256d& High, __m256d& Low)
+{
+    const __m256d Sum = _mm256_add_pd(X, X_Low);
+    High = MA_BroadcastLast(Sum);
+    Low = MA_BroadcastLast(_mm256_sub_pd(X_Low, _mm256_sub_pd(Sum, X)));
+}
+
+MA_TARGET_AVX2 inline void MA_Batch_SMA_AVX2(const float* In, float* Out, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    if (Count < Length)
+    {
+        MA_Batch_Zero(Out, Count);
+        return;
+    }
+
+    MA_Batch_Zero(Out, Length - 1);
+
+    s_MASum Sum;
+    for (int Index = 0; Index < Length; Index++)
+        Sum.Add(In[Index]);
+
+    Out[Length - 1] = static_cast<float>(Sum.Value() / Length);
+
+    const __m256d Divisor = _mm256_set1_pd(static_cast<double>(Length));
+    __m256d Carry_High;
+    __m256d Carry_Low;
+    MA_NormalizeCarry4(_mm256_set1_pd(Sum.Sum), _mm256_set1_pd(Sum.Compensation), Carry_High, Carry_Low);
+
+    int Index = Length;
+    for (; Index + 4 <= Count; Index += 4)
+    {
+        // The difference of two floats in double is rounded too, so its error starts the low part.
+        const __m256d Values = MA_LoadFloat4(In + Index);
+        const __m256d Dropped = _mm256_sub_pd(_mm256_setzero_pd(), MA_LoadFloat4(In + Index - Length));
+        const __m256d Delta = _mm256_add_pd(Values, Dropped);
+        __m256d Low = MA_TwoSumError4(Values, Dropped, Delta);
+
+        __m256d Sums = MA_ScanAdd4Compensated(Delta, Low);
+        Sums = MA_AddCarry4(Sums, Low, Carry_High, Carry_Low);
+
+        _mm_storeu_ps(Out + Index, _mm256_cvtpd_ps(_mm256_div_pd(_mm256_add_pd(Sums, Low), Divisor)));
+        MA_NormalizeCarry4(Sums, Low, Carry_High, Carry_Low);
+    }
+
+    Sum.Clear();
+    Sum.Sum = _mm256_cvtsd_f64(Carry_High);
+    Sum.Compensation = _mm256_cvtsd_f64(Carry_Low);
+    for (; Index < Count; Index++)
+    {
+        Sum.Add(-static_cast<double>(In[Index - Length]));
+        Sum.Add(In[Index]);
+        Out[Index] = static_cast<float>(Sum.Value() / Length);
+    }
+}
+
+// y[i] = Beta * y[i - 1] + Alpha * Term[i], four bars per step:
+// the in-register scan folds the lanes together with Beta and Beta^2, and the carried y[i - 1] enters every lane with Beta^1..Beta^4.
+MA_TARGET_AVX2 inline void MA_Batch_EMACore_AVX2(const float* In, float* Out, int Count, int Length, int Lag)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    const double Alpha = 2.0 / (Length + 1);
+    const double Beta = 1.0 - Alpha;
+
+    // The first bars (before the lag is available) go through the scalar recurrence.
+    int Index = Lag > 1 ? Lag : 1;
+    if (Index > Count)
+        Index = Count;
+
+    MA_Batch_EMACore_Scalar(In, Out, Index, Length, Lag);
+
+    if (Index >= Count)
+        return;
+
+    const __m256d Zero = _mm256_setzero_pd();
+    const __m256d AlphaV = _mm256_set1_pd(Alpha);
+    const __m256d Beta1 = _mm256_set1_pd(Beta);
+    const __m256d Beta2 = _mm256_set1_pd(Beta * Beta);
+    const __m256d BetaPowers = _mm256_set_pd(Beta * Beta * Beta * Beta, Beta * Beta * Beta, Beta * Beta, Beta);
+    const __m256d Two = _mm256_set1_pd(2.0);
+
+    __m256d Carry = _mm256_set1_pd(Out[Index - 1]);
+
+    for (; Index + 4 <= Count; Index += 4)
+    {
+        __m256d Term = MA_LoadFloat4(In + Index);
+        if (Lag > 0)
+            Term = _mm256_fmsub_pd(Two, Term, MA_LoadFloat4(In + Index - Lag));
+
+        __m256d X = _mm256_mul_pd(AlphaV, Term);
+        X = _mm256_fmadd_pd(Beta1, _mm256_blend_pd(_mm256_permute4x64_pd(X, _MM_SHUFFLE(2, 1, 0, 0)), Zero, 0x1), X);
+        X = _mm256_fmadd_pd(Beta2, _mm256_blend_pd(_mm256_permute4x64_pd(X, _MM_SHUFFLE(1, 0, 0, 0)), Zero, 0x3), X);
+
+        const __m256d Values = _mm256_fmadd_pd(BetaPowers, Carry, X);
+
+        _mm_storeu_ps(Out + Index, _mm256_cvtpd_ps(Values));
+        Carry = MA_BroadcastLast(Values);
+    }
+
+    double Value = _mm256_cvtsd_f64(Carry);
+    for (; Index < Count; Index++)
+    {
+        double Term = In[Index];
+        if (Lag > 0)
+            Term = 2.0 * In[Index] - In[Index - Lag];
+
+        Value = Alpha * Term + Beta * Value;
+        Out[Index] = static_cast<float>(Value);
+    }
+}
+
+MA_TARGET_AVX2 inline void MA_Batch_EMA_AVX2(const float* In, float* Out, int Count, int Length)
+{
+    MA_Batch_EMACore_AVX2(In, Out, Count, Length, 0);
+}
+
+MA_TARGET_AVX2 inline void MA_Batch_ZLEMA_AVX2(const float* In, float* Out, int Count, int Length)
+{
+    MA_Batch_EMACore_AVX2(In, Out, Count, Length, (Length - 1) / 2);
+}
+
+// Window sum S[i] = S[i - 1] + In[i] - In[i - Length] and weighted sum W[i] = W[i - 1] + Length * In[i] - S[i - 1], both as blocked compensated scans.
+MA_TARGET_AVX2 inline void MA_Batch_WMA_AVX2(const float* In, float* Out, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    if (Count < Length)
+    {
+        MA_Batch_Zero(Out, Count);
+        return;
+    }
+
+    MA_Batch_Zero(Out, Length - 1);
+
+    const double Norm = 0.5 * Length * (Length + 1);
+
+    s_MASum Sum;
+    s_MASum WeightedSum;
+    for (int Index = 0; Index < Length; Index++)
+    {
+        Sum.Add(In[Index]);
+        WeightedSum.Add(static_cast<double>(Index + 1) * In[Index]);
+    }
+
+    Out[Length - 1] = static_cast<float>(WeightedSum.Value() / Norm);
+
+    const __m256d Divisor = _mm256_set1_pd(Norm);
+    const __m256d LengthV = _mm256_set1_pd(static_cast<double>(Length));
+    __m256d Sum_High, Sum_Low, Weighted_High, Weighted_Low;
+    MA_NormalizeCarry4(_mm256_set1_pd(Sum.Sum), _mm256_set1_pd(Sum.Compensation), Sum_High, Sum_Low);
+    MA_NormalizeCarry4(_mm256_set1_pd(WeightedSum.Sum), _mm256_set1_pd(WeightedSum.Compensation), Weighted_High, Weighted_Low);
+
+    int Index = Length;
+    for (; Index + 4 <= Count; Index += 4)
+    {
+        const __m256d Values = MA_LoadFloat4(In + Index);
+        const __m256d Dropped = _mm256_sub_pd(_mm256_setzero_pd(), MA_LoadFloat4(In + Index - Length));
+        const __m256d Delta = _mm256_add_pd(Values, Dropped);
+        __m256d Sums_Low = MA_TwoSumError4(Values, Dropped, Delta);
+
+        __m256d Sums = MA_ScanAdd4Compensated(Delta, Sums_Low);
+        Sums = MA_AddCarry4(Sums, Sums_Low, Sum_High, Sum_Low);
+
+        // S[i - 1] for each lane: the sums shifted up by one, with the carried sum in lane 0.
+        const __m256d Previous_High = _mm256_blend_pd(_mm256_permute4x64_pd(Sums, _MM_SHUFFLE(2, 1, 0, 0)), Sum_High, 0x1);
+        const __m256d Previous_Low = _mm256_blend_pd(_mm256_permute4x64_pd(Sums_Low, _MM_SHUFFLE(2, 1, 0, 0)), Sum_Low, 0x1);
+
+        // Length * In[i] is exact in double; the subtraction of S[i - 1] is not.
+        const __m256d Weighted_Values = _mm256_mul_pd(LengthV, Values);
+        const __m256d Negative_Previous = _mm256_sub_pd(_mm256_setzero_pd(), Previous_High);
+        const __m256d Terms = _mm256_add_pd(Weighted_Values, Negative_Previous);
+        __m256d Weighted_Sums_Low = _mm256_sub_pd(MA_TwoSumError4(Weighted_Values, Negative_Previous, Terms), Previous_Low);
+
+        __m256d Weighted_Sums = MA_ScanAdd4Compensated(Terms, Weighted_Sums_Low);
+        Weighted_Sums = MA_AddCarry4(Weighted_Sums, Weighted_Sums_Low, Weighted_High, Weighted_Low);
+
+        _mm_storeu_ps(Out + Index, _mm256_cvtpd_ps(_mm256_div_pd(_mm256_add_pd(Weighted_Sums, Weighted_Sums_Low), Divisor)));
+
+        MA_NormalizeCarry4(Sums, Sums_Low, Sum_High, Sum_Low);
+        MA_NormalizeCarry4(Weighted_Sums, Weighted_Sums_Low, Weighted_High, Weighted_Low);
+    }
+
+    Sum.Clear();
+    Sum.Sum = _mm256_cvtsd_f64(Sum_High);
+    Sum.Compensation = _mm256_cvtsd_f64(Sum_Low);
+    WeightedSum.Clear();
+    WeightedSum.Sum = _mm256_cvtsd_f64(Weighted_High);
+    WeightedSum.Compensation = _mm256_cvtsd_f64(Weighted_Low);
+    for (; Index < Count; Index++)
+    {
+        WeightedSum.Add(static_cast<double>(Length) * In[Index]);
+        WeightedSum.Add(-Sum.Sum);
+        WeightedSum.Add(-Sum.Compensation);
+        Sum.Add(In[Index]);
+        Sum.Add(-static_cast<double>(In[Index - Length]));
+        Out[Index] = static_cast<float>(WeightedSum.Value() / Norm);
+    }
+}
+
+#endif
+
+//================================================================================================//
+// Dispatch
+
+inline void MA_Batch_SMA(const float* In, float* Out, int Count, int Length)
+{
+#if defined(MA_BATCH_X86)
+    if (MA_HasAVX2())
+    {
+        MA_Batch_SMA_AVX2(In, Out, Count, Length);
+        return;
+    }
+#endif
+    MA_Batch_SMA_Scalar(In, Out, Count, Length);
+}
+
+inline void MA_Batch_EMA(const float* In, float* Out, int Count, int Length)
+{
+#if defined(MA_BATCH_X86)
+    if (MA_HasAVX2())
+    {
+        MA_Batch_EMA_AVX2(In, Out, Count, Length);
+        return;
+    }
+#endif
+    MA_Batch_EMA_Scalar(In, Out, Count, Length);
+}
+
+inline void MA_Batch_ZLEMA(const float* In, float* Out, int Count, int Length)
+{
+#if defined(MA_BATCH_X86)
+    if (MA_HasAVX2())
+    {
+        MA_Batch_ZLEMA_AVX2(In, Out, Count, Length);
+        return;
+    }
+#endif
+    MA_Batch_ZLEMA_Scalar(In, Out, Count, Length);
+}
+
+inline void MA_Batch_WMA(const float* In, float* Out, int Count, int Length)
+{
+#if defined(MA_BATCH_X86)
+    if (MA_HasAVX2())
+    {
+        MA_Batch_WMA_AVX2(In, Out, Count, Length);
+        return;
+    }
+#endif
+    MA_Batch_WMA_Scalar(In, Out, Count, Length);
+}
+
+// Hull moving average: WMA(2 * WMA(In, Length / 2) - WMA(In, Length), sqrt(Length)).
+// Diff is scratch space for Count values and receives the 2 * WMA(Length / 2) - WMA(Length) series (0 before it is defined).
+inline void MA_Batch_HMA(const float* In, float* Out, float* Diff, int Count, int Length)
+{
+    if (Length < 1 || Count <= 0)
+        return;
+
+    MA_Batch_WMA(In, Diff, Count, MA_HullHalfLength(Length));
+    MA_Batch_WMA(In, Out, Count, Length);
+
+    const int FirstDiffIndex = Length - 1 < Count ? Length - 1 : Count;
+    MA_Batch_Zero(Diff, FirstDiffIndex);
+
+    for (int Index = FirstDiffIndex; Index < Count; Index++)
+        Diff[Index] = 2.0f * Diff[Index] - Out[Index];
+
+    MA_Batch_Zero(Out, FirstDiffIndex);
+    MA_Batch_WMA(Diff + FirstDiffIndex, Out + FirstDiffIndex, Count - FirstDiffIndex, MA_HullRootLength(Length));
+}
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef MA_CACHE_H
+#define MA_CACHE_H
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+Shared cache of full-history moving averages.
+
+When several instances of the same crossover study run on one chart (parameter variants), every one of them recalculates the same averages from bar 0 on a chart load or reload. The cache keeps one copy of each average per (symbol, chart number, input data index, moving average type, period).
+The first instance that recalculates computes the average and stores it; the others copy it into their subgraph instead of computing it again.
+An entry is only reused when its series stamp (bar count, first and last bar date-times, and a hash of every input value) matches the current data, so an entry computed before a reload, backfill or data correction is recomputed instead of copied, wherever in the history the bars changed.
+Incremental updates after the recalculation are not shared: the kernels are O(1) per bar, so every instance keeps its own.
+Entries are reference counted by the instances that use them and freed with the last one. The cache is static, so it is shared by the instances of the studies in one DLL.
+*/
+
+struct s_MACacheKey
+{
+    std::string Symbol;
+    int ChartNumber;
+    int InputIndex;
+    std::string Type;
+    int Period;
+
+    s_MACacheKey()
+        : ChartNumber(0)
+        , InputIndex(0)
+        , Period(0)
+    {
+    }
+
+    bool operator==(const s_MACacheKey& Other) const
+    {
+        return ChartNumber == Other.ChartNumber
+            && InputIndex == Other.InputIndex
+            && Period == Other.Period
+            && Symbol == Other.Symbol
+            && Type == Other.Type;
+    }
+
+    bool operator<(const s_MACacheKey& Other) const
+    {
+        if (ChartNumber != Other.ChartNumber)
+            return ChartNumber < Other.ChartNumber;
+        if (InputIndex != Other.InputIndex)
+            return InputIndex < Other.InputIndex;
+        if (Period != Other.Period)
+            return Period < Other.Period;
+        if (Symbol != Other.Symbol)
+            return Symbol < Other.Symbol;
+        return Type < Other.Type;
+    }
+};
+
+// Identifies the data an average was computed from.
+struct s_MASeriesStamp
+{
+    int Count;
+    double FirstDateTime;
+    double LastDateTime;
+    unsigned long long InputHash;
+
+    s_MASeriesStamp()
+        : Count(0)
+        , FirstDateTime(0.0)
+        , LastDateTime(0.0)
+        , InputHash(0)
+    {
+    }
+
+    bool operator==(const s_MASeriesStamp& Other) const
+    {
+        return Count == Other.Count
+            && FirstDateTime == Other.FirstDateTime
+            && LastDateTime == Other.LastDateTime
+            && InputHash == Other.InputHash;
+    }
+};
+
+struct s_MACacheEntry
+{
+    int RefCount;
+    s_MASeriesStamp Stamp;
+    std::vector<float> Values;
+
+    s_MACacheEntry()
+        : RefCount(0)
+    {
+    }
+};
+
+class c_MACache
+{
+public:
+    ~c_MACache()
+    {
+        for (EntryMap::iterator Iterator = m_Entries.begin(); Iterator != m_Entries.end(); ++Iterator)
+            delete Iterator->second;
+    }
+
+    s_MACacheEntry* Acquire(const s_MACacheKey& Key)
+    {
+        std::lock_guard<std::mutex> Guard(m_Lock);
+
+        s_MACacheEntry*& Entry = m_Entries[Key];
+        if (Entry == NULL)
+            Entry = new s_MACacheEntry;
+
+        Entry->RefCount++;
+        return Entry;
+    }
+
+    void Release(const s_MACacheKey& Key, s_MACacheEntry* Entry)
+    {
+        std::lock_guard<std::mutex> Guard(m_Lock);
+
+        if (--Entry->RefCount > 0)
+            return;
+
+        m_Entries.erase(Key);
+        delete Entry;
+    }
+
+    // Copies the cached values into Out when they were computed from the data described by Stamp.
+    bool Load(s_MACacheEntry* Entry, const s_MASeriesStamp& Stamp, float* Out)
+    {
+        std::lock_guard<std::mutex> Guard(m_Lock);
+
+        if (Stamp.Count <= 0 || !(Entry->Stamp == Stamp))
+            return false;
+
+        std::memcpy(Out, &Entry->Values[0], Stamp.Count * sizeof(float));
+        return true;
+    }
+
+    void Store(s_MACacheEntry* Entry, const s_MASeriesStamp& Stamp, const float* Values)
+    {
+        std::lock_guard<std::mutex> Guard(m_Lock);
+
+        if (Stamp.Count <= 0)
+            return;
+
+        Entry->Values.assign(Values, Values + Stamp.Count);
+        Entry->Stamp = Stamp;
+    }
+
+private:
+    typedef std::map<s_MACacheKey, s_MACacheEntry*> EntryMap;
+
+    std::mutex m_Lock;
+    EntryMap m_Entries;
+};
+
+inline c_MACache& MA_SharedCache()
+{
+    static c_MACache Cache;
+    return Cache;
+}
+
+// One study instance's reference to a cache entry. Rebinding to a new key releases the old entry.
+struct s_MACacheHandle
+{
+    s_MACacheKey Key;
+    s_MACacheEntry* Entry;
+
+    s_MACacheHandle()
+        : Entry(NULL)
+    {
+    }
+
+    ~s_MACacheHandle()
+    {
+        Release();
+    }
+
+    void Bind(const s_MACacheKey& NewKey)
+    {
+        if (Entry != NULL && Key == NewKey)
+            return;
+
+        Release();
+        Key = NewKey;
+        Entry = MA_SharedCache().Acquire(Key);
+    }
+
+    void Release()
+    {
+        if (Entry == NULL)
+            return;
+
+        MA_SharedCache().Release(Key, Entry);
+        Entry = NULL;
+    }
+
+    bool Load(const s_MASeriesStamp& Stamp, float* Out)
+    {
+        return Entry != NULL && MA_SharedCache().Load(Entry, Stamp, Out);
+    }
+
+    void Store(const s_MASeriesStamp& Stamp, const float* Values)
+    {
+        if (Entry != NULL)
+            MA_SharedCache().Store(Entry, Stamp, Values);
+    }
+
+private:
+    s_MACacheHandle(const s_MACacheHandle&);
+    s_MACacheHandle& operator=(const s_MACacheHandle&);
+};
+
+#endif
@@ -0,0 +1,371 @@
+#ifndef MA_FIXED_KERNELS_H
+#define MA_FIXED_KERNELS_H
+
+#include "MA_Kernels.h"
+
+/*
+Incremental kernels with the period as a template argument, for the fixed-period study variants (EMA 9/21, Hull 16/64, ...).
+
+They follow the kernels of MA_Kernels.h call for call (same index rules, same s_LiveLine and s_HMALive for the live bar, same resync, the same s_MASum accumulators) and differ only in what the compiler knows:
+The ring buffers are members of compile-time size (s_FixedRing), so there is no scratch storage to attach and the wrap of the head is against a constant.
+The WMA norms and slopes and the EMA alpha are constants, which the compiler folds into the arithmetic.
+The length checks and resizes of every Update are gone, and a Hull period's half and root lengths are fixed with it.
+The values are those of the MA_Kernels.h kernels.
+*/
+
+// MA_HullHalfLength and MA_HullRootLength as constant expressions, for the template arguments.
+constexpr int MA_FixedHalfLength(int Length)
+{
+    return Length / 2 > 1 ? Length / 2 : 1;
+}
+
+constexpr int MA_FixedRootLength(int Length, int Root = 1)
+{
+    return (Root + 1) * (Root + 1) <= Length ? MA_FixedRootLength(Length, Root + 1) : Root;
+}
+
+//================================================================================================//
+// s_ValueRing with Capacity fixed at compile time and its storage inside the object.
+
+template <int Capacity>
+struct s_FixedRing
+{
+    float Values[Capacity > 0 ? Capacity : 1];
+    int Count;
+    int Head;
+
+    s_FixedRing()
+        : Count(0)
+        , Head(0)
+    {
+    }
+
+    void Clear()
+    {
+        Count = 0;
+        Head = 0;
+    }
+
+    bool IsFull() const
+    {
+        return Count == Capacity;
+    }
+
+    float Oldest() const
+    {
+        return Values[Head];
+    }
+
+    float At(int Offset) const
+    {
+        const int Slot = Head + Offset;
+        return Values[Slot < Capacity ? Slot : Slot - Capacity];
+    }
+
+    void Push(float Value)
+    {
+        if (Capacity == 0)
+            return;
+
+        if (Count < Capacity)
+        {
+            int Slot = Head + Count;
+            if (Slot >= Capacity)
+                Slot -= Capacity;
+
+            Values[Slot] = Value;
+            Count++;
+            return;
+        }
+
+        Values[Head] = Value;
+
+        if (++Head == Capacity)
+            Head = 0;
+    }
+};
+
+//================================================================================================//
+// s_WMAWindow for a fixed Length.
+
+template <int Length>
+struct s_WMAFixedWindow
+{
+    s_MASum Sum;
+    s_MASum WeightedSum;
+    s_FixedRing<Length - 1> Window;
+
+    static double Norm()
+    {
+        return 0.5 * Length * (Length + 1);
+    }
+
+    void Clear()
+    {
+        Sum.Clear();
+        WeightedSum.Clear();
+        Window.Clear();
+    }
+
+    bool IsReady() const
+    {
+        return Window.IsFull();
+    }
+
+    float Live(float Value) const
+    {
+        return static_cast<float>((static_cast<double>(Length) * Value + WeightedSum.Value()) / Norm());
+    }
+
+    double LiveBase() const
+    {
+        return WeightedSum.Value() / Norm();
+    }
+
+    static double LiveSlope()
+    {
+        return Length / Norm();
+    }
+
+    void Push(float Value)
+    {
+        if (Length == 1)
+            return;
+
+        if (Window.IsFull())
+        {
+            WeightedSum.Add(static_cast<double>(Length - 1) * Value);
+            WeightedSum.Add(-Sum.Sum);
+            WeightedSum.Add(-Sum.Compensation);
+            Sum.Add(Value);
+            Sum.Add(-static_cast<double>(Window.Oldest()));
+        }
+        else
+        {
+            WeightedSum.Add(static_cast<double>(Window.Count + 1) * Value);
+            Sum.Add(Value);
+        }
+
+        Window.Push(Value);
+
+        if (Sum.Drifted() || WeightedSum.Drifted())
+            Resum();
+    }
+
+    void Resum()
+    {
+        Sum.Clear();
+        WeightedSum.Clear();
+
+        for (int Offset = 0; Offset < Window.Count; Offset++)
+        {
+            const float Value = Window.At(Offset);
+            Sum.Add(Value);
+            WeightedSum.Add(static_cast<double>(Offset + 1) * Value);
+        }
+    }
+};
+
+//================================================================================================//
+// s_EMAKernel for a fixed Length, with ZeroLag as a template argument (s_ZLEMAFixedKernel).
+
+template <int Length, bool ZeroLag = false>
+struct s_EMAFixedKernel
+{
+    static const int Lag = ZeroLag ? (Length - 1) / 2 : 0;
+
+    int CurrentIndex;
+    double Committed;
+    s_LiveLine Live;
+
+    static double Alpha()
+    {
+        return 2.0 / (Length + 1);
+    }
+
+    s_EMAFixedKernel()
+        : CurrentIndex(-1)
+        , Committed(0.0)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Committed = 0.0;
+    }
+
+    float Update(const float* In, const float* Out, int Index)
+    {
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Committed = Live.Value(In[CurrentIndex]);
+            else
+                Resync(In, Out, Index);
+
+            SetLiveLine(In, Index);
+        }
+
+        CurrentIndex = Index;
+
+        return Live.At(In[Index]);
+    }
+
+private:
+    void SetLiveLine(const float* In, int Index)
+    {
+        if (Index == 0)
+            Live.Set(0.0, 1.0);
+        else if (Lag > 0 && Index >= Lag)
+            Live.Set((1.0 - Alpha()) * Committed - Alpha() * In[Index - Lag], 2.0 * Alpha());
+        else
+            Live.Set((1.0 - Alpha()) * Committed, Alpha());
+    }
+
+    double Step(const float* In, int Index) const
+    {
+        if (Index == 0)
+            return In[0];
+
+        const double Term = Lag > 0 && Index >= Lag ? 2.0 * In[Index] - In[Index - Lag] : In[Index];
+        return Alpha() * Term + (1.0 - Alpha()) * Committed;
+    }
+
+    void Resync(const float* In, const float* Out, int Index)
+    {
+        Reset();
+
+        if (Index <= 0)
+            return;
+
+        if (Out != NULL)
+        {
+            Committed = Out[Index - 1];
+            return;
+        }
+
+        Committed = In[0];
+        for (int BarIndex = 1; BarIndex < Index; BarIndex++)
+            Committed = Step(In, BarIndex);
+    }
+};
+
+template <int Length>
+struct s_ZLEMAFixedKernel : public s_EMAFixedKernel<Length, true>
+{
+};
+
+//================================================================================================//
+// s_HMAState for a fixed Length.
+
+template <int Length>
+struct s_HMAFixedState
+{
+    static const int HalfLength = MA_FixedHalfLength(Length);
+    static const int RootLength = MA_FixedRootLength(Length);
+    static const int WarmupBars = (Length - 1) + (RootLength - 1);
+
+    s_WMAFixedWindow<HalfLength> Half;
+    s_WMAFixedWindow<Length> Full;
+    s_WMAFixedWindow<RootLength> Root;
+
+    void Clear()
+    {
+        Half.Clear();
+        Full.Clear();
+        Root.Clear();
+    }
+
+    s_HMALive LiveLines() const
+    {
+        s_HMALive Lines;
+        Lines.Ready = Full.IsReady() && Root.IsReady();
+        Lines.Half.Set(Half.LiveBase(), Half.LiveSlope());
+        Lines.Full.Set(Full.LiveBase(), Full.LiveSlope());
+        Lines.Root.Set(Root.LiveBase(), Root.LiveSlope());
+        return Lines;
+    }
+
+    void Commit(float Value)
+    {
+        if (Full.IsReady())
+            Root.Push(2.0f * Half.Live(Value) - Full.Live(Value));
+
+        Half.Push(Value);
+        Full.Push(Value);
+    }
+};
+
+//================================================================================================//
+// s_HMAPairKernel for fixed fast and slow lengths.
+
+template <int FastLength, int SlowLength>
+struct s_HMAPairFixedKernel
+{
+    static const int WarmupBars = s_HMAFixedState<FastLength>::WarmupBars > s_HMAFixedState<SlowLength>::WarmupBars
+        ? s_HMAFixedState<FastLength>::WarmupBars
+        : s_HMAFixedState<SlowLength>::WarmupBars;
+
+    int CurrentIndex;
+    s_HMAFixedState<FastLength> Fast;
+    s_HMAFixedState<SlowLength> Slow;
+    s_HMALive FastLive;
+    s_HMALive SlowLive;
+
+    s_HMAPairFixedKernel()
+        : CurrentIndex(-1)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Fast.Clear();
+        Slow.Clear();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, int Index, float& FastOut, float& SlowOut)
+    {
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Commit(FastIn, SlowIn, CurrentIndex);
+            else
+                Resync(FastIn, SlowIn, Index);
+
+            FastLive = Fast.LiveLines();
+            SlowLive = Slow.LiveLines();
+        }
+
+        CurrentIndex = Index;
+
+        const float FastValue = FastIn[Index];
+        const float SlowValue = SlowIn == FastIn ? FastValue : SlowIn[Index];
+
+        FastOut = FastLive.At(FastValue);
+        SlowOut = SlowLive.At(SlowValue);
+    }
+
+private:
+    void Commit(const float* FastIn, const float* SlowIn, int Index)
+    {
+        const float FastValue = FastIn[Index];
+        Fast.Commit(FastValue);
+        Slow.Commit(SlowIn == FastIn ? FastValue : SlowIn[Index]);
+    }
+
+    void Resync(const float* FastIn, const float* SlowIn, int Index)
+    {
+        Reset();
+
+        int FirstIndex = Index - WarmupBars;
+        if (FirstIndex < 0)
+            FirstIndex = 0;
+
+        for (int BarIndex = FirstIndex; BarIndex < Index; BarIndex++)
+            Commit(FastIn, SlowIn, BarIndex);
+    }
+};
+
+#endif
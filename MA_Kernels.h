@@ -0,0 +1,853 @@
+#ifndef MA_KERNELS_H
+#define MA_KERNELS_H
+
+#include <cmath>
+#include <cstddef>
+
+/*
+Incremental moving average kernels used by the crossover engine.
+
+A kernel keeps the state needed to produce the average for the next bar without rescanning the window. Kernels are called with increasing bar indexes:
+The same index as the previous call is an intrabar update of the last bar. Only the live value is re-read, the committed state is unchanged.
+The average of the live bar is linear in its value, so a kernel keeps it as Base + Slope * Value (s_LiveLine), rebuilt once per bar. An intrabar update is one multiply-add, three for the Hull average (s_HMALive).
+The next index commits the now closed previous bar into the state.
+Any other index (first call, or an update that starts further back) resyncs the state from the input array.
+Kernels that depend on their own previous output (EMA, ZLEMA) resync from the output array when it is passed in, so the state can be picked up after the batch kernels in MA_Batch_Kernels.h have filled the history.
+The kernels do not depend on sierrachart.h. They work on plain float arrays so they can be used with any contiguous input.
+The window sums of the SMA and WMA (and so the HMA) are s_MASum accumulators: double with a compensation term, so they do not drift however long a session runs and do not need a periodic resum. Each commit checks the accumulators' error bound, an O(1) test that resums the window from the ring only if the bound ever grows past MA_SUM_DRIFT_RATIO of the sum.
+A kernel with a window allocates it on the first Update with a new length. Attach(Scratch, Length) instead gives it ScratchFloats(Length) floats of storage owned by the caller (a c_StudyArena in Study_Arena.h), so that Update never allocates for that length.
+*/
+
+//================================================================================================//
+// Ring buffer of the last Capacity closed values, oldest first.
+// The storage is either its own (Resize) or the caller's (Attach). Allocated is the size of its own storage, 0 when attached.
+
+struct s_ValueRing
+{
+    float* Values;
+    int Capacity;
+    int Allocated;
+    int Count;
+    int Head;
+
+    s_ValueRing()
+        : Values(NULL)
+        , Capacity(0)
+        , Allocated(0)
+        , Count(0)
+        , Head(0)
+    {
+    }
+
+    ~s_ValueRing()
+    {
+        Release();
+    }
+
+    void Resize(int NewCapacity)
+    {
+        if (Allocated < NewCapacity)
+        {
+            Release();
+            Values = new float[NewCapacity];
+            Allocated = NewCapacity;
+        }
+
+        Capacity = NewCapacity;
+        Clear();
+    }
+
+    // Uses NewCapacity floats at Storage, which must outlive the ring or the next Attach / Resize. Without Storage it falls back to Resize.
+    void Attach(float* Storage, int NewCapacity)
+    {
+        if (Storage == NULL && NewCapacity > 0)
+        {
+            Resize(NewCapacity);
+            return;
+        }
+
+        Release();
+        Values = Storage;
+        Capacity = NewCapacity;
+        Clear();
+    }
+
+    void Clear()
+    {
+        Count = 0;
+        Head = 0;
+    }
+
+    bool IsFull() const
+    {
+        return Count == Capacity;
+    }
+
+    float Oldest() const
+    {
+        return Values[Head];
+    }
+
+    // The Offset-th value from the oldest one.
+    float At(int Offset) const
+    {
+        const int Slot = Head + Offset;
+        return Values[Slot < Capacity ? Slot : Slot - Capacity];
+    }
+
+    // Appends Value, dropping the oldest value when the ring is full.
+    void Push(float Value)
+    {
+        if (Capacity == 0)
+            return;
+
+        if (Count < Capacity)
+        {
+            int Slot = Head + Count;
+            if (Slot >= Capacity)
+                Slot -= Capacity;
+
+            Values[Slot] = Value;
+            Count++;
+            return;
+        }
+
+        Values[Head] = Value;
+
+        if (++Head == Capacity)
+            Head = 0;
+    }
+
+private:
+    s_ValueRing(const s_ValueRing&);
+    s_ValueRing& operator=(const s_ValueRing&);
+
+    void Release()
+    {
+        if (Allocated > 0)
+            delete[] Values;
+
+        Values = NULL;
+        Allocated = 0;
+    }
+};
+
+//================================================================================================//
+// The average of the live (last, still open) bar as a linear function of its value.
+
+struct s_LiveLine
+{
+    double Base;
+    double Slope;
+
+    s_LiveLine()
+        : Base(0.0)
+        , Slope(0.0)
+    {
+    }
+
+    void Set(double NewBase, double NewSlope)
+    {
+        Base = NewBase;
+        Slope = NewSlope;
+    }
+
+    double Value(float Live) const
+    {
+        return Base + Slope * Live;
+    }
+
+    float At(float Live) const
+    {
+        return static_cast<float>(Value(Live));
+    }
+};
+
+//================================================================================================//
+// Running sum with a compensation term (Knuth's TwoSum on every add): Sum + Compensation is the sum of everything added,
+// with only the rounding of Compensation itself left over, about 1e-16 of a float's precision per add.
+// ErrorBound adds up that leftover rounding, so a long-running sum can check its own drift in O(1) (Drifted) instead of being resummed.
+// The batch kernels in MA_Batch_Kernels.h accumulate the same way, so a recalculation and the incremental kernels see the same sums.
+
+const double MA_SUM_EPSILON = 1.1102230246251565e-16;
+const double MA_SUM_DRIFT_RATIO = 1.0 / (1LL << 40);
+
+struct s_MASum
+{
+    double Sum;
+    double Compensation;
+    double ErrorBound;
+
+    s_MASum()
+        : Sum(0.0)
+        , Compensation(0.0)
+        , ErrorBound(0.0)
+    {
+    }
+
+    void Clear()
+    {
+        Sum = 0.0;
+        Compensation = 0.0;
+        ErrorBound = 0.0;
+    }
+
+    void Add(double Value)
+    {
+        const double Total = Sum + Value;
+        const double Value_Part = Total - Sum;
+        Compensation += (Sum - (Total - Value_Part)) + (Value - Value_Part);
+        Sum = Total;
+        ErrorBound += MA_SUM_EPSILON * std::fabs(Compensation);
+    }
+
+    double Value() const
+    {
+        return Sum + Compensation;
+    }
+
+    // True when the leftover rounding could reach MA_SUM_DRIFT_RATIO of the sum, far below what shows in a float average.
+    bool Drifted() const
+    {
+        return ErrorBound > MA_SUM_DRIFT_RATIO * std::fabs(Sum);
+    }
+};
+
+//================================================================================================//
+// Simple moving average over a running sum and a ring buffer of the last Length - 1 closed values.
+// Each new bar costs O(1) regardless of the period.
+
+struct s_SMAKernel
+{
+    int Length;
+    int CurrentIndex;
+    s_MASum Sum;
+    s_ValueRing Window;
+    s_LiveLine Live;
+
+    s_SMAKernel()
+        : Length(0)
+        , CurrentIndex(-1)
+    {
+    }
+
+    // Forget all history. The next Update resyncs from the input array.
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Sum.Clear();
+        Window.Clear();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return Length > 1 ? Length - 1 : 0;
+    }
+
+    void Attach(float* Scratch, int NewLength)
+    {
+        Length = NewLength;
+        Window.Attach(Scratch, ScratchFloats(Length));
+        Reset();
+    }
+
+    float Update(const float* In, int Index, int NewLength)
+    {
+        if (NewLength < 1)
+            return 0.0f;
+
+        if (NewLength != Length)
+        {
+            Length = NewLength;
+            Window.Resize(Length - 1);
+            Reset();
+        }
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Commit(In[CurrentIndex]);
+            else
+                Resync(In, Index);
+
+            if (Window.IsFull())
+                Live.Set(Sum.Value() / Length, 1.0 / Length);
+            else
+                Live.Set(0.0, 0.0);
+        }
+
+        CurrentIndex = Index;
+
+        return Live.At(In[Index]);
+    }
+
+private:
+    void Commit(float Value)
+    {
+        if (Window.Capacity == 0)
+            return;
+
+        if (Window.IsFull())
+            Sum.Add(-static_cast<double>(Window.Oldest()));
+
+        Sum.Add(Value);
+        Window.Push(Value);
+
+        if (Sum.Drifted())
+            Resum();
+    }
+
+    void Resum()
+    {
+        Sum.Clear();
+        for (int Offset = 0; Offset < Window.Count; Offset++)
+            Sum.Add(Window.At(Offset));
+    }
+
+    void Resync(const float* In, int Index)
+    {
+        Reset();
+
+        int FirstIndex = Index - (Length - 1);
+        if (FirstIndex < 0)
+            FirstIndex = 0;
+
+        for (int BarIndex = FirstIndex; BarIndex < Index; BarIndex++)
+            Commit(In[BarIndex]);
+    }
+};
+
+//================================================================================================//
+// Linear weighted average window with O(1) updates.
+// Holds the last Length - 1 closed values c[1..Length - 1] (oldest first) with Sum = sum of c[k] and WeightedSum = sum of k * c[k].
+// The live value gets weight Length, so the average is (Length * Live + WeightedSum) / (Length * (Length + 1) / 2).
+// Pushing a closed value shifts every weight down by one: WeightedSum += (Length - 1) * Value - Sum.
+// WeightedSum takes in Sum on every push, so both are s_MASum accumulators; a plain running sum's rounding error would build up in WeightedSum over a long series.
+
+struct s_WMAWindow
+{
+    int Length;
+    s_MASum Sum;
+    s_MASum WeightedSum;
+    double Norm;
+    s_ValueRing Window;
+
+    s_WMAWindow()
+        : Length(0)
+        , Norm(1.0)
+    {
+    }
+
+    void Resize(int NewLength)
+    {
+        Length = NewLength;
+        Norm = 0.5 * Length * (Length + 1);
+        Window.Resize(Length - 1);
+        Clear();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return Length > 1 ? Length - 1 : 0;
+    }
+
+    void Attach(float* Scratch, int NewLength)
+    {
+        Length = NewLength;
+        Norm = 0.5 * Length * (Length + 1);
+        Window.Attach(Scratch, ScratchFloats(Length));
+        Clear();
+    }
+
+    void Clear()
+    {
+        Sum.Clear();
+        WeightedSum.Clear();
+        Window.Clear();
+    }
+
+    bool IsReady() const
+    {
+        return Window.IsFull();
+    }
+
+    float Live(float Value) const
+    {
+        return static_cast<float>((static_cast<double>(Length) * Value + WeightedSum.Value()) / Norm);
+    }
+
+    // Live(Value) = LiveBase() + LiveSlope() * Value, without the rounding to float.
+    double LiveBase() const
+    {
+        return WeightedSum.Value() / Norm;
+    }
+
+    double LiveSlope() const
+    {
+        return Length / Norm;
+    }
+
+    void Push(float Value)
+    {
+        if (Window.Capacity == 0)
+            return;
+
+        if (Window.IsFull())
+        {
+            WeightedSum.Add(static_cast<double>(Length - 1) * Value);
+            WeightedSum.Add(-Sum.Sum);
+            WeightedSum.Add(-Sum.Compensation);
+            Sum.Add(Value);
+            Sum.Add(-static_cast<double>(Window.Oldest()));
+        }
+        else
+        {
+            WeightedSum.Add(static_cast<double>(Window.Count + 1) * Value);
+            Sum.Add(Value);
+        }
+
+        Window.Push(Value);
+
+        if (Sum.Drifted() || WeightedSum.Drifted())
+            Resum();
+    }
+
+    // Sum and WeightedSum again from the values in the window, weights 1 to Count from the oldest.
+    void Resum()
+    {
+        Sum.Clear();
+        WeightedSum.Clear();
+
+        for (int Offset = 0; Offset < Window.Count; Offset++)
+        {
+            const float Value = Window.At(Offset);
+            Sum.Add(Value);
+            WeightedSum.Add(static_cast<double>(Offset + 1) * Value);
+        }
+    }
+};
+
+//================================================================================================//
+// Exponential moving average, Out[0] = In[0], Out[i] = Alpha * In[i] + (1 - Alpha) * Out[i - 1], Alpha = 2 / (Length + 1).
+// With ZeroLag set the recurrence runs over 2 * In[i] - In[i - Lag], Lag = (Length - 1) / 2 (zero lag EMA).
+
+struct s_EMAKernel
+{
+    bool ZeroLag;
+    int Length;
+    int Lag;
+    double Alpha;
+    int CurrentIndex;
+    double Committed;
+    s_LiveLine Live;
+
+    explicit s_EMAKernel(bool InZeroLag = false)
+        : ZeroLag(InZeroLag)
+        , Length(0)
+        , Lag(0)
+        , Alpha(1.0)
+        , CurrentIndex(-1)
+        , Committed(0.0)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Committed = 0.0;
+    }
+
+    // The recurrence has no window. The ZLEMA term reads its lagged value from the input array.
+    static int ScratchFloats(int)
+    {
+        return 0;
+    }
+
+    void Attach(float*, int)
+    {
+        Reset();
+    }
+
+    // Out is this average's output history. It may be NULL, in which case a resync replays the recurrence from bar 0.
+    float Update(const float* In, const float* Out, int Index, int NewLength)
+    {
+        if (NewLength < 1)
+            return 0.0f;
+
+        if (NewLength != Length)
+        {
+            Length = NewLength;
+            Lag = ZeroLag ? (Length - 1) / 2 : 0;
+            Alpha = 2.0 / (Length + 1);
+            Reset();
+        }
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Committed = Live.Value(In[CurrentIndex]);
+            else
+                Resync(In, Out, Index);
+
+            SetLiveLine(In, Index);
+        }
+
+        CurrentIndex = Index;
+
+        return Live.At(In[Index]);
+    }
+
+private:
+    // Step(In, Index) as a function of In[Index]. The lagged input of the ZLEMA term is a closed bar, so it is part of the base.
+    void SetLiveLine(const float* In, int Index)
+    {
+        if (Index == 0)
+            Live.Set(0.0, 1.0);
+        else if (Lag > 0 && Index >= Lag)
+            Live.Set((1.0 - Alpha) * Committed - Alpha * In[Index - Lag], 2.0 * Alpha);
+        else
+            Live.Set((1.0 - Alpha) * Committed, Alpha);
+    }
+
+    double Term(const float* In, int Index) const
+    {
+        if (Lag > 0 && Index >= Lag)
+            return 2.0 * In[Index] - In[Index - Lag];
+
+        return In[Index];
+    }
+
+    // Value at Index, with Committed holding the value at Index - 1.
+    double Step(const float* In, int Index) const
+    {
+        if (Index == 0)
+            return In[0];
+
+        return Alpha * Term(In, Index) + (1.0 - Alpha) * Committed;
+    }
+
+    void Resync(const float* In, const float* Out, int Index)
+    {
+        Reset();
+
+        if (Index <= 0)
+            return;
+
+        if (Out != NULL)
+        {
+            Committed = Out[Index - 1];
+            return;
+        }
+
+        Committed = In[0];
+        for (int BarIndex = 1; BarIndex < Index; BarIndex++)
+            Committed = Step(In, BarIndex);
+    }
+};
+
+struct s_ZLEMAKernel : public s_EMAKernel
+{
+    s_ZLEMAKernel()
+        : s_EMAKernel(true)
+    {
+    }
+};
+
+//================================================================================================//
+// Linear weighted average of the Length values ending at Index, newest value weighted Length.
+
+inline double MA_WMAAt(const float* In, int Index, int Length)
+{
+    double WeightedSum = 0.0;
+    for (int Offset = 0; Offset < Length; Offset++)
+        WeightedSum += static_cast<double>(Length - Offset) * In[Index - Offset];
+
+    return WeightedSum / (0.5 * Length * (Length + 1));
+}
+
+inline int MA_HullHalfLength(int Length)
+{
+    return Length / 2 > 1 ? Length / 2 : 1;
+}
+
+inline int MA_HullRootLength(int Length)
+{
+    const int Root = static_cast<int>(std::sqrt(static_cast<double>(Length)));
+    return Root > 1 ? Root : 1;
+}
+
+//================================================================================================//
+// The Hull average of the live bar as the lines of its three WMAs, rounded to float between them as the batch kernel does:
+// the difference series is a float array there, so one line straight through would differ from a recalculation in the last bits.
+// Three multiply-adds per update instead of one, and the values written on ticks are those a recalculation writes.
+
+struct s_HMALive
+{
+    bool Ready;
+    s_LiveLine Half;
+    s_LiveLine Full;
+    s_LiveLine Root;
+
+    s_HMALive()
+        : Ready(false)
+    {
+    }
+
+    float At(float Live) const
+    {
+        if (!Ready)
+            return 0.0f;
+
+        return Root.At(2.0f * Half.At(Live) - Full.At(Live));
+    }
+};
+
+//================================================================================================//
+// Hull moving average, WMA(2 * WMA(In, Length / 2) - WMA(In, Length), sqrt(Length)).
+// The three WMAs are O(1) windows: two over the input, one over the closed values of the 2 * WMA(Length / 2) - WMA(Length) series.
+
+struct s_HMAState
+{
+    int Length;
+    s_WMAWindow Half;
+    s_WMAWindow Full;
+    s_WMAWindow Root;
+
+    s_HMAState()
+        : Length(0)
+    {
+    }
+
+    void Resize(int NewLength)
+    {
+        Length = NewLength;
+        Half.Resize(MA_HullHalfLength(Length));
+        Full.Resize(Length);
+        Root.Resize(MA_HullRootLength(Length));
+    }
+
+    // The three WMA windows, one after the other.
+    static int ScratchFloats(int Length)
+    {
+        return s_WMAWindow::ScratchFloats(MA_HullHalfLength(Length)) + s_WMAWindow::ScratchFloats(Length) + s_WMAWindow::ScratchFloats(MA_HullRootLength(Length));
+    }
+
+    void Attach(float* Scratch, int NewLength)
+    {
+        Length = NewLength;
+
+        const int HalfLength = MA_HullHalfLength(Length);
+        const int RootLength = MA_HullRootLength(Length);
+        float* Full_Scratch = Scratch != NULL ? Scratch + s_WMAWindow::ScratchFloats(HalfLength) : NULL;
+        float* Root_Scratch = Full_Scratch != NULL ? Full_Scratch + s_WMAWindow::ScratchFloats(Length) : NULL;
+
+        Half.Attach(Scratch, HalfLength);
+        Full.Attach(Full_Scratch, Length);
+        Root.Attach(Root_Scratch, RootLength);
+    }
+
+    void Clear()
+    {
+        Half.Clear();
+        Full.Clear();
+        Root.Clear();
+    }
+
+    // Number of closed bars needed before the average has a value.
+    int WarmupBars() const
+    {
+        return (Length - 1) + (Root.Length - 1);
+    }
+
+    float Live(float Value) const
+    {
+        if (!Full.IsReady() || !Root.IsReady())
+            return 0.0f;
+
+        return Root.Live(2.0f * Half.Live(Value) - Full.Live(Value));
+    }
+
+    // Live as one line per WMA (s_HMALive).
+    s_HMALive LiveLines() const
+    {
+        s_HMALive Lines;
+        Lines.Ready = Full.IsReady() && Root.IsReady();
+        Lines.Half.Set(Half.LiveBase(), Half.LiveSlope());
+        Lines.Full.Set(Full.LiveBase(), Full.LiveSlope());
+        Lines.Root.Set(Root.LiveBase(), Root.LiveSlope());
+        return Lines;
+    }
+
+    void Commit(float Value)
+    {
+        if (Full.IsReady())
+            Root.Push(2.0f * Half.Live(Value) - Full.Live(Value));
+
+        Half.Push(Value);
+        Full.Push(Value);
+    }
+};
+
+struct s_HMAKernel
+{
+    int CurrentIndex;
+    s_HMAState State;
+    s_HMALive Live;
+
+    s_HMAKernel()
+        : CurrentIndex(-1)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        State.Clear();
+    }
+
+    static int ScratchFloats(int Length)
+    {
+        return s_HMAState::ScratchFloats(Length);
+    }
+
+    void Attach(float* Scratch, int NewLength)
+    {
+        State.Attach(Scratch, NewLength);
+        Reset();
+    }
+
+    float Update(const float* In, int Index, int NewLength)
+    {
+        if (NewLength < 1)
+            return 0.0f;
+
+        if (NewLength != State.Length)
+        {
+            State.Resize(NewLength);
+            Reset();
+        }
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                State.Commit(In[CurrentIndex]);
+            else
+                Resync(In, Index);
+
+            Live = State.LiveLines();
+        }
+
+        CurrentIndex = Index;
+
+        return Live.At(In[Index]);
+    }
+
+private:
+    void Resync(const float* In, int Index)
+    {
+        Reset();
+
+        int FirstIndex = Index - State.WarmupBars();
+        if (FirstIndex < 0)
+            FirstIndex = 0;
+
+        for (int BarIndex = FirstIndex; BarIndex < Index; BarIndex++)
+            State.Commit(In[BarIndex]);
+    }
+};
+
+//================================================================================================//
+// Fused fast and slow Hull moving averages.
+// Both averages are updated from one read of each input value. When both use the same input array the value is read once for the pair.
+
+struct s_HMAPairKernel
+{
+    int CurrentIndex;
+    s_HMAState Fast;
+    s_HMAState Slow;
+    s_HMALive FastLive;
+    s_HMALive SlowLive;
+
+    s_HMAPairKernel()
+        : CurrentIndex(-1)
+    {
+    }
+
+    void Reset()
+    {
+        CurrentIndex = -1;
+        Fast.Clear();
+        Slow.Clear();
+    }
+
+    static int ScratchFloats(int FastLength, int SlowLength)
+    {
+        return s_HMAState::ScratchFloats(FastLength) + s_HMAState::ScratchFloats(SlowLength);
+    }
+
+    void Attach(float* Scratch, int FastLength, int SlowLength)
+    {
+        Fast.Attach(Scratch, FastLength);
+        Slow.Attach(Scratch != NULL ? Scratch + s_HMAState::ScratchFloats(FastLength) : NULL, SlowLength);
+        Reset();
+    }
+
+    void Update(const float* FastIn, const float* SlowIn, int Index, int FastLength, int SlowLength, float& FastOut, float& SlowOut)
+    {
+        FastOut = 0.0f;
+        SlowOut = 0.0f;
+
+        if (FastLength < 1 || SlowLength < 1)
+            return;
+
+        if (FastLength != Fast.Length || SlowLength != Slow.Length)
+        {
+            Fast.Resize(FastLength);
+            Slow.Resize(SlowLength);
+            Reset();
+        }
+
+        if (Index != CurrentIndex)
+        {
+            if (CurrentIndex >= 0 && Index == CurrentIndex + 1)
+                Commit(FastIn, SlowIn, CurrentIndex);
+            else
+                Resync(FastIn, SlowIn, Index);
+
+            FastLive = Fast.LiveLines();
+            SlowLive = Slow.LiveLines();
+        }
+
+        CurrentIndex = Index;
+
+        const float FastValue = FastIn[Index];
+        const float SlowValue = SlowIn == FastIn ? FastValue : SlowIn[Index];
+
+        FastOut = FastLive.At(FastValue);
+        SlowOut = SlowLive.At(SlowValue);
+    }
+
+private:
+    void Commit(const float* FastIn, const float* SlowIn, int Index)
+    {
+        const float FastValue = FastIn[Index];
+        Fast.Commit(FastValue);
+        Slow.Commit(SlowIn == FastIn ? FastValue : SlowIn[Index]);
+    }
+
+    void Resync(const float* FastIn, const float* SlowIn, int Index)
+    {
+        Reset();
+
+        const int WarmupBars = Fast.WarmupBars() > Slow.WarmupBars() ? Fast.WarmupBars() : Slow.WarmupBars();
+
+        int FirstIndex = Index - WarmupBars;
+        if (FirstIndex < 0)
+            FirstIndex = 0;
+
+        for (int BarIndex = FirstIndex; BarIndex < Index; BarIndex++)
+            Commit(FastIn, SlowIn, BarIndex);
+    }
+};
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef STUDY_ARENA_H
+#define STUDY_ARENA_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/*
+Scratch memory for a study, and a heap allocation counter for debug builds.
+
+c_StudyArena is one block carved up by a bump pointer. A study sizes it when its inputs are known (the first call and each full recalculation) with Reset(Bytes), then takes its scratch arrays from it with Allocate, so the per-bar and per-tick calls that follow never reach the heap.
+Reset only goes to the heap when more bytes are asked for than the arena has had before. It invalidates everything allocated earlier, so the owner takes all of its arrays again after each Reset.
+Allocations are aligned to ARENA_ALIGNMENT bytes (a cache line), and Allocate returns NULL when the arena is out of room instead of growing. Use SizeOf to add up the bytes to Reset with.
+An arena belongs to one study instance and is not shared between threads.
+
+With STUDY_ALLOCATION_COUNTER defined (the default when _DEBUG is defined), the global operator new and operator delete are replaced and the heap allocations of each thread are counted. c_AllocationCheck reads the count over a scope, so a study can report a heap allocation in code that should have none.
+The replacement operators must be defined once per binary. A Sierra Chart study DLL is a single translation unit, so this header defines them there. Under the headless sierrachart.h (included first, as the study files do), where several study files are linked into one program, only a file that defines STUDY_ALLOCATION_COUNTER_OPERATORS before its includes gets them: the headless main programs.
+Without STUDY_ALLOCATION_COUNTER, the count stays 0 and the checks compile to nothing.
+*/
+
+#if defined(_DEBUG) && !defined(STUDY_ALLOCATION_COUNTER)
+#define STUDY_ALLOCATION_COUNTER 1
+#endif
+
+#if defined(STUDY_ALLOCATION_COUNTER) && !defined(HEADLESS_SIERRACHART_H) && !defined(STUDY_ALLOCATION_COUNTER_OPERATORS)
+#define STUDY_ALLOCATION_COUNTER_OPERATORS 1
+#endif
+
+const size_t ARENA_ALIGNMENT = 64;
+
+class c_StudyArena
+{
+public:
+    c_StudyArena()
+        : m_Block(NULL)
+        , m_Data(NULL)
+        , m_Capacity(0)
+        , m_Used(0)
+    {
+    }
+
+    ~c_StudyArena()
+    {
+        delete[] m_Block;
+    }
+
+    // Bytes taken by Count values of T, with the padding to the next allocation.
+    template <typename T>
+    static size_t SizeOf(size_t Count)
+    {
+        return (Count * sizeof(T) + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT;
+    }
+
+    // Frees everything allocated so far and makes room for Bytes. Goes to the heap only to grow.
+    void Reset(size_t Bytes)
+    {
+        if (Bytes > m_Capacity)
+        {
+            delete[] m_Block;
+            m_Block = new char[Bytes + ARENA_ALIGNMENT];
+            m_Data = m_Block + (ARENA_ALIGNMENT - reinterpret_cast<size_t>(m_Block) % ARENA_ALIGNMENT) % ARENA_ALIGNMENT;
+            m_Capacity = Bytes;
+        }
+
+        m_Used = 0;
+    }
+
+    // Count values of T, uninitialized, or NULL when the arena is out of room.
+    template <typename T>
+    T* Allocate(size_t Count)
+    {
+        const size_t Bytes = SizeOf<T>(Count);
+        if (m_Data == NULL || Bytes > m_Capacity - m_Used)
+            return NULL;
+
+        T* Values = reinterpret_cast<T*>(m_Data + m_Used);
+        m_Used += Bytes;
+        return Values;
+    }
+
+    size_t Capacity() const
+    {
+        return m_Capacity;
+    }
+
+    size_t Used() const
+    {
+        return m_Used;
+    }
+
+private:
+    c_StudyArena(const c_StudyArena&);
+    c_StudyArena& operator=(const c_StudyArena&);
+
+    char* m_Block;
+    char* m_Data;
+    size_t m_Capacity;
+    size_t m_Used;
+};
+
+//================================================================================================//
+// Heap allocation counter
+
+// Heap allocations made by the calling thread. Always 0 without STUDY_ALLOCATION_COUNTER.
+inline unsigned long long& Study_AllocationCount()
+{
+    thread_local unsigned long long s_Count = 0;
+    return s_Count;
+}
+
+// Counts the calling thread's heap allocations from construction.
+class c_AllocationCheck
+{
+public:
+    c_AllocationCheck()
+        : m_Start(Study_AllocationCount())
+    {
+    }
+
+    unsigned long long Allocations() const
+    {
+        return Study_AllocationCount() - m_Start;
+    }
+
+private:
+    unsigned long long m_Start;
+};
+
+#if defined(STUDY_ALLOCATION_COUNTER_OPERATORS) && defined(STUDY_ALLOCATION_COUNTER)
+
+// Not inlined: GCC warns of a mismatched free when it inlines only one of a replacement operator new and operator delete into a caller.
+#if defined(__GNUC__) || defined(__clang__)
+#define STUDY_OPERATOR_NOINLINE __attribute__((noinline))
+#else
+#define STUDY_OPERATOR_NOINLINE
+#endif
+
+STUDY_OPERATOR_NOINLINE void* operator new(size_t Size)
+{
+    ++Study_AllocationCount();
+
+    void* p_Memory = std::malloc(Size > 0 ? Size : 1);
+    if (p_Memory == NULL)
+        throw std::bad_alloc();
+
+    return p_Memory;
+}
+
+STUDY_OPERATOR_NOINLINE void* operator new[](size_t Size)
+{
+    return operator new(Size);
+}
+
+STUDY_OPERATOR_NOINLINE void operator delete(void* p_Memory) noexcept
+{
+    std::free(p_Memory);
+}
+
+STUDY_OPERATOR_NOINLINE void operator delete[](void* p_Memory) noexcept
+{
+    std::free(p_Memory);
+}
+
+STUDY_OPERATOR_NOINLINE void operator delete(void* p_Memory, size_t) noexcept
+{
+    std::free(p_Memory);
+}
+
+STUDY_OPERATOR_NOINLINE void operator delete[](void* p_Memory, size_t) noexcept
+{
+    std::free(p_Memory);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef TRADE_LOG_H
+#define TRADE_LOG_H
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "Async_Writer.h"
+
+/*
+Trade log for offline analysis of the strategies: every crossover signal, every entry call, and every change of the position with the account's trade statistics.
+
+The study thread fills a fixed size s_TradeLogRecord and pushes it into a c_AsyncRecordWriter (Async_Writer.h); its thread writes the file every TRADE_LOG_FLUSH_MILLISECONDS, so there is no file I/O in the study callback.
+TRADE_LOG_SIGNAL - a cross on a bar. Price is the bar's close, Value1 and Value2 the faster and slower averages.
+TRADE_LOG_ENTRY - an entry call. Price is the bar's close, Quantity the order quantity and Value1 the value the entry function returned.
+TRADE_LOG_POSITION - the position or the number of closed trades changed since the last record (a fill). Quantity is the position, Price its average price, Value1 the open profit, Value2 the closed profit of the study, Value3 the last trade's profit, Trades and Wins the closed and winning trades.
+Flags are TRADE_LOG_INTRABAR for a cross of the live bar and TRADE_LOG_FULL_RECALCULATION for records made while the chart loaded its history. DateTime is the bar's start as an SCDateTime value in days.
+The file is columnar, like a Parquet row group without the compression: an s_TradeLogFileHeader, then blocks of one s_TradeLogBlockHeader followed by each column of the block's rows in turn, in the order of TRADE_LOG_COLUMNS, little endian.
+Each block is one append, so several instances can share a file; ChartNumber and StudyID tell their rows apart. Only the instance that creates the file writes the header, and a reader skips a header repeated by instances that found the same empty file. Headless/Trade_Log_Dump.cpp converts a file to CSV.
+*/
+
+enum e_TradeLogRecordKind
+{
+    TRADE_LOG_SIGNAL = 1,
+    TRADE_LOG_ENTRY = 2,
+    TRADE_LOG_POSITION = 3
+};
+
+enum e_TradeLogFlags
+{
+    TRADE_LOG_INTRABAR = 1,
+    TRADE_LOG_FULL_RECALCULATION = 2
+};
+
+struct s_TradeLogRecord
+{
+    double DateTime;
+    double Price;
+    double Value1;
+    double Value2;
+    double Value3;
+    int BarIndex;
+    int Quantity;
+    int Trades;
+    int Wins;
+    int ChartNumber;
+    int StudyID;
+    short Kind;
+    short Direction;
+    short Flags;
+
+    s_TradeLogRecord()
+        : DateTime(0.0)
+        , Price(0.0)
+        , Value1(0.0)
+        , Value2(0.0)
+        , Value3(0.0)
+        , BarIndex(0)
+        , Quantity(0)
+        , Trades(0)
+        , Wins(0)
+        , ChartNumber(0)
+        , StudyID(0)
+        , Kind(0)
+        , Direction(0)
+        , Flags(0)
+    {
+    }
+};
+
+#pragma pack(push, 1)
+
+struct s_TradeLogFileHeader
+{
+    char Magic[8];
+    unsigned int Version;
+    unsigned int ColumnCount;
+};
+
+// Bytes counts the columns that follow, so a reader can step over a block.
+struct s_TradeLogBlockHeader
+{
+    unsigned int RowCount;
+    unsigned int Bytes;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(s_TradeLogFileHeader) == 16, "s_TradeLogFileHeader must match the file format");
+static_assert(sizeof(s_TradeLogBlockHeader) == 8, "s_TradeLogBlockHeader must match the file format");
+
+const char TRADE_LOG_FILE_MAGIC[8] = { 'X', 'O', 'V', 'R', 'L', 'O', 'G', '1' };
+const unsigned int TRADE_LOG_FILE_VERSION = 1;
+const unsigned int TRADE_LOG_RING_RECORDS = 1u << 16;
+const unsigned int TRADE_LOG_FLUSH_MILLISECONDS = 50;
+
+// The columns of a block, in file order: DateTime, Price, Value1, Value2, Value3 as doubles, BarIndex, Quantity, Trades, Wins, ChartNumber, StudyID as 32 bit ints, Kind, Direction, Flags as 16 bit ints.
+const unsigned int TRADE_LOG_COLUMNS = 14;
+const unsigned int TRADE_LOG_ROW_BYTES = 5 * sizeof(double) + 6 * sizeof(int) + 3 * sizeof(short);
+
+inline void TradeLog_WriteHeader(std::FILE* File)
+{
+    s_TradeLogFileHeader Header;
+    std::memcpy(Header.Magic, TRADE_LOG_FILE_MAGIC, sizeof(Header.Magic));
+    Header.Version = TRADE_LOG_FILE_VERSION;
+    Header.ColumnCount = TRADE_LOG_COLUMNS;
+    std::fwrite(&Header, sizeof(Header), 1, File);
+}
+
+template <typename T>
+inline char* TradeLog_Column(char* Out, const s_TradeLogRecord* Records, unsigned int Count, T s_TradeLogRecord::* Field)
+{
+    for (unsigned int Row = 0; Row < Count; Row++)
+    {
+        std::memcpy(Out, &(Records[Row].*Field), sizeof(T));
+        Out += sizeof(T);
+    }
+
+    return Out;
+}
+
+// Transposes the rows into one block and writes it with one fwrite. Writer thread only; the buffer is kept between batches.
+inline void TradeLog_WriteBatch(std::FILE* File, const s_TradeLogRecord* Records, unsigned int Count)
+{
+    thread_local std::vector<char> Buffer;
+
+    s_TradeLogBlockHeader Block;
+    Block.RowCount = Count;
+    Block.Bytes = Count * TRADE_LOG_ROW_BYTES;
+
+    Buffer.resize(sizeof(Block) + Block.Bytes);
+    std::memcpy(&Buffer[0], &Block, sizeof(Block));
+
+    char* Out = &Buffer[sizeof(Block)];
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::DateTime);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Price);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Value1);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Value2);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Value3);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::BarIndex);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Quantity);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Trades);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Wins);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::ChartNumber);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::StudyID);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Kind);
+    Out = TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Direction);
+    TradeLog_Column(Out, Records, Count, &s_TradeLogRecord::Flags);
+
+    std::fwrite(&Buffer[0], 1, Buffer.size(), File);
+}
+
+class c_TradeLog
+{
+public:
+    c_TradeLog()
+        : m_ChartNumber(0)
+        , m_StudyID(0)
+        , m_LastQuantity(0)
+        , m_LastTrades(0)
+    {
+    }
+
+    // Starts logging to Path, appending to the file when it exists. Returns false when the file cannot be opened.
+    bool Open(const char* Path, int ChartNumber, int StudyID)
+    {
+        m_ChartNumber = ChartNumber;
+        m_StudyID = StudyID;
+        return m_Writer.Open(Path, TradeLog_WriteHeader, TradeLog_WriteBatch, TRADE_LOG_FLUSH_MILLISECONDS);
+    }
+
+    // Stops the writer after it has written everything logged so far, and closes the file.
+    void Close()
+    {
+        m_Writer.Close();
+    }
+
+    bool IsOpen() const
+    {
+        return m_Writer.IsOpen();
+    }
+
+    // Records dropped because the ring was full.
+    unsigned long long Dropped() const
+    {
+        return m_Writer.Dropped();
+    }
+
+    // Study thread only.
+    void Write(s_TradeLogRecord& Record)
+    {
+        Record.ChartNumber = m_ChartNumber;
+        Record.StudyID = m_StudyID;
+        m_Writer.Push(Record);
+    }
+
+    // Writes a TRADE_LOG_POSITION record when Quantity or Trades differ from the last one written.
+    void Position(s_TradeLogRecord& Record)
+    {
+        if (Record.Quantity == m_LastQuantity && Record.Trades == m_LastTrades)
+            return;
+
+        m_LastQuantity = Record.Quantity;
+        m_LastTrades = Record.Trades;
+        Write(Record);
+    }
+
+private:
+    c_TradeLog(const c_TradeLog&);
+    c_TradeLog& operator=(const c_TradeLog&);
+
+    c_AsyncRecordWriter<s_TradeLogRecord, TRADE_LOG_RING_RECORDS> m_Writer;
+    int m_ChartNumber;
+    int m_StudyID;
+    int m_LastQuantity;
+    int m_LastTrades;
+};
+
+#endif
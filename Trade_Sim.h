@@ -0,0 +1,178 @@
+#ifndef TRADE_SIM_H
+#define TRADE_SIM_H
+
+#include <cmath>
+
+/*
+Bar-level simulation of the crossover strategies' orders, for the sweep and optimizer studies.
+
+The strategies enter with a market order and an attached bracket: a limit target at Target1Offset and a trailing stop at Stop1Offset. On bar data that is modelled as follows:
+The entry fills at the close of the signal bar.
+From the next bar on, the stop is checked first (it is the worse outcome when one bar touches both), then the target. A touched stop fills at the stop price, a touched target at the target price.
+After the checks the trailing stop follows the best price of the bar (High for a long, Low for a short).
+An opposite signal closes the position at the close of the signal bar before the new entry.
+An offset of 0 disables that side of the bracket.
+Profits are in price units for a quantity of 1.
+*/
+
+struct s_BracketPosition
+{
+    int Direction;
+    int EntryIndex;
+    double EntryPrice;
+    double TargetPrice;
+    double StopPrice;
+    double StopOffset;
+    double BestPrice;
+
+    s_BracketPosition()
+        : Direction(0)
+        , EntryIndex(-1)
+        , EntryPrice(0.0)
+        , TargetPrice(0.0)
+        , StopPrice(0.0)
+        , StopOffset(0.0)
+        , BestPrice(0.0)
+    {
+    }
+
+    bool IsOpen() const
+    {
+        return Direction != 0;
+    }
+
+    void Open(int NewDirection, int Index, double Price, double TargetOffset, double NewStopOffset)
+    {
+        Direction = NewDirection;
+        EntryIndex = Index;
+        EntryPrice = Price;
+        BestPrice = Price;
+        StopOffset = NewStopOffset;
+        TargetPrice = TargetOffset > 0.0 ? Price + Direction * TargetOffset : 0.0;
+        StopPrice = StopOffset > 0.0 ? Price - Direction * StopOffset : 0.0;
+    }
+
+    // Profit of closing at Price. The position is flat afterwards.
+    double Close(double Price)
+    {
+        const double Profit = Direction * (Price - EntryPrice);
+        Direction = 0;
+        EntryIndex = -1;
+        return Profit;
+    }
+
+    // Checks the bracket against one bar after the entry bar. Returns true with ExitPrice set when the stop or target filled.
+    bool Step(float High, float Low, double& ExitPrice)
+    {
+        if (Direction > 0)
+        {
+            if (StopOffset > 0.0 && Low <= StopPrice)
+            {
+                ExitPrice = StopPrice;
+                return true;
+            }
+
+            if (TargetPrice > 0.0 && High >= TargetPrice)
+            {
+                ExitPrice = TargetPrice;
+                return true;
+            }
+
+            if (High > BestPrice)
+            {
+                BestPrice = High;
+                StopPrice = BestPrice - StopOffset;
+            }
+        }
+        else if (Direction < 0)
+        {
+            if (StopOffset > 0.0 && High >= StopPrice)
+            {
+                ExitPrice = StopPrice;
+                return true;
+            }
+
+            if (TargetPrice > 0.0 && Low <= TargetPrice)
+            {
+                ExitPrice = TargetPrice;
+                return true;
+            }
+
+            if (Low < BestPrice)
+            {
+                BestPrice = Low;
+                StopPrice = BestPrice + StopOffset;
+            }
+        }
+
+        return false;
+    }
+};
+
+// Closed trade statistics.
+struct s_TradeStats
+{
+    int Trades;
+    int Wins;
+    double NetProfit;
+    double GrossProfit;
+    double GrossLoss;
+    double PeakEquity;
+    double MaxDrawdown;
+    double SumSquares;
+
+    s_TradeStats()
+        : Trades(0)
+        , Wins(0)
+        , NetProfit(0.0)
+        , GrossProfit(0.0)
+        , GrossLoss(0.0)
+        , PeakEquity(0.0)
+        , MaxDrawdown(0.0)
+        , SumSquares(0.0)
+    {
+    }
+
+    void Add(double Profit)
+    {
+        Trades++;
+        NetProfit += Profit;
+        SumSquares += Profit * Profit;
+
+        if (Profit > 0.0)
+        {
+            Wins++;
+            GrossProfit += Profit;
+        }
+        else
+            GrossLoss -= Profit;
+
+        if (NetProfit > PeakEquity)
+            PeakEquity = NetProfit;
+        else if (PeakEquity - NetProfit > MaxDrawdown)
+            MaxDrawdown = PeakEquity - NetProfit;
+    }
+
+    double AverageTrade() const
+    {
+        return Trades > 0 ? NetProfit / Trades : 0.0;
+    }
+
+    double ProfitFactor() const
+    {
+        return GrossLoss > 0.0 ? GrossProfit / GrossLoss : 0.0;
+    }
+
+    // Mean over standard deviation of the closed trade profits (per trade, not annualized).
+    double Sharpe() const
+    {
+        if (Trades < 2)
+            return 0.0;
+
+        const double Mean = NetProfit / Trades;
+        const double Variance = (SumSquares - Trades * Mean * Mean) / (Trades - 1);
+        return Variance > 0.0 ? Mean / std::sqrt(Variance) : 0.0;
+    }
+};
+
+#endif
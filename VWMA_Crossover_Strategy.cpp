@@ -0,0 +1,36 @@
+#include "sierrachart.h"
+#include "Crossover_Engine.h"
+
+SCDLLName("VWMA Crossover Strategy")
+
+/*
+This code implements a trading strategy based on Volume Weighted Moving Average (VWMA) crossovers. Here's a breakdown of its components and functionality:
+
+Initialization Section:
+Default settings for the strategy are defined, such as VWMA periods, stop and target values, and graphical settings for visualization.
+Trading behavior parameters are set, including position management and order handling settings.
+Main Logic:
+Volume weighted moving averages (VWMAs) are calculated based on the specified input data and periods, weighted by the volume of each bar, with an O(1) rolling-sum kernel (s_VWMAKernel in MA_Adaptive_Kernels.h). The running sums of price times volume and of volume and ring buffers of the last closed prices and volumes are kept in persistent memory, so each new bar costs the same regardless of the period. Intrabar updates of the last bar add the live price and volume to the closed sums. A full recalculation computes the whole history with the batch kernel (MA_Batch_VWMA) and the kernel resyncs from there.
+The order (s_SCNewOrder) with its quantity, order type, time in force, and offsets for target and stop orders is prepared once when the inputs are read (s_CrossoverSettings::Read, on a full recalculation or a tick size change), and each entry sends a copy of it.
+The current position data is obtained using sc.GetTradePosition.
+For every bar closed since the last evaluated one, the strategy checks if there's a crossover between the faster and slower VWMAs.
+If a crossover from bottom to top occurs (CROSS_FROM_BOTTOM), indicating a bullish signal:
+If there's a short position (PositionData.PositionQuantity < 0), all orders are canceled, and the position is closed: flattened on a live update, or with a market exit at that bar while a full recalculation backtests the history.
+A buy entry order is generated using sc.BuyEntry with that order.
+If a crossover from top to bottom occurs (CROSS_FROM_TOP), indicating a bearish signal:
+If there's a long position (PositionData.PositionQuantity > 0), all orders are canceled, and the position is closed the same way.
+A sell entry order is generated using sc.SellEntry with that order.
+Additional Notes:
+The study body is shared with the other crossover strategies and lives in Crossover_Engine.h. This file only selects the moving average policy (VWMA_Policy).
+The study uses manual looping (sc.AutoLoop = 0). Each call computes the averages for every bar from sc.UpdateStartIndex to sc.ArraySize in one pass, and the trade-side work runs for every bar closed since the last call. A full recalculation only evaluates the newest closed bar and does not trade, unless Trade On Full Recalculation (Backtest) is set, which trades every cross of the history.
+Similar to the previous codes, only one trade per bar is allowed (sc.AllowOnlyOneTradePerBar = true).
+Trade statistics and data are maintained (sc.MaintainTradeStatisticsAndTradesData = true).
+This code prepares order parameters and conditions but doesn't execute actual trades. Integration with a brokerage or trading platform would be necessary for live trading.
+Overall, this code implements a trading strategy based on VWMA crossovers, allowing for both long and short trades with specified stop and target levels.
+*/
+
+SCSFExport scsf_VWMA_Crossover_Trading(SCStudyInterfaceRef sc)
+{
+    Crossover_Trading<VWMA_Policy>(sc);
+}
+//================================================================================================//